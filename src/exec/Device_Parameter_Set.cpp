@@ -5,6 +5,8 @@
 
 int Device_Parameter_Set::Seed = 123;//Seed for random number generation (used in device's random number generators)
 bool Device_Parameter_Set::Enabled_Preconditioning = true;
+std::string Device_Parameter_Set::Checkpoint_Save_Path = "";
+std::string Device_Parameter_Set::Checkpoint_Load_Path = "";
 NVM::NVM_Type Device_Parameter_Set::Memory_Type = NVM::NVM_Type::FLASH;
 HostInterface_Types Device_Parameter_Set::HostInterface_Type = HostInterface_Types::NVME;
 uint16_t Device_Parameter_Set::IO_Queue_Depth = 1024;//For NVMe, it determines the size of the submission/completion queues; for SATA, it determines the size of NCQ_Control_Structure
@@ -18,15 +20,37 @@ unsigned int Device_Parameter_Set::Data_Cache_DRAM_Data_Busrt_Size = 4;//The num
 sim_time_type Device_Parameter_Set::Data_Cache_DRAM_tRCD = 13;//tRCD parameter to access DRAM in the data cache, the unit is nano-seconds
 sim_time_type Device_Parameter_Set::Data_Cache_DRAM_tCL = 13;//tCL parameter to access DRAM in the data cache, the unit is nano-seconds
 sim_time_type Device_Parameter_Set::Data_Cache_DRAM_tRP = 13;//tRP parameter to access DRAM in the data cache, the unit is nano-seconds
+bool Device_Parameter_Set::Data_Cache_Content_Aware = false;//** Append for CAFTL
 SSD_Components::Flash_Address_Mapping_Type Device_Parameter_Set::Address_Mapping = SSD_Components::Flash_Address_Mapping_Type::PAGE_LEVEL;
 bool Device_Parameter_Set::Ideal_Mapping_Table = false;//If mapping is ideal, then all the mapping entries are found in the DRAM and there is no need to read mapping entries from flash
 unsigned int Device_Parameter_Set::CMT_Capacity = 2 * 1024 * 1024;//Size of SRAM/DRAM space that is used to cache address mapping table in bytes
 SSD_Components::CMT_Sharing_Mode Device_Parameter_Set::CMT_Sharing_Mode = SSD_Components::CMT_Sharing_Mode::SHARED;//How the entire CMT space is shared among concurrently running flows
+unsigned int Device_Parameter_Set::FP_Cache_Capacity = 0;//** Append for CAFTL: Size of DRAM space that is used to cache fingerprints in bytes, 0 keeps the whole fingerprint table in DRAM
+SSD_Components::FP_Cache_Replacement_Policy Device_Parameter_Set::FP_Cache_Replacement_Policy = SSD_Components::FP_Cache_Replacement_Policy::LRU;
+unsigned int Device_Parameter_Set::FP_Filter_Size = 0;//** Append for CAFTL: Size of the fingerprint filter in bytes, 0 disables the filter
+unsigned int Device_Parameter_Set::FP_Filter_Hash_No = 4;//** Append for CAFTL
+sim_time_type Device_Parameter_Set::FP_Filter_Probe_Time = 1;//** Append for CAFTL: in nano-seconds
+unsigned int Device_Parameter_Set::SMT_Cache_Capacity = 0;//** Append for CAFTL: Size of DRAM space that is used to cache SMT entries in bytes, 0 keeps the whole SMT in DRAM
+SSD_Components::SMT_Cache_Replacement_Policy Device_Parameter_Set::SMT_Cache_Replacement_Policy = SSD_Components::SMT_Cache_Replacement_Policy::LRU;
+unsigned int Device_Parameter_Set::FP_Engine_Unit_No = 4;//** Append for CAFTL: Number of parallel hash units in the fingerprint engine
+unsigned int Device_Parameter_Set::FP_Engine_Unit_Throughput = 640;//** Append for CAFTL: MB/s of one hash unit, i.e., 6.4 us for a 4KB page
+unsigned int Device_Parameter_Set::FP_Engine_Weak_Hash_Throughput = 6400;//** Append for CAFTL: MB/s of the weak hash, i.e., 0.64 us for a 4KB page
+unsigned int Device_Parameter_Set::Dedup_Sampling_Unit = 1;//** Append for CAFTL: 1 fingerprints every written page
+SSD_Components::Dedup_Sampling_Rule Device_Parameter_Set::Dedup_Sampling_Rule = SSD_Components::Dedup_Sampling_Rule::FIRST;
+bool Device_Parameter_Set::Dedup_Prehash_Enabled = false;
+SSD_Components::Dedup_Mode Device_Parameter_Set::Dedup_Mode = SSD_Components::Dedup_Mode::INLINE;
+sim_time_type Device_Parameter_Set::Dedup_Idle_Threshold = 1000000;//** Append for CAFTL: 1 ms without writes
+unsigned int Device_Parameter_Set::Dedup_Chunk_Size = 0;//** Append for CAFTL: 0 uses the page capacity as the chunk size
+bool Device_Parameter_Set::Compression_Enabled = false;//** Append for CAFTL
+bool Device_Parameter_Set::Dedup_Verify_Enabled = false;//** Append for CAFTL
+bool Device_Parameter_Set::Global_Dedup_Enabled = false;//** Append for CAFTL
 SSD_Components::Flash_Plane_Allocation_Scheme_Type Device_Parameter_Set::Plane_Allocation_Scheme = SSD_Components::Flash_Plane_Allocation_Scheme_Type::CWDP;
 SSD_Components::Flash_Scheduling_Type Device_Parameter_Set::Transaction_Scheduling_Policy = SSD_Components::Flash_Scheduling_Type::OUT_OF_ORDER;
 double Device_Parameter_Set::Overprovisioning_Ratio = 0.07;//The ratio of spare space with respect to the whole available storage space of SSD
 double Device_Parameter_Set::GC_Exec_Threshold = 0.05;//The threshold for the ratio of free pages that used to trigger GC
 SSD_Components::GC_Block_Selection_Policy_Type Device_Parameter_Set::GC_Block_Selection_Policy = SSD_Components::GC_Block_Selection_Policy_Type::RGA;
+bool Device_Parameter_Set::Shared_Data_Write_Frontier = false;//** Append for CAFTL
+bool Device_Parameter_Set::GC_Dedup_Enabled = false;//** Append for CAFTL
 bool Device_Parameter_Set::Use_Copyback_for_GC = false;
 bool Device_Parameter_Set::Preemptible_GC_Enabled = true;
 double Device_Parameter_Set::GC_Hard_Threshold = 0.005;//The hard gc execution threshold, used to stop preemptible gc execution
@@ -57,6 +81,14 @@ void Device_Parameter_Set::XML_serialize(Utils::XmlWriter& xmlwriter)
 	val = (Enabled_Preconditioning ? "true" : "false");
 	xmlwriter.Write_attribute_string(attr, val);
 
+	attr = "Checkpoint_Save_Path";
+	val = Checkpoint_Save_Path;
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Checkpoint_Load_Path";
+	val = Checkpoint_Load_Path;
+	xmlwriter.Write_attribute_string(attr, val);
+
 	attr = "Memory_Type";
 	val;
 	switch (Memory_Type) {
@@ -145,6 +177,10 @@ void Device_Parameter_Set::XML_serialize(Utils::XmlWriter& xmlwriter)
 	val = std::to_string(Data_Cache_DRAM_tRP);
 	xmlwriter.Write_attribute_string(attr, val);
 
+	attr = "Data_Cache_Content_Aware";
+	val = (Data_Cache_Content_Aware ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
 	attr = "Address_Mapping";
 	switch (Address_Mapping) {
 		case SSD_Components::Flash_Address_Mapping_Type::PAGE_LEVEL:
@@ -179,6 +215,118 @@ void Device_Parameter_Set::XML_serialize(Utils::XmlWriter& xmlwriter)
 	}
 	xmlwriter.Write_attribute_string(attr, val);
 
+	attr = "FP_Cache_Capacity";
+	val = std::to_string(FP_Cache_Capacity);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Cache_Replacement_Policy";
+	switch (FP_Cache_Replacement_Policy) {
+		case SSD_Components::FP_Cache_Replacement_Policy::LRU:
+			val = "LRU";
+			break;
+		case SSD_Components::FP_Cache_Replacement_Policy::FIFO:
+			val = "FIFO";
+			break;
+		default:
+			break;
+	}
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Filter_Size";
+	val = std::to_string(FP_Filter_Size);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Filter_Hash_No";
+	val = std::to_string(FP_Filter_Hash_No);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Filter_Probe_Time";
+	val = std::to_string(FP_Filter_Probe_Time);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "SMT_Cache_Capacity";
+	val = std::to_string(SMT_Cache_Capacity);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "SMT_Cache_Replacement_Policy";
+	switch (SMT_Cache_Replacement_Policy) {
+		case SSD_Components::SMT_Cache_Replacement_Policy::LRU:
+			val = "LRU";
+			break;
+		case SSD_Components::SMT_Cache_Replacement_Policy::FIFO:
+			val = "FIFO";
+			break;
+		default:
+			break;
+	}
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Engine_Unit_No";
+	val = std::to_string(FP_Engine_Unit_No);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Engine_Unit_Throughput";
+	val = std::to_string(FP_Engine_Unit_Throughput);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "FP_Engine_Weak_Hash_Throughput";
+	val = std::to_string(FP_Engine_Weak_Hash_Throughput);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Sampling_Unit";
+	val = std::to_string(Dedup_Sampling_Unit);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Sampling_Rule";
+	switch (Dedup_Sampling_Rule) {
+		case SSD_Components::Dedup_Sampling_Rule::FIRST:
+			val = "FIRST";
+			break;
+		case SSD_Components::Dedup_Sampling_Rule::CONTENT:
+			val = "CONTENT";
+			break;
+		default:
+			break;
+	}
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Prehash_Enabled";
+	val = (Dedup_Prehash_Enabled ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Mode";
+	switch (Dedup_Mode) {
+		case SSD_Components::Dedup_Mode::INLINE:
+			val = "INLINE";
+			break;
+		case SSD_Components::Dedup_Mode::OUT_OF_LINE:
+			val = "OUT_OF_LINE";
+			break;
+		default:
+			break;
+	}
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Idle_Threshold";
+	val = std::to_string(Dedup_Idle_Threshold);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Chunk_Size";
+	val = std::to_string(Dedup_Chunk_Size);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Compression_Enabled";
+	val = (Compression_Enabled ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Dedup_Verify_Enabled";
+	val = (Dedup_Verify_Enabled ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Global_Dedup_Enabled";
+	val = (Global_Dedup_Enabled ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
 	attr = "Plane_Allocation_Scheme";
 	switch (Plane_Allocation_Scheme) {
 		case SSD_Components::Flash_Plane_Allocation_Scheme_Type::CDPW:
@@ -302,11 +450,22 @@ void Device_Parameter_Set::XML_serialize(Utils::XmlWriter& xmlwriter)
 		case SSD_Components::GC_Block_Selection_Policy_Type::FIFO:
 			val = "FIFO";
 			break;
+		case SSD_Components::GC_Block_Selection_Policy_Type::DEDUP_AWARE:
+			val = "DEDUP_AWARE";
+			break;
 		default:
 			break;
 	}
 	xmlwriter.Write_attribute_string(attr, val);
 	
+	attr = "Shared_Data_Write_Frontier";
+	val = (Shared_Data_Write_Frontier ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "GC_Dedup_Enabled";
+	val = (GC_Dedup_Enabled ? "true" : "false");
+	xmlwriter.Write_attribute_string(attr, val);
+
 	attr = "Use_Copyback_for_GC";
 	val = (Use_Copyback_for_GC ? "true" : "false");
 	xmlwriter.Write_attribute_string(attr, val);
@@ -386,6 +545,10 @@ void Device_Parameter_Set::XML_deserialize(rapidxml::xml_node<> *node)
 				std::string val = param->value();
 				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
 				Enabled_Preconditioning = (val.compare("FALSE") == 0 ? false : true);
+			} else if (strcmp(param->name(), "Checkpoint_Save_Path") == 0) {
+				Checkpoint_Save_Path = param->value();
+			} else if (strcmp(param->name(), "Checkpoint_Load_Path") == 0) {
+				Checkpoint_Load_Path = param->value();
 			} else if (strcmp(param->name(), "Memory_Type") == 0) {
 				std::string val = param->value();
 				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
@@ -449,6 +612,10 @@ void Device_Parameter_Set::XML_deserialize(rapidxml::xml_node<> *node)
 			} else if (strcmp(param->name(), "Data_Cache_DRAM_tRP") == 0) {
 				std::string val = param->value();
 				Data_Cache_DRAM_tRP = std::stoul(val);
+			} else if (strcmp(param->name(), "Data_Cache_Content_Aware") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Data_Cache_Content_Aware = (val.compare("TRUE") == 0 ? true : false);
 			} else if (strcmp(param->name(), "Address_Mapping") == 0) {
 				std::string val = param->value();
 				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
@@ -477,6 +644,95 @@ void Device_Parameter_Set::XML_deserialize(rapidxml::xml_node<> *node)
 				} else {
 					PRINT_ERROR("Unknown CMT sharing mode specified in the SSD configuration file")
 				}
+			} else if (strcmp(param->name(), "FP_Cache_Capacity") == 0) {
+				std::string val = param->value();
+				FP_Cache_Capacity = std::stoul(val);
+			} else if (strcmp(param->name(), "FP_Cache_Replacement_Policy") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				if (strcmp(val.c_str(), "LRU") == 0) {
+					FP_Cache_Replacement_Policy = SSD_Components::FP_Cache_Replacement_Policy::LRU;
+				} else if (strcmp(val.c_str(), "FIFO") == 0) {
+					FP_Cache_Replacement_Policy = SSD_Components::FP_Cache_Replacement_Policy::FIFO;
+				} else {
+					PRINT_ERROR("Unknown fingerprint cache replacement policy specified in the SSD configuration file")
+				}
+			} else if (strcmp(param->name(), "FP_Filter_Size") == 0) {
+				std::string val = param->value();
+				FP_Filter_Size = std::stoul(val);
+			} else if (strcmp(param->name(), "FP_Filter_Hash_No") == 0) {
+				std::string val = param->value();
+				FP_Filter_Hash_No = std::stoul(val);
+			} else if (strcmp(param->name(), "FP_Filter_Probe_Time") == 0) {
+				std::string val = param->value();
+				FP_Filter_Probe_Time = std::stoull(val);
+			} else if (strcmp(param->name(), "SMT_Cache_Capacity") == 0) {
+				std::string val = param->value();
+				SMT_Cache_Capacity = std::stoul(val);
+			} else if (strcmp(param->name(), "SMT_Cache_Replacement_Policy") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				if (strcmp(val.c_str(), "LRU") == 0) {
+					SMT_Cache_Replacement_Policy = SSD_Components::SMT_Cache_Replacement_Policy::LRU;
+				} else if (strcmp(val.c_str(), "FIFO") == 0) {
+					SMT_Cache_Replacement_Policy = SSD_Components::SMT_Cache_Replacement_Policy::FIFO;
+				} else {
+					PRINT_ERROR("Unknown SMT cache replacement policy specified in the SSD configuration file")
+				}
+			} else if (strcmp(param->name(), "FP_Engine_Unit_No") == 0) {
+				std::string val = param->value();
+				FP_Engine_Unit_No = std::stoul(val);
+			} else if (strcmp(param->name(), "FP_Engine_Unit_Throughput") == 0) {
+				std::string val = param->value();
+				FP_Engine_Unit_Throughput = std::stoul(val);
+			} else if (strcmp(param->name(), "FP_Engine_Weak_Hash_Throughput") == 0) {
+				std::string val = param->value();
+				FP_Engine_Weak_Hash_Throughput = std::stoul(val);
+			} else if (strcmp(param->name(), "Dedup_Sampling_Unit") == 0) {
+				std::string val = param->value();
+				Dedup_Sampling_Unit = std::stoul(val);
+			} else if (strcmp(param->name(), "Dedup_Sampling_Rule") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				if (strcmp(val.c_str(), "FIRST") == 0) {
+					Dedup_Sampling_Rule = SSD_Components::Dedup_Sampling_Rule::FIRST;
+				} else if (strcmp(val.c_str(), "CONTENT") == 0) {
+					Dedup_Sampling_Rule = SSD_Components::Dedup_Sampling_Rule::CONTENT;
+				} else {
+					PRINT_ERROR("Unknown dedup sampling rule specified in the SSD configuration file")
+				}
+			} else if (strcmp(param->name(), "Dedup_Prehash_Enabled") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Dedup_Prehash_Enabled = (val.compare("TRUE") == 0 ? true : false);
+			} else if (strcmp(param->name(), "Dedup_Mode") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				if (strcmp(val.c_str(), "INLINE") == 0) {
+					Dedup_Mode = SSD_Components::Dedup_Mode::INLINE;
+				} else if (strcmp(val.c_str(), "OUT_OF_LINE") == 0) {
+					Dedup_Mode = SSD_Components::Dedup_Mode::OUT_OF_LINE;
+				} else {
+					PRINT_ERROR("Unknown dedup mode specified in the SSD configuration file")
+				}
+			} else if (strcmp(param->name(), "Dedup_Idle_Threshold") == 0) {
+				std::string val = param->value();
+				Dedup_Idle_Threshold = std::stoull(val);
+			} else if (strcmp(param->name(), "Dedup_Chunk_Size") == 0) {
+				std::string val = param->value();
+				Dedup_Chunk_Size = std::stoul(val);
+			} else if (strcmp(param->name(), "Compression_Enabled") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Compression_Enabled = (val.compare("TRUE") == 0 ? true : false);
+			} else if (strcmp(param->name(), "Dedup_Verify_Enabled") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Dedup_Verify_Enabled = (val.compare("TRUE") == 0 ? true : false);
+			} else if (strcmp(param->name(), "Global_Dedup_Enabled") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Global_Dedup_Enabled = (val.compare("TRUE") == 0 ? true : false);
 			} else if (strcmp(param->name(), "Plane_Allocation_Scheme") == 0) {
 				std::string val = param->value();
 				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
@@ -571,9 +827,19 @@ void Device_Parameter_Set::XML_deserialize(rapidxml::xml_node<> *node)
 					GC_Block_Selection_Policy = SSD_Components::GC_Block_Selection_Policy_Type::RANDOM_PP;
 				} else if (strcmp(val.c_str(), "FIFO") == 0) {
 					GC_Block_Selection_Policy = SSD_Components::GC_Block_Selection_Policy_Type::FIFO;
+				} else if (strcmp(val.c_str(), "DEDUP_AWARE") == 0) {
+					GC_Block_Selection_Policy = SSD_Components::GC_Block_Selection_Policy_Type::DEDUP_AWARE;
 				} else {
 					PRINT_ERROR("Unknown GC block selection policy specified in the SSD configuration file")
 				}
+			} else if (strcmp(param->name(), "Shared_Data_Write_Frontier") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				Shared_Data_Write_Frontier = (val.compare("FALSE") == 0 ? false : true);
+			} else if (strcmp(param->name(), "GC_Dedup_Enabled") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				GC_Dedup_Enabled = (val.compare("FALSE") == 0 ? false : true);
 			} else if (strcmp(param->name(), "Use_Copyback_for_GC") == 0) {
 					std::string val = param->value();
 					std::transform(val.begin(), val.end(), val.begin(), ::toupper);
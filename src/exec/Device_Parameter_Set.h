@@ -9,6 +9,10 @@
 #include "../ssd/TSU_Base.h"
 #include "../ssd/ONFI_Channel_Base.h"
 #include "../ssd/GC_and_WL_Unit_Page_Level.h"
+#include "../ssd/Fingerprint_Cache.h"
+#include "../ssd/SMT_Cache.h"
+#include "../ssd/Dedup_Sampler.h"
+#include "../ssd/Deduplicator.h"
 #include "../nvm_chip/NVM_Types.h"
 #include "Parameter_Set_Base.h"
 #include "Flash_Parameter_Set.h"
@@ -18,6 +22,8 @@ class Device_Parameter_Set : public Parameter_Set_Base
 public:
 	static int Seed;//Seed for random number generation (used in device's random number generators)
 	static bool Enabled_Preconditioning;
+	static std::string Checkpoint_Save_Path;//** Append for CAFTL: Image of the FTL state saved after preconditioning, empty disables saving
+	static std::string Checkpoint_Load_Path;//** Append for CAFTL: Image of the FTL state loaded instead of running preconditioning, empty disables loading
 	static NVM::NVM_Type Memory_Type;
 	static HostInterface_Types HostInterface_Type;
 	static uint16_t IO_Queue_Depth;//For NVMe, it determines the size of the submission/completion queues; for SATA, it determines the size of NCQ_Control_Structure
@@ -31,15 +37,37 @@ public:
 	static sim_time_type Data_Cache_DRAM_tRCD;//tRCD parameter to access DRAM in the data cache, the unit is nano-seconds
 	static sim_time_type Data_Cache_DRAM_tCL;//tCL parameter to access DRAM in the data cache, the unit is nano-seconds
 	static sim_time_type Data_Cache_DRAM_tRP;//tRP parameter to access DRAM in the data cache, the unit is nano-seconds
+	static bool Data_Cache_Content_Aware;//** Append for CAFTL: Write cache slots holding the same content share one DRAM page and one destage
 	static SSD_Components::Flash_Address_Mapping_Type Address_Mapping;
 	static bool Ideal_Mapping_Table;//If mapping is ideal, then all the mapping entries are found in the DRAM and there is no need to read mapping entries from flash
 	static unsigned int CMT_Capacity;//Size of SRAM/DRAM space that is used to cache address mapping table, the unit is bytes
 	static SSD_Components::CMT_Sharing_Mode CMT_Sharing_Mode;//How the entire CMT space is shared among concurrently running flows
+	static unsigned int FP_Cache_Capacity;//** Append for CAFTL: Size of DRAM space that is used to cache fingerprints, the unit is bytes, 0 keeps the whole fingerprint table in DRAM
+	static SSD_Components::FP_Cache_Replacement_Policy FP_Cache_Replacement_Policy;//** Append for CAFTL
+	static unsigned int FP_Filter_Size;//** Append for CAFTL: Size of the SRAM Bloom filter in front of the fingerprint index, the unit is bytes, 0 disables the filter
+	static unsigned int FP_Filter_Hash_No;//** Append for CAFTL: Number of hash functions (bits set per fingerprint) of the fingerprint filter
+	static sim_time_type FP_Filter_Probe_Time;//** Append for CAFTL: SRAM access time of one filter bit, the unit is nano-seconds
+	static unsigned int SMT_Cache_Capacity;//** Append for CAFTL: Size of DRAM space that is used to cache the Secondary Mapping Table, the unit is bytes, 0 keeps the whole SMT in DRAM
+	static SSD_Components::SMT_Cache_Replacement_Policy SMT_Cache_Replacement_Policy;//** Append for CAFTL
+	static unsigned int FP_Engine_Unit_No;//** Append for CAFTL: Number of parallel hash units in the fingerprint engine, 0 fingerprints writes in zero time
+	static unsigned int FP_Engine_Unit_Throughput;//** Append for CAFTL: Hashing throughput of one hash unit in MB/s
+	static unsigned int FP_Engine_Weak_Hash_Throughput;//** Append for CAFTL: Weak (pre-)hashing throughput of one hash unit in MB/s
+	static unsigned int Dedup_Sampling_Unit;//** Append for CAFTL: One sample page is fingerprinted first per this many pages of a request, 1 disables sampling
+	static SSD_Components::Dedup_Sampling_Rule Dedup_Sampling_Rule;//** Append for CAFTL
+	static bool Dedup_Prehash_Enabled;//** Append for CAFTL: Filter full fingerprints with a weak hash
+	static SSD_Components::Dedup_Mode Dedup_Mode;//** Append for CAFTL: Deduplicate writes on the write path or in the background
+	static sim_time_type Dedup_Idle_Threshold;//** Append for CAFTL: Time without writes before background dedup starts, the unit is nano-seconds
+	static unsigned int Dedup_Chunk_Size;//** Append for CAFTL: Dedup granularity in bytes, 0 deduplicates whole flash pages
+	static bool Compression_Enabled;//** Append for CAFTL: Unique chunks are stored compressed and packed into flash pages at sector granularity
+	static bool Dedup_Verify_Enabled;//** Append for CAFTL: A duplicate write completes only after the page it matched has been read back and compared
+	static bool Global_Dedup_Enabled;//** Append for CAFTL: All I/O flows share one dedup domain, so identical data of different flows is stored once
 	static SSD_Components::Flash_Plane_Allocation_Scheme_Type Plane_Allocation_Scheme;
 	static SSD_Components::Flash_Scheduling_Type Transaction_Scheduling_Policy;
 	static double Overprovisioning_Ratio;//The ratio of spare space with respect to the whole available storage space of SSD
 	static double GC_Exec_Threshold;//The threshold for the ratio of free pages that used to trigger GC
 	static SSD_Components::GC_Block_Selection_Policy_Type GC_Block_Selection_Policy;
+	static bool Shared_Data_Write_Frontier;//** Append for CAFTL: GC moves shared chunks into their own write frontier block
+	static bool GC_Dedup_Enabled;//** Append for CAFTL: GC fingerprints the pages it moves that were written without a fingerprint and merges the duplicates
 	static bool Use_Copyback_for_GC;
 	static bool Preemptible_GC_Enabled;
 	static double GC_Hard_Threshold;//The hard gc execution threshold, used to stop preemptible gc execution
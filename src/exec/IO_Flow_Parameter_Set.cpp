@@ -317,6 +317,32 @@ void IO_Flow_Parameter_Set_Synthetic::XML_serialize(Utils::XmlWriter& xmlwriter)
 	val = std::to_string(Total_Requests_To_Generate);
 	xmlwriter.Write_attribute_string(attr, val);
 
+	attr = "Content_Duplicate_Percentage";
+	val = std::to_string(Content_Duplicate_Percentage);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Content_Universe_Size";
+	val = std::to_string(Content_Universe_Size);
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Content_Popularity";
+	switch (Content_Popularity) {
+		case Utils::Content_Popularity_Type::NONE:
+			val = "NONE";
+			break;
+		case Utils::Content_Popularity_Type::UNIFORM:
+			val = "UNIFORM";
+			break;
+		case Utils::Content_Popularity_Type::ZIPF:
+			val = "ZIPF";
+			break;
+	}
+	xmlwriter.Write_attribute_string(attr, val);
+
+	attr = "Content_Compressed_Percentage";
+	val = std::to_string(Content_Compressed_Percentage);
+	xmlwriter.Write_attribute_string(attr, val);
+
 	xmlwriter.Write_close_tag();
 }
 
@@ -394,6 +420,27 @@ void IO_Flow_Parameter_Set_Synthetic::XML_deserialize(rapidxml::xml_node<> *node
 			} else if (strcmp(param->name(), "Total_Requests_To_Generate") == 0) {
 				std::string val = param->value();
 				Total_Requests_To_Generate = std::stoi(val);
+			} else if (strcmp(param->name(), "Content_Duplicate_Percentage") == 0) {
+				std::string val = param->value();
+				Content_Duplicate_Percentage = std::stoi(val);
+			} else if (strcmp(param->name(), "Content_Universe_Size") == 0) {
+				std::string val = param->value();
+				Content_Universe_Size = std::stoul(val);
+			} else if (strcmp(param->name(), "Content_Popularity") == 0) {
+				std::string val = param->value();
+				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
+				if (strcmp(val.c_str(), "NONE") == 0) {
+					Content_Popularity = Utils::Content_Popularity_Type::NONE;
+				} else if (strcmp(val.c_str(), "UNIFORM") == 0) {
+					Content_Popularity = Utils::Content_Popularity_Type::UNIFORM;
+				} else if (strcmp(val.c_str(), "ZIPF") == 0) {
+					Content_Popularity = Utils::Content_Popularity_Type::ZIPF;
+				} else {
+					PRINT_ERROR("Wrong content popularity type for input synthetic flow")
+				}
+			} else if (strcmp(param->name(), "Content_Compressed_Percentage") == 0) {
+				std::string val = param->value();
+				Content_Compressed_Percentage = std::stoi(val);
 			}
 		}
 	} catch (...) {
@@ -434,6 +481,10 @@ void IO_Flow_Parameter_Set_Trace_Based::XML_serialize(Utils::XmlWriter& xmlwrite
 	}
 	xmlwriter.Write_attribute_string(attr, val);
 
+	attr = "Fingerprint_File_Path";
+	val = Fingerprint_File_Path;
+	xmlwriter.Write_attribute_string(attr, val);
+
 	xmlwriter.Write_close_tag();
 }
 
@@ -451,6 +502,8 @@ void IO_Flow_Parameter_Set_Trace_Based::XML_deserialize(rapidxml::xml_node<> *no
 				Percentage_To_Be_Executed = std::stoi(val);
 			} else if (strcmp(param->name(), "File_Path") == 0) {
 				File_Path = param->value();
+			} else if (strcmp(param->name(), "Fingerprint_File_Path") == 0) {
+				Fingerprint_File_Path = param->value();
 			} else if (strcmp(param->name(), "Time_Unit") == 0) {
 				std::string val = param->value();
 				std::transform(val.begin(), val.end(), val.begin(), ::toupper);
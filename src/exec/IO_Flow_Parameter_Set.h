@@ -31,7 +31,7 @@ private:
 class IO_Flow_Parameter_Set_Synthetic : public IO_Flow_Parameter_Set
 {
 public:
-	IO_Flow_Parameter_Set_Synthetic() { this->Type = Flow_Type::SYNTHETIC; }
+	IO_Flow_Parameter_Set_Synthetic() : Content_Duplicate_Percentage(0), Content_Universe_Size(0), Content_Popularity(Utils::Content_Popularity_Type::NONE), Content_Compressed_Percentage(100) { this->Type = Flow_Type::SYNTHETIC; }
 	unsigned int Working_Set_Percentage;//Percentage of available storage space that is accessed
 	Utils::Request_Generator_Type Synthetic_Generator_Type;
 	char Read_Percentage;
@@ -49,6 +49,10 @@ public:
 
 	sim_time_type Stop_Time;//Defines when to stop generating I/O requests
 	unsigned int Total_Requests_To_Generate;//If Stop_Time is equal to zero, then requst generator considers Total_Requests_To_Generate to decide when to stop generating I/O requests
+	unsigned int Content_Duplicate_Percentage;//** Append for CAFTL: target percentage of written pages that repeat an earlier content
+	unsigned int Content_Universe_Size;//** Append for CAFTL: number of distinct contents that the flow writes, 0 for no limit
+	Utils::Content_Popularity_Type Content_Popularity;//** Append for CAFTL: NONE if the writes of the flow carry no content
+	unsigned int Content_Compressed_Percentage;//** Append for CAFTL: mean compressed size of a content in percent of its size, 100 for incompressible data
 	
 	void XML_serialize(Utils::XmlWriter& xmlwriter);
 	void XML_deserialize(rapidxml::xml_node<> *node);
@@ -62,6 +66,7 @@ public:
 	int Percentage_To_Be_Executed;
 	int Relay_Count; 
 	Trace_Time_Unit Time_Unit;
+	std::string Fingerprint_File_Path;//** Append for CAFTL: optional fingerprint feed, used for writes whose trace line has no fingerprint column
 	
 	void XML_serialize(Utils::XmlWriter& xmlwriter);
 	void XML_deserialize(rapidxml::xml_node<> *node);
@@ -2,6 +2,7 @@
 #include <stdexcept>
 #include <ctime>
 #include "SSD_Device.h"
+#include "Host_Parameter_Set.h"
 #include "../ssd/ONFI_Channel_Base.h"
 #include "../ssd/Flash_Block_Manager.h"
 #include "../ssd/Data_Cache_Manager_Flash_Advanced.h"
@@ -10,6 +11,7 @@
 #include "../ssd/Address_Mapping_Unit_Page_Level.h"
 #include "../ssd/Address_Mapping_Unit_Hybrid.h"
 #include "../ssd/GC_and_WL_Unit_Page_Level.h"
+#include "../ssd/Fingerprint_Engine.h"
 #include "../ssd/TSU_OutofOrder.h"
 #include "../ssd/TSU_Priority_OutOfOrder.h"
 #include "../ssd/TSU_FLIN.h"
@@ -26,6 +28,8 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 	Simulator->AddObject(device);
 
 	device->Preconditioning_required = parameters->Enabled_Preconditioning;
+	device->Checkpoint_save_path = parameters->Checkpoint_Save_Path;
+	device->Checkpoint_load_path = parameters->Checkpoint_Load_Path;
 	device->Memory_Type = parameters->Memory_Type;
 
 	switch (Memory_Type)
@@ -194,7 +198,7 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 		fbm = new SSD_Components::Flash_Block_Manager(NULL, parameters->Flash_Parameters.Block_PE_Cycles_Limit,
 													  (unsigned int)io_flows->size(), parameters->Flash_Channel_Count, parameters->Chip_No_Per_Channel,
 													  parameters->Flash_Parameters.Die_No_Per_Chip, parameters->Flash_Parameters.Plane_No_Per_Die,
-													  parameters->Flash_Parameters.Block_No_Per_Plane, parameters->Flash_Parameters.Page_No_Per_Block);
+													  parameters->Flash_Parameters.Block_No_Per_Plane, parameters->Flash_Parameters.Page_No_Per_Block, parameters->Shared_Data_Write_Frontier);
 		ftl->BlockManager = fbm;
 
 		//Step 7: create Address_Mapping_Unit
@@ -203,9 +207,18 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 		std::vector<std::vector<flash_chip_ID_type>> flow_chip_id_assignments;
 		std::vector<std::vector<flash_die_ID_type>> flow_die_id_assignments;
 		std::vector<std::vector<flash_plane_ID_type>> flow_plane_id_assignments;
+		std::vector<std::string> flow_fingerprint_file_paths;//** Append for CAFTL
 		unsigned int stream_count = 0;
 		for (unsigned int i = 0; i < io_flows->size(); i++)
 		{
+			if ((*io_flows)[i]->Type == Flow_Type::TRACE)
+			{
+				flow_fingerprint_file_paths.push_back(((IO_Flow_Parameter_Set_Trace_Based *)(*io_flows)[i])->Fingerprint_File_Path);
+			}
+			else
+			{
+				flow_fingerprint_file_paths.push_back("");
+			}
 			switch (parameters->HostInterface_Type)
 			{
 			case HostInterface_Types::SATA:
@@ -285,7 +298,12 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 																	  flow_channel_id_assignments, flow_chip_id_assignments, flow_die_id_assignments, flow_plane_id_assignments,
 																	  parameters->Flash_Parameters.Block_No_Per_Plane, parameters->Flash_Parameters.Page_No_Per_Block,
 																	  parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, parameters->Flash_Parameters.Page_Capacity, parameters->Overprovisioning_Ratio,
-																	  parameters->CMT_Sharing_Mode);
+																	  flow_fingerprint_file_paths, parameters->FP_Cache_Capacity, parameters->FP_Cache_Replacement_Policy,
+																	  parameters->FP_Filter_Size, parameters->FP_Filter_Hash_No, parameters->FP_Filter_Probe_Time,
+																	  parameters->SMT_Cache_Capacity, parameters->SMT_Cache_Replacement_Policy,
+																	  parameters->Dedup_Sampling_Unit, parameters->Dedup_Sampling_Rule, parameters->Dedup_Prehash_Enabled, parameters->Dedup_Mode,
+																	  parameters->Dedup_Chunk_Size, parameters->Compression_Enabled, parameters->Dedup_Verify_Enabled, parameters->Global_Dedup_Enabled, parameters->GC_Dedup_Enabled,
+																	  Host_Parameter_Set::Enable_ResponseTime_Logging ? Host_Parameter_Set::ResponseTime_Logging_Period_Length : 0, parameters->CMT_Sharing_Mode);
 			break;
 		case SSD_Components::Flash_Address_Mapping_Type::HYBRID:
 			amu = new SSD_Components::Address_Mapping_Unit_Hybrid(ftl->ID() + ".AddressMappingUnit", ftl, (SSD_Components::NVM_PHY_ONFI *)device->PHY,
@@ -300,6 +318,30 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 		Simulator->AddObject(amu);
 		ftl->Address_Mapping_Unit = amu;
 
+		//**Append for CAFTL: a synthetic flow may generate the content of its writes instead of reading a fingerprint file
+		for (unsigned int i = 0; i < io_flows->size() && i < stream_count; i++)
+		{
+			if ((*io_flows)[i]->Type != Flow_Type::SYNTHETIC)
+			{
+				continue;
+			}
+			IO_Flow_Parameter_Set_Synthetic *flow = (IO_Flow_Parameter_Set_Synthetic *)(*io_flows)[i];
+			SSD_Components::Deduplicator *deduplicator = amu->Get_deduplicator(i);
+			if (flow->Content_Popularity != Utils::Content_Popularity_Type::NONE && deduplicator != NULL)
+			{
+				deduplicator->Content = new SSD_Components::Content_Generator(flow->Content_Duplicate_Percentage / double(100.0),
+																			  flow->Content_Universe_Size, flow->Content_Popularity, flow->Seed, flow->Content_Compressed_Percentage,
+																			  parameters->Dedup_Chunk_Size == 0 ? parameters->Flash_Parameters.Page_Capacity : parameters->Dedup_Chunk_Size);
+			}
+		}
+
+		//**Append for CAFTL: create the fingerprint engine that hashes user writes before they are dispatched
+		SSD_Components::Fingerprint_Engine *fpe = new SSD_Components::Fingerprint_Engine(ftl->ID() + ".FingerprintEngine", ftl,
+																						  parameters->FP_Engine_Unit_No, parameters->FP_Engine_Unit_Throughput, parameters->FP_Engine_Weak_Hash_Throughput,
+																						  parameters->Flash_Parameters.Page_Capacity, parameters->Dedup_Idle_Threshold);
+		Simulator->AddObject(fpe);
+		ftl->Fingerprint_engine = fpe;
+
 		//Step 8: create GC_and_WL_unit
 		double max_rho = 0;
 		for (unsigned int i = 0; i < io_flows->size(); i++)
@@ -333,6 +375,8 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 		switch (parameters->Caching_Mechanism)
 		{
 		case SSD_Components::Caching_Mechanism::SIMPLE:
+			if (parameters->Data_Cache_Content_Aware)
+				PRINT_ERROR("Data_Cache_Content_Aware requires the ADVANCED caching mechanism!")
 			dcm = new SSD_Components::Data_Cache_Manager_Flash_Simple(device->ID() + ".DataCache", NULL, ftl, (SSD_Components::NVM_PHY_ONFI *)device->PHY,
 																	  parameters->Data_Cache_Capacity, parameters->Data_Cache_DRAM_Row_Size, parameters->Data_Cache_DRAM_Data_Rate,
 																	  parameters->Data_Cache_DRAM_Data_Busrt_Size, parameters->Data_Cache_DRAM_tRCD, parameters->Data_Cache_DRAM_tCL, parameters->Data_Cache_DRAM_tRP,
@@ -345,7 +389,8 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 																		parameters->Data_Cache_Capacity, parameters->Data_Cache_DRAM_Row_Size, parameters->Data_Cache_DRAM_Data_Rate,
 																		parameters->Data_Cache_DRAM_Data_Busrt_Size, parameters->Data_Cache_DRAM_tRCD, parameters->Data_Cache_DRAM_tCL, parameters->Data_Cache_DRAM_tRP,
 																		caching_modes, parameters->Data_Cache_Sharing_Mode, (unsigned int)io_flows->size(),
-																		parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, parameters->Flash_Channel_Count * parameters->Chip_No_Per_Channel * parameters->Flash_Parameters.Die_No_Per_Chip * parameters->Flash_Parameters.Plane_No_Per_Die * parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE);
+																		parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, parameters->Flash_Channel_Count * parameters->Chip_No_Per_Channel * parameters->Flash_Parameters.Die_No_Per_Chip * parameters->Flash_Parameters.Plane_No_Per_Die * parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE,
+																		parameters->Data_Cache_Content_Aware);
 
 			break;
 		default:
@@ -357,16 +402,17 @@ SSD_Device::SSD_Device(Device_Parameter_Set *parameters, std::vector<IO_Flow_Par
 		device->Cache_manager = dcm;
 
 		//Step 10: create Host_Interface
+		unsigned int sectors_per_dedup_chunk = (parameters->Dedup_Chunk_Size == 0 ? parameters->Flash_Parameters.Page_Capacity : parameters->Dedup_Chunk_Size) / SECTOR_SIZE_IN_BYTE;//** Append for CAFTL
 		switch (parameters->HostInterface_Type)
 		{
 		case HostInterface_Types::NVME:
 			device->Host_interface = new SSD_Components::Host_Interface_NVMe(device->ID() + ".HostInterface",
 																			 Utils::Logical_Address_Partitioning_Unit::Get_total_device_lha_count(), parameters->IO_Queue_Depth, parameters->IO_Queue_Depth,
-																			 (unsigned int)io_flows->size(), parameters->Queue_Fetch_Size, parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, dcm);
+																			 (unsigned int)io_flows->size(), parameters->Queue_Fetch_Size, parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, sectors_per_dedup_chunk, dcm);
 			break;
 		case HostInterface_Types::SATA:
 			device->Host_interface = new SSD_Components::Host_Interface_SATA(device->ID() + ".HostInterface",
-																			 parameters->IO_Queue_Depth, Utils::Logical_Address_Partitioning_Unit::Get_total_device_lha_count(), parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, dcm);
+																			 parameters->IO_Queue_Depth, Utils::Logical_Address_Partitioning_Unit::Get_total_device_lha_count(), parameters->Flash_Parameters.Page_Capacity / SECTOR_SIZE_IN_BYTE, sectors_per_dedup_chunk, dcm);
 
 			break;
 		default:
@@ -394,9 +440,10 @@ SSD_Device::~SSD_Device()
 
 	delete this->PHY;
 	delete ((SSD_Components::FTL *)this->Firmware)->TSU;
+	delete ((SSD_Components::FTL *)this->Firmware)->Address_Mapping_Unit;//Reports CAFTL statistics from the OOB metadata of the blocks, so it goes first
 	delete ((SSD_Components::FTL *)this->Firmware)->BlockManager;
-	delete ((SSD_Components::FTL *)this->Firmware)->Address_Mapping_Unit;
 	delete ((SSD_Components::FTL *)this->Firmware)->GC_and_WL_Unit;
+	delete ((SSD_Components::FTL *)this->Firmware)->Fingerprint_engine;
 	delete this->Firmware;
 	delete this->Cache_manager;
 	delete this->Host_interface;
@@ -413,7 +460,16 @@ void SSD_Device::Perform_preconditioning(std::vector<Utils::Workload_Statistics
 	{
 		time_t start_time = time(0);
 		PRINT_MESSAGE("SSD Device preconditioning started .........");
-		this->Firmware->Perform_precondition(workload_stats);
+		if (Checkpoint_load_path != "") {//** Append for CAFTL, the workload statistics are still needed to warm up the data cache
+			PRINT_MESSAGE("Loading the FTL state from " << Checkpoint_load_path);
+			((SSD_Components::FTL*)this->Firmware)->Load_checkpoint(Checkpoint_load_path);
+		} else {
+			this->Firmware->Perform_precondition(workload_stats);
+		}
+		if (Checkpoint_save_path != "") {
+			PRINT_MESSAGE("Saving the FTL state to " << Checkpoint_save_path);
+			((SSD_Components::FTL*)this->Firmware)->Save_checkpoint(Checkpoint_save_path);
+		}
 		this->Cache_manager->Do_warmup(workload_stats);
 		time_t end_time = time(0);
 		uint64_t duration = (uint64_t)difftime(end_time, start_time);
@@ -444,6 +500,7 @@ void SSD_Device::Report_results_in_XML(std::string name_prefix, Utils::XmlWriter
 	{
 		((SSD_Components::FTL *)this->Firmware)->Report_results_in_XML(ID(), xmlwriter);
 		((SSD_Components::FTL *)this->Firmware)->TSU->Report_results_in_XML(ID(), xmlwriter);
+		((SSD_Components::FTL *)this->Firmware)->Fingerprint_engine->Report_results_in_XML(ID(), xmlwriter);
 
 		for (unsigned int channel_cntr = 0; channel_cntr < Channel_count; channel_cntr++)
 		{
@@ -10,11 +10,17 @@ enum class Trace_Time_Unit { PICOSECOND, NANOSECOND, MICROSECOND};//The unit of
 #define ASCIITraceAddressColumn 2
 #define ASCIITraceSizeColumn 3
 #define ASCIITraceTypeColumn 4
+#define ASCIITraceFingerprintColumn 5//** Append for CAFTL: optional, comma separated hex digests, one per page touched by a write
 #define ASCIITraceWriteCode "0"
 #define ASCIITraceReadCode "1"
+#define ASCIITraceTrimCode "2"//** Append for CAFTL
 #define ASCIITraceWriteCodeInteger 0
 #define ASCIITraceReadCodeInteger 1
+#define ASCIITraceTrimCodeInteger 2//** Append for CAFTL
 #define ASCIILineDelimiter ' '
+#define ASCIIFingerprintDelimiter ','
+#define ASCIICompressedSizeDelimiter ':'//** Append for CAFTL: a fingerprint may be followed by the compressed size of its content in bytes
 #define ASCIIItemsPerLine 5
+#define ASCIIItemsPerLineWithFingerprints 6
 
 #endif // !ASCII_TRACE_DEFINITION_H
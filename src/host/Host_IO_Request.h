@@ -1,11 +1,13 @@
 #ifndef HOST_IO_REQUEST_H
 #define HOST_IO_REQUEST_H
 
+#include <vector>
 #include "../ssd/SSD_Defs.h"
+#include "../nvm_chip/flash_memory/FlashTypes.h"
 
 namespace Host_Components
 {
-	enum class Host_IO_Request_Type { READ, WRITE };
+	enum class Host_IO_Request_Type { READ, WRITE, TRIM };//** Append for CAFTL: TRIM tells the device that the data of an LBA range is not needed anymore
 	class Host_IO_Request
 	{
 	public:
@@ -16,6 +18,8 @@ namespace Host_Components
 		Host_IO_Request_Type Type;
 		uint16_t IO_queue_info;
 		uint16_t Source_flow_id;//Only used in SATA host interface
+		std::vector<FP_type> Fingerprints;//** Append for CAFTL: per-page fingerprints of a write, empty if the trace carries none
+		std::vector<uint32_t> Compressed_sizes;//** Append for CAFTL: compressed size in bytes of the content of each fingerprint, 0 if unknown, empty if the trace carries none
 	};
 }
 
@@ -170,7 +170,8 @@ IO_Flow_Base::IO_Flow_Base(const sim_object_id_type &name, uint16_t flow_id, LHA
 		if (request_delay < STAT_min_request_delay) {
 			STAT_min_request_delay = request_delay;
 		}
-		STAT_transferred_bytes_total += request->LBA_count * SECTOR_SIZE_IN_BYTE;
+		if (request->Type != Host_IO_Request_Type::TRIM)//** Append for CAFTL: a TRIM transfers no data
+			STAT_transferred_bytes_total += request->LBA_count * SECTOR_SIZE_IN_BYTE;
 
 		if (request->Type == Host_IO_Request_Type::READ) {
 			STAT_serviced_read_request_count++;
@@ -189,7 +190,7 @@ IO_Flow_Base::IO_Flow_Base(const sim_object_id_type &name, uint16_t flow_id, LHA
 				STAT_min_request_delay_read = request_delay;
 			}
 			STAT_transferred_bytes_read += request->LBA_count * SECTOR_SIZE_IN_BYTE;
-		} else {
+		} else if (request->Type == Host_IO_Request_Type::WRITE) {//** Modified for CAFTL: a TRIM only counts in the overall statistics
 			STAT_serviced_write_request_count++;
 			STAT_sum_device_response_time_write += device_response_time;
 			STAT_sum_request_delay_write += request_delay;
@@ -271,7 +272,8 @@ IO_Flow_Base::IO_Flow_Base(const sim_object_id_type &name, uint16_t flow_id, LHA
 		if (request_delay < STAT_min_request_delay) {
 			STAT_min_request_delay = request_delay;
 		}
-		STAT_transferred_bytes_total += request->LBA_count * SECTOR_SIZE_IN_BYTE;
+		if (request->Type != Host_IO_Request_Type::TRIM)//** Append for CAFTL: a TRIM transfers no data
+			STAT_transferred_bytes_total += request->LBA_count * SECTOR_SIZE_IN_BYTE;
 		
 		if (request->Type == Host_IO_Request_Type::READ) {
 			STAT_serviced_read_request_count++;
@@ -290,7 +292,7 @@ IO_Flow_Base::IO_Flow_Base(const sim_object_id_type &name, uint16_t flow_id, LHA
 				STAT_min_request_delay_read = request_delay;
 			}
 			STAT_transferred_bytes_read += request->LBA_count * SECTOR_SIZE_IN_BYTE;
-		} else {
+		} else if (request->Type == Host_IO_Request_Type::WRITE) {//** Modified for CAFTL: a TRIM only counts in the overall statistics
 			STAT_serviced_write_request_count++;
 			STAT_sum_device_response_time_write += device_response_time;
 			STAT_sum_request_delay_write += request_delay;
@@ -385,13 +387,27 @@ IO_Flow_Base::IO_Flow_Base(const sim_object_id_type &name, uint16_t flow_id, LHA
 		sqe->Command_Identifier = request->IO_queue_info;
 		if (request->Type == Host_IO_Request_Type::READ) {
 			sqe->Opcode = NVME_READ_OPCODE;
+			sqe->Metadata_pointer_1 = 0;
+			sqe->Metadata_pointer_2 = 0;
 			sqe->Command_specific[0] = (uint32_t) request->Start_LBA;
 			sqe->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
 			sqe->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
 			sqe->PRP_entry_1 = (DATA_MEMORY_REGION);//Dummy addresses, just to emulate data read/write access
 			sqe->PRP_entry_2 = (DATA_MEMORY_REGION + 0x1000);//Dummy addresses
+		} else if (request->Type == Host_IO_Request_Type::TRIM) {//** Append for CAFTL: no data is transferred
+			sqe->Opcode = NVME_DATASET_MANAGEMENT_OPCODE;
+			sqe->Metadata_pointer_1 = 0;
+			sqe->Metadata_pointer_2 = 0;
+			sqe->Command_specific[0] = (uint32_t)request->Start_LBA;
+			sqe->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
+			sqe->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
+			sqe->PRP_entry_1 = 0;
+			sqe->PRP_entry_2 = 0;
 		} else {
 			sqe->Opcode = NVME_WRITE_OPCODE;
+			//** Append for CAFTL: per-page fingerprints are exposed to the device through the metadata pointer
+			sqe->Metadata_pointer_1 = request->Fingerprints.empty() ? 0 : (uint64_t)(intptr_t)&request->Fingerprints;
+			sqe->Metadata_pointer_2 = request->Compressed_sizes.empty() ? 0 : (uint64_t)(intptr_t)&request->Compressed_sizes;
 			sqe->Command_specific[0] = (uint32_t)request->Start_LBA;
 			sqe->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
 			sqe->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
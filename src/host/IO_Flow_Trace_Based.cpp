@@ -2,6 +2,7 @@
 #include "../utils/StringTools.h"
 #include "ASCII_Trace_Definition.h"
 #include "../utils/DistributionTypes.h"
+#include "../ssd/Fingerprint_Index.h"
 
 namespace Host_Components
 {
@@ -31,19 +32,25 @@ Host_IO_Request *IO_Flow_Trace_Based::Generate_next_request()
 		return NULL;
 	}
 
+	char *pEnd;
 	Host_IO_Request *request = new Host_IO_Request;
-	if (current_trace_line[ASCIITraceTypeColumn].compare(ASCIITraceWriteCode) == 0)
+	//The type token keeps its trailing delimiter when a fingerprint column follows it, so it is compared numerically
+	unsigned long type_code = std::strtoul(current_trace_line[ASCIITraceTypeColumn].c_str(), &pEnd, 10);
+	if (type_code == ASCIITraceWriteCodeInteger)
 	{
 		request->Type = Host_IO_Request_Type::WRITE;
 		STAT_generated_write_request_count++;
 	}
+	else if (type_code == ASCIITraceTrimCodeInteger)//** Append for CAFTL
+	{
+		request->Type = Host_IO_Request_Type::TRIM;
+	}
 	else
 	{
 		request->Type = Host_IO_Request_Type::READ;
 		STAT_generated_read_request_count++;
 	}
 
-	char *pEnd;
 	request->LBA_count = std::strtoul(current_trace_line[ASCIITraceSizeColumn].c_str(), &pEnd, 0);
 
 	request->Start_LBA = std::strtoull(current_trace_line[ASCIITraceAddressColumn].c_str(), &pEnd, 0);
@@ -56,6 +63,39 @@ Host_IO_Request *IO_Flow_Trace_Based::Generate_next_request()
 		request->Start_LBA = start_lsa_on_device + request->Start_LBA % (end_lsa_on_device - start_lsa_on_device);
 	}
 
+	//** Append for CAFTL: fingerprints travel with the write instead of through a separate fingerprint file
+	if (request->Type == Host_IO_Request_Type::WRITE && current_trace_line.size() == ASCIIItemsPerLineWithFingerprints)
+	{
+		const std::string &column = current_trace_line[ASCIITraceFingerprintColumn];
+		size_t start = 0;
+		while (start < column.size())
+		{
+			size_t end = column.find(ASCIIFingerprintDelimiter, start);
+			if (end == std::string::npos)
+			{
+				end = column.size();
+			}
+			size_t size_start = column.find(ASCIICompressedSizeDelimiter, start);
+			if (size_start == std::string::npos || size_start > end)
+			{
+				size_start = end;
+			}
+			FP_type fp;
+			Parse_fingerprint(column.substr(start, size_start - start), fp);
+			request->Fingerprints.push_back(fp);
+			if (size_start < end)
+			{
+				request->Compressed_sizes.resize(request->Fingerprints.size() - 1, 0);
+				request->Compressed_sizes.push_back((uint32_t)std::strtoul(column.substr(size_start + 1, end - size_start - 1).c_str(), NULL, 10));
+			}
+			start = end + 1;
+		}
+		if (!request->Compressed_sizes.empty())
+		{
+			request->Compressed_sizes.resize(request->Fingerprints.size(), 0);
+		}
+	}
+
 	request->Arrival_time = time_offset + Simulator->Time();
 	STAT_generated_request_count++;
 
@@ -92,7 +132,7 @@ void IO_Flow_Trace_Based::Start_simulation()
 		Utils::Helper_Functions::Remove_cr(trace_line);
 		current_trace_line.clear();
 		Utils::Helper_Functions::Tokenize(trace_line, ASCIILineDelimiter, current_trace_line);
-		if (current_trace_line.size() != ASCIIItemsPerLine)
+		if (current_trace_line.size() != ASCIIItemsPerLine && current_trace_line.size() != ASCIIItemsPerLineWithFingerprints)
 		{
 			break;
 		}
@@ -202,7 +242,7 @@ void IO_Flow_Trace_Based::Get_statistics(Utils::Workload_Statistics &stats, LPA_
 		Utils::Helper_Functions::Remove_cr(trace_line);
 		line_splitted.clear();
 		Utils::Helper_Functions::Tokenize(trace_line, ASCIILineDelimiter, line_splitted);
-		if (line_splitted.size() != ASCIIItemsPerLine)
+		if (line_splitted.size() != ASCIIItemsPerLine && line_splitted.size() != ASCIIItemsPerLineWithFingerprints)
 		{
 			break;
 		}
@@ -214,6 +254,10 @@ void IO_Flow_Trace_Based::Get_statistics(Utils::Workload_Statistics &stats, LPA_
 		}
 		sim_time_type diff = (last_request_arrival_time - prev_time) / 1000; //The arrival rate histogram is stored in the microsecond unit
 		sum_inter_arrival += last_request_arrival_time - prev_time;
+		if (std::strtoul(line_splitted[ASCIITraceTypeColumn].c_str(), &pEnd, 10) == ASCIITraceTrimCodeInteger)
+		{
+			continue;//** Append for CAFTL: a TRIM accesses no data, so preconditioning ignores it
+		}
 
 		unsigned int LBA_count = std::strtoul(line_splitted[ASCIITraceSizeColumn].c_str(), &pEnd, 0);
 		sum_request_size += LBA_count;
@@ -237,7 +281,7 @@ void IO_Flow_Trace_Based::Get_statistics(Utils::Workload_Statistics &stats, LPA_
 		{
 			LPA_type device_address = Convert_host_logical_address_to_device_address(start_LBA);
 			page_status_type access_status_bitmap = Find_NVM_subunit_access_bitmap(start_LBA);
-			if (line_splitted[ASCIITraceTypeColumn].compare(ASCIITraceWriteCode) == 0)
+			if (std::strtoul(line_splitted[ASCIITraceTypeColumn].c_str(), &pEnd, 10) == ASCIITraceWriteCodeInteger)
 			{
 				if (stats.Write_address_access_pattern.find(device_address) == stats.Write_address_access_pattern.end())
 				{
@@ -286,7 +330,7 @@ void IO_Flow_Trace_Based::Get_statistics(Utils::Workload_Statistics &stats, LPA_
 		}
 
 		//Request size statistics
-		if (line_splitted[ASCIITraceTypeColumn].compare(ASCIITraceWriteCode) == 0)
+		if (std::strtoul(line_splitted[ASCIITraceTypeColumn].c_str(), &pEnd, 10) == ASCIITraceWriteCodeInteger)
 		{
 			if (diff < MAX_ARRIVAL_TIME_HISTOGRAM)
 			{
@@ -329,8 +373,9 @@ void IO_Flow_Trace_Based::Get_statistics(Utils::Workload_Statistics &stats, LPA_
 		stats.Total_generated_requests++;
 	}
 	trace_file_temp.close();
-	stats.Average_request_size_sector = (unsigned int)(sum_request_size / stats.Total_generated_requests);
-	stats.Average_inter_arrival_time_nano_sec = sum_inter_arrival / stats.Total_generated_requests;
+	//** Modified for CAFTL: a trace may hold nothing but TRIMs
+	stats.Average_request_size_sector = stats.Total_generated_requests == 0 ? 0 : (unsigned int)(sum_request_size / stats.Total_generated_requests);
+	stats.Average_inter_arrival_time_nano_sec = stats.Total_generated_requests == 0 ? 0 : sum_inter_arrival / stats.Total_generated_requests;
 
 	stats.Initial_occupancy_ratio = initial_occupancy_ratio;
 	stats.Replay_no = total_replay_no;
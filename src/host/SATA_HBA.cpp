@@ -153,13 +153,27 @@ namespace Host_Components
 		//For simplicity, MQSim's SATA host interface uses NVMe opcodes
 		if (request->Type == Host_IO_Request_Type::READ) {
 			ncq_entry->Opcode = NVME_READ_OPCODE;
+			ncq_entry->Metadata_pointer_1 = 0;
+			ncq_entry->Metadata_pointer_2 = 0;
 			ncq_entry->Command_specific[0] = (uint32_t)request->Start_LBA;
 			ncq_entry->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
 			ncq_entry->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
 			ncq_entry->PRP_entry_1 = (DATA_MEMORY_REGION);//Dummy addresses, just to emulate data read/write access
 			ncq_entry->PRP_entry_2 = (DATA_MEMORY_REGION + 0x1000);//Dummy addresses
+		} else if (request->Type == Host_IO_Request_Type::TRIM) {//** Append for CAFTL: no data is transferred
+			ncq_entry->Opcode = NVME_DATASET_MANAGEMENT_OPCODE;
+			ncq_entry->Metadata_pointer_1 = 0;
+			ncq_entry->Metadata_pointer_2 = 0;
+			ncq_entry->Command_specific[0] = (uint32_t)request->Start_LBA;
+			ncq_entry->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
+			ncq_entry->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
+			ncq_entry->PRP_entry_1 = 0;
+			ncq_entry->PRP_entry_2 = 0;
 		} else {
 			ncq_entry->Opcode = NVME_WRITE_OPCODE;
+			//** Append for CAFTL: per-page fingerprints are exposed to the device through the metadata pointer
+			ncq_entry->Metadata_pointer_1 = request->Fingerprints.empty() ? 0 : (uint64_t)(intptr_t)&request->Fingerprints;
+			ncq_entry->Metadata_pointer_2 = request->Compressed_sizes.empty() ? 0 : (uint64_t)(intptr_t)&request->Compressed_sizes;
 			ncq_entry->Command_specific[0] = (uint32_t)request->Start_LBA;
 			ncq_entry->Command_specific[1] = (uint32_t)(request->Start_LBA >> 32);
 			ncq_entry->Command_specific[2] = ((uint32_t)((uint16_t)request->LBA_count)) & (uint32_t)(0x0000ffff);
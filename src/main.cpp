@@ -9,6 +9,7 @@
 #include "exec/Host_System.h"
 #include "utils/rapidxml/rapidxml.hpp"
 #include "utils/DistributionTypes.h"
+#include "ssd/Fingerprint_Feed.h"
 
 using namespace std;
 
@@ -228,7 +229,7 @@ std::vector<std::vector<IO_Flow_Parameter_Set*>*>* read_workload_definitions(con
 	return io_scenarios;
 }
 
-void collect_results(SSD_Device& ssd, Host_System& host, const char* output_file_path)
+bool collect_results(SSD_Device& ssd, Host_System& host, const char* output_file_path)//** Modified for CAFTL: false if a flow has requests that were never serviced
 {
 	Utils::XmlWriter xmlwriter;
 	xmlwriter.Open(output_file_path);
@@ -248,18 +249,38 @@ void collect_results(SSD_Device& ssd, Host_System& host, const char* output_file
 		cout << "                   - device response time: " << IO_flows[stream_id]->Get_device_response_time() << " (us)"
 			<< " end-to-end request delay:" << IO_flows[stream_id]->Get_end_to_end_request_delay() << " (us)" << endl;
 	}
+
+	//** Append for CAFTL: the simulation only ends when no event is left, so a request that is not serviced by then is stuck in the device
+	bool all_serviced = true;
+	for (unsigned int stream_id = 0; stream_id < IO_flows.size(); stream_id++) {
+		if (IO_flows[stream_id]->Get_serviced_request_count() != IO_flows[stream_id]->Get_generated_request_count()) {
+			std::cerr << "ERROR:Flow " << IO_flows[stream_id]->ID() << " ended with " << IO_flows[stream_id]->Get_generated_request_count() - IO_flows[stream_id]->Get_serviced_request_count()
+				<< " requests that were never serviced, its results are not valid!" << endl;
+			all_serviced = false;
+		}
+	}
+	return all_serviced;
 }
 
 void print_help()
 {
 	cout << "MQSim - SSD simulator with both NVMe and SATA host interface behavior, see ReadMe.md for details" << endl <<
 		"Standalone Usage:" << endl <<
-		"./MQSim [-i path/to/config/file] [-w path/to/workload/file]" << endl;
+		"./MQSim [-i path/to/config/file] [-w path/to/workload/file]" << endl <<
+		"Fingerprint conversion (text, one hex digest per line, to packed binary):" << endl <<
+		"./MQSim -convert_fp path/to/text/fingerprints path/to/binary/fingerprints" << endl;
 }
 
 int main(int argc, char* argv[])
 {
 	string ssd_config_file_path, workload_defs_file_path;
+	if (argc == 4 && strcmp(argv[1], "-convert_fp") == 0) {
+		if (!SSD_Components::Fingerprint_Feed::Convert_text_to_binary(argv[2], argv[3])) {
+			PRINT_MESSAGE("Fingerprint conversion failed.")
+			return 1;
+		}
+		return 0;
+	}
 	if (argc != 5) {
 		// MQSim expects 2 arguments: 1) the path to the SSD configuration definition file, and 2) the path to the workload definition file
 		print_help();
@@ -273,6 +294,7 @@ int main(int argc, char* argv[])
 	std::vector<std::vector<IO_Flow_Parameter_Set*>*>* io_scenarios = read_workload_definitions(workload_defs_file_path);
 
 	int cntr = 1;
+	bool unserviced_requests = false;//** Append for CAFTL
 	for (auto io_scen = io_scenarios->begin(); io_scen != io_scenarios->end(); io_scen++, cntr++) {
 		time_t start_time = time(0);
 		char* dt = ctime(&start_time);
@@ -303,11 +325,13 @@ int main(int argc, char* argv[])
 		PRINT_MESSAGE("");
 
 		PRINT_MESSAGE("Writing results to output file .......");
-		collect_results(ssd, host, (workload_defs_file_path.substr(0, workload_defs_file_path.find_last_of(".")) + "_scenario_" + std::to_string(cntr) + ".xml").c_str());
+		if (!collect_results(ssd, host, (workload_defs_file_path.substr(0, workload_defs_file_path.find_last_of(".")) + "_scenario_" + std::to_string(cntr) + ".xml").c_str())) {
+			unserviced_requests = true;
+		}
 	}
     cout << "Simulation complete; Press any key to exit." << endl;
 
 	cin.get(); // Disable if you prefer batch runs
 
-	return 0;
+	return unserviced_requests ? 1 : 0;
 }
\ No newline at end of file
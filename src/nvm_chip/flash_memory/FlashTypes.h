@@ -2,6 +2,7 @@
 #define FLASH_TYPES_H
 
 #include<cstdint>
+#include<cstring>
 #include "../../sim/Sim_Defs.h"
 #include "../NVM_Types.h"
 
@@ -24,7 +25,6 @@ typedef uint32_t flash_page_ID_type;
 typedef uint64_t LPA_type;
 typedef uint64_t PPA_type;
 typedef uint64_t VPA_type;//** Append for CAFTL
-typedef std::string FP_type;//**append for CAFTL
 typedef uint64_t command_code_type;
 
 enum class Flash_Technology_Type { SLC = 1, MLC = 2, TLC = 3 };
@@ -36,4 +36,15 @@ enum class Flash_Technology_Type { SLC = 1, MLC = 2, TLC = 3 };
 #define NO_PPA 0xffffffffffffffffULL
 #define NO_MPPN 0xffffffffULL
 
+//** Append for CAFTL: fixed-width binary fingerprint, 20 bytes for SHA-1 and 32 bytes for SHA-256
+#ifndef FP_DIGEST_SIZE
+#define FP_DIGEST_SIZE 20
+#endif
+struct FP_type
+{
+	uint8_t Digest[FP_DIGEST_SIZE];
+	bool operator==(const FP_type& fp) const { return std::memcmp(Digest, fp.Digest, FP_DIGEST_SIZE) == 0; }
+	bool operator!=(const FP_type& fp) const { return !(*this == fp); }
+};
+
 #endif // !FLASH_TYPES_H
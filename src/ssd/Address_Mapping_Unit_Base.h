@@ -9,11 +9,13 @@
 #include "NVM_PHY_ONFI_NVDDR2.h"
 #include "FTL.h"
 #include "Flash_Block_Manager_Base.h"
+#include "Checkpoint.h"
 
 namespace SSD_Components
 {
 	class FTL;
 	class Flash_Block_Manager_Base;
+	class Deduplicator;
 
 	typedef uint32_t MVPN_type;
 	typedef uint32_t MPPN_type;
@@ -79,6 +81,12 @@ namespace SSD_Components
 		virtual void Remove_barrier_for_accessing_lpa(const stream_id_type stream_id, const LPA_type lpa) = 0; //Removes the barrier that has already been set for accessing an LPA (i.e., the GC_and_WL_Unit_Base unit successfully finished relocating LPA from one physical location to another physical location).
 		virtual void Remove_barrier_for_accessing_mvpn(const stream_id_type stream_id, const MVPN_type mvpn) = 0; //Removes the barrier that has already been set for accessing an MVPN (i.e., the GC_and_WL_Unit_Base unit successfully finished relocating MVPN from one physical location to another physical location).
 		virtual void Start_servicing_writes_for_overfull_plane(const NVM::FlashMemory::Physical_Page_Address plane_address) = 0;//This function is invoked when GC execution is finished on a plane and the plane has enough number of free pages to service writes
+		virtual Deduplicator* Get_deduplicator(const stream_id_type stream_id) { return NULL; }//** Append for CAFTL, NULL if the mapping unit does not deduplicate
+		virtual unsigned int Issue_background_dedup_reads(unsigned int max_read_no, bool& deferred) { deferred = false; return 0; }//** Append for CAFTL, reads pending chunks back from flash for out-of-line dedup, returns the number of issued reads, deferred is set if pending chunks were left for later
+		virtual void Merge_pending_chunk(const stream_id_type stream_id, const FP_type& placeholder) {}//** Append for CAFTL, invoked once the fingerprint engine has hashed a pending chunk
+		virtual void Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter) {}//** Append for CAFTL, dedup statistics of the mapping unit
+		virtual void Save_checkpoint(Checkpoint_Writer& writer) { PRINT_ERROR("The address mapping unit does not support checkpoints!") }//** Append for CAFTL, saves the warm mapping state
+		virtual void Load_checkpoint(Checkpoint_Reader& reader) { PRINT_ERROR("The address mapping unit does not support checkpoints!") }
 	protected:
 		FTL* ftl;
 		NVM_PHY_ONFI* flash_controller;
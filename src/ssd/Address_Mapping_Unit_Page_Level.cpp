@@ -3,8 +3,11 @@
 #include <stdexcept>
 #include <unordered_map>//** Append for CAFTL
 #include <utility>//** Append for CAFTL
+#include <algorithm>//** Append for CAFTL
+#include <cstring>//** Append for CAFTL
 #include "Address_Mapping_Unit_Page_Level.h"
 #include "Stats.h"
+#include "Fingerprint_Engine.h"//** Append for CAFTL
 #include "../utils/Logical_Address_Partitioning_Unit.h"
 #include <iomanip>//** Append for CAFTL output
 
@@ -165,13 +168,50 @@ namespace SSD_Components
 		it->second->Dirty = false;
 	}
 
+	void Cached_Mapping_Table::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Write(capacity);
+		writer.Write((uint64_t)lruList.size());
+		for (auto it = lruList.rbegin(); it != lruList.rend(); it++) {//Least recently used first, so that reinsertion rebuilds the same order
+			if (it->second->Status != CMTEntryStatus::VALID)
+				PRINT_ERROR("A checkpoint cannot be taken while a mapping entry is read from flash!")
+			writer.Write(it->first);
+			writer.Write(it->second->PPA);
+			writer.Write(it->second->WrittenStateBitmap);
+			writer.Write(it->second->Dirty);
+			writer.Write(it->second->Stream_id);
+		}
+	}
+
+	void Cached_Mapping_Table::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Expect(capacity, "CMT_Capacity");
+		uint64_t slot_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < slot_no; i++) {
+			LPA_type key = reader.Read<LPA_type>();
+			CMTSlotType* cmtEnt = new CMTSlotType();
+			cmtEnt->PPA = reader.Read<PPA_type>();
+			cmtEnt->WrittenStateBitmap = reader.Read<unsigned long long>();
+			cmtEnt->Dirty = reader.Read<bool>();
+			cmtEnt->Stream_id = reader.Read<stream_id_type>();
+			cmtEnt->Status = CMTEntryStatus::VALID;
+			lruList.push_front(std::pair<LPA_type, CMTSlotType*>(key, cmtEnt));
+			cmtEnt->listPtr = lruList.begin();
+			addressMap[key] = cmtEnt;
+		}
+	}
+
 
 	AddressMappingDomain::AddressMappingDomain(unsigned int cmt_capacity, unsigned int cmt_entry_size, unsigned int no_of_translation_entries_per_page,
 		Cached_Mapping_Table* CMT,
 		Flash_Plane_Allocation_Scheme_Type PlaneAllocationScheme,
 		flash_channel_ID_type* channel_ids, unsigned int channel_no, flash_chip_ID_type* chip_ids, unsigned int chip_no,
 		flash_die_ID_type* die_ids, unsigned int die_no, flash_plane_ID_type* plane_ids, unsigned int plane_no,
-		PPA_type total_physical_sectors_no, LHA_type total_logical_sectors_no, unsigned int sectors_no_per_page) :
+		PPA_type total_physical_sectors_no, LHA_type total_logical_sectors_no, unsigned int sectors_no_per_page,
+		const std::string& fingerprint_file_path, unsigned int fp_cache_capacity, FP_Cache_Replacement_Policy fp_cache_replacement_policy,
+		unsigned int dedup_sampling_unit, Dedup_Sampling_Rule dedup_sampling_rule, bool dedup_prehash_enabled, Dedup_Mode dedup_mode,
+		unsigned int fp_entries_per_bucket_page, unsigned int smt_cache_capacity, SMT_Cache_Replacement_Policy smt_cache_replacement_policy,
+		unsigned int smt_entries_per_page) :
 		CMT_entry_size(cmt_entry_size), Translation_entries_per_page(no_of_translation_entries_per_page), No_of_inserted_entries_in_preconditioning(0),
 		PlaneAllocationScheme(PlaneAllocationScheme), Channel_no(channel_no), Chip_no(chip_no), Die_no(die_no), Plane_no(plane_no)
 	{
@@ -216,49 +256,35 @@ namespace SSD_Components
 		}
 
 		Total_translation_pages_no = MVPN_type(Total_logical_pages_no / Translation_entries_per_page);
-		GlobalTranslationDirectory = new GTDEntryType[Total_translation_pages_no + 1];
-		for (MVPN_type i = 0; i <= Total_translation_pages_no; i++) {
+		//** Append for CAFTL: the buckets of the fingerprint store can hold one fingerprint per physical page
+		FP_bucket_base_MVPN = Total_translation_pages_no + 1;
+		FP_bucket_no = 0;
+		if (fp_cache_capacity > 0) {
+			FP_bucket_no = MVPN_type(Total_physical_pages_no / fp_entries_per_bucket_page + (Total_physical_pages_no % fp_entries_per_bucket_page == 0 ? 0 : 1));
+		}
+		//** Append for CAFTL: a VPA is derived from a PPA, so the SMT pages hold one entry per physical page
+		SMT_page_base_MVPN = FP_bucket_base_MVPN + FP_bucket_no;
+		SMT_page_no = 0;
+		if (smt_cache_capacity > 0) {
+			SMT_page_no = MVPN_type(Total_physical_pages_no / smt_entries_per_page + (Total_physical_pages_no % smt_entries_per_page == 0 ? 0 : 1));
+		}
+		GlobalTranslationDirectory = new GTDEntryType[SMT_page_base_MVPN + SMT_page_no];
+		for (MVPN_type i = 0; i < SMT_page_base_MVPN + SMT_page_no; i++) {
 			GlobalTranslationDirectory[i].MPPN = (MPPN_type)NO_MPPN;
 			GlobalTranslationDirectory[i].TimeStamp = INVALID_TIME_STAMP;
 		}
 
 		//** Append for CAFTL
-		deduplicator = new Deduplicator();
+		deduplicator = new Deduplicator(fingerprint_file_path, fp_cache_capacity, fp_cache_replacement_policy, (unsigned int)FP_bucket_no,
+			dedup_sampling_unit, dedup_sampling_rule, dedup_prehash_enabled, dedup_mode);
+		if (smt_cache_capacity > 0) {
+			deduplicator->SMTcache = new SMT_Cache(smt_cache_capacity, smt_cache_replacement_policy, smt_entries_per_page, (unsigned int)SMT_page_no);
+		}
 		simpleCMT = new Simple_Cached_Mapping_Table(cmt_capacity);
-
-		FP_type fp_input_file_path = "C:\\Users\\Ron\\Desktop\\FPoutput\\linux\\fp_16k.txt";
-		fp_input_file.open(fp_input_file_path);//** append
-		Total_fp_no = 0;
-		while (std::getline(fp_input_file, cur_fp))
-			Total_fp_no++;
-		fp_input_file.close();
-		fp_input_file.open(fp_input_file_path);
-		Total_page_write_no = 0;
-		GC_page_write_no = 0;
 	}
 
 	AddressMappingDomain::~AddressMappingDomain()
 	{
-		size_t PMT_num = 0;
-		size_t SMT_num = 0;
-		size_t RM_num = 0;
-		size_t invalid_page_num = 0;
-
-		for (size_t lbaidx = 0; lbaidx < Total_logical_pages_no; lbaidx++)
-			if (GlobalMappingTable[lbaidx].PPA != NO_PPA)
-				PMT_num++;
-		for (const auto &entry : SecondaryMappingTable)
-			SMT_num++;
-		for (const auto &entry : ReverseMapping) {
-			RM_num++;
-			if (entry.second.status)
-				invalid_page_num++;
-		}
-
-		DedupOutputFile << "PMT#" << "," << "SMT#" << "," << "FP#" << "," << "RM#" << "," << "Invalid page#" << std::endl;
-		DedupOutputFile << PMT_num << "," << SecondaryMappingTable.size() << "," << deduplicator->Get_FPtable_size() << "," << ReverseMapping.size() << "," << invalid_page_num << std::endl;
-		DedupOutputFile.close();
-
 		delete CMT;
 		delete[] GlobalMappingTable;
 		delete[] GlobalTranslationDirectory;
@@ -275,17 +301,52 @@ namespace SSD_Components
 			Waiting_unmapped_program_transactions.erase(entry_write++);
 		}
 
+		auto fp_lookup_write = Waiting_fingerprint_lookup_transactions.begin();
+		while (fp_lookup_write != Waiting_fingerprint_lookup_transactions.end()) {
+			delete fp_lookup_write->second;
+			Waiting_fingerprint_lookup_transactions.erase(fp_lookup_write++);
+		}
+
+		auto smt_lookup_read = Waiting_SMT_lookup_transactions.begin();
+		while (smt_lookup_read != Waiting_SMT_lookup_transactions.end()) {
+			delete smt_lookup_read->second;
+			Waiting_SMT_lookup_transactions.erase(smt_lookup_read++);
+		}
+
 		delete[] Channel_ids;
 		delete[] Chip_ids;
 		delete[] Die_ids;
 		delete[] Plane_ids;
 
 		//** Append for CAFTL
-		fp_input_file.close();
 		delete deduplicator;
 		//**
 	}
 
+	void AddressMappingDomain::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Begin_section("AMDO");
+		writer.Write(Total_logical_pages_no);
+		writer.Write(SMT_page_base_MVPN + SMT_page_no);
+		writer.Write_array(GlobalMappingTable, Total_logical_pages_no);
+		writer.Write_array(GlobalTranslationDirectory, SMT_page_base_MVPN + SMT_page_no);
+		writer.Write(No_of_inserted_entries_in_preconditioning);
+		simpleCMT->Save_checkpoint(writer);
+		deduplicator->Save_checkpoint(writer);
+	}
+
+	void AddressMappingDomain::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Begin_section("AMDO");
+		reader.Expect(Total_logical_pages_no, "the logical space of a flow");
+		reader.Expect(SMT_page_base_MVPN + SMT_page_no, "the number of translation pages of a flow");
+		reader.Read_array(GlobalMappingTable, Total_logical_pages_no);
+		reader.Read_array(GlobalTranslationDirectory, SMT_page_base_MVPN + SMT_page_no);
+		No_of_inserted_entries_in_preconditioning = reader.Read<unsigned int>();
+		simpleCMT->Load_checkpoint(reader);
+		deduplicator->Load_checkpoint(reader);
+	}
+
 	inline void AddressMappingDomain::Update_mapping_info(const bool ideal_mapping, const stream_id_type stream_id, const LPA_type lpa, const PPA_type ppa, const page_status_type page_status_bitmap)
 	{
 		if (ideal_mapping) {
@@ -342,14 +403,50 @@ namespace SSD_Components
 		std::vector<std::vector<flash_channel_ID_type>> stream_channel_ids, std::vector<std::vector<flash_chip_ID_type>> stream_chip_ids,
 		std::vector<std::vector<flash_die_ID_type>> stream_die_ids, std::vector<std::vector<flash_plane_ID_type>> stream_plane_ids,
 		unsigned int Block_no_per_plane, unsigned int Page_no_per_block, unsigned int SectorsPerPage, unsigned int PageSizeInByte,
-		double Overprovisioning_ratio, CMT_Sharing_Mode sharing_mode, bool fold_large_addresses)
+		double Overprovisioning_ratio, std::vector<std::string> stream_fingerprint_file_paths,
+		unsigned int fp_cache_capacity_in_byte, FP_Cache_Replacement_Policy fp_cache_replacement_policy,
+		unsigned int fp_filter_size_in_byte, unsigned int fp_filter_hash_no, sim_time_type fp_filter_probe_time,
+		unsigned int smt_cache_capacity_in_byte, SMT_Cache_Replacement_Policy smt_cache_replacement_policy,
+		unsigned int dedup_sampling_unit, Dedup_Sampling_Rule dedup_sampling_rule, bool dedup_prehash_enabled, Dedup_Mode dedup_mode,
+		unsigned int dedup_chunk_size_in_byte, bool compression_enabled, bool dedup_verify_enabled, bool global_dedup_enabled, bool gc_dedup_enabled, sim_time_type dedup_logging_period, CMT_Sharing_Mode sharing_mode, bool fold_large_addresses)
 		: Address_Mapping_Unit_Base(id, ftl, flash_controller, block_manager, ideal_mapping_table,
 			concurrent_stream_no, channel_count, chip_no_per_channel, die_no_per_chip, plane_no_per_die,
-			Block_no_per_plane, Page_no_per_block, SectorsPerPage, PageSizeInByte, Overprovisioning_ratio, sharing_mode, fold_large_addresses)
+			Block_no_per_plane, Page_no_per_block, SectorsPerPage, PageSizeInByte, Overprovisioning_ratio, sharing_mode, fold_large_addresses),
+		dedup_logging_period(dedup_logging_period), next_dedup_logging_milestone(dedup_logging_period)
 	{
 		_my_instance = this;
 		domains = new AddressMappingDomain*[no_of_input_streams];
 
+		//** Append for CAFTL: sub-page chunks are deduplicated inline, one fingerprint per chunk
+		bool chunk_dedup = dedup_chunk_size_in_byte > 0 && dedup_chunk_size_in_byte < PageSizeInByte;
+		if (dedup_chunk_size_in_byte > 0) {
+			if (dedup_chunk_size_in_byte % SECTOR_SIZE_IN_BYTE != 0 || PageSizeInByte % dedup_chunk_size_in_byte != 0)
+				PRINT_ERROR("Dedup_Chunk_Size should be a multiple of " << SECTOR_SIZE_IN_BYTE << " bytes that divides the flash page size!")
+			if (chunk_dedup && (dedup_mode != Dedup_Mode::INLINE || dedup_sampling_unit > 1 || dedup_prehash_enabled || fp_cache_capacity_in_byte > 0))
+				PRINT_ERROR("Sub-page chunk dedup requires INLINE Dedup_Mode, without sampling, pre-hashing or a bounded fingerprint cache!")
+		}
+		//Compressed chunks are packed by the chunk store, a whole page being a single chunk without Dedup_Chunk_Size
+		if (compression_enabled && (dedup_mode != Dedup_Mode::INLINE || dedup_sampling_unit > 1 || dedup_prehash_enabled || fp_cache_capacity_in_byte > 0))
+			PRINT_ERROR("Compression requires INLINE Dedup_Mode, without sampling, pre-hashing or a bounded fingerprint cache!")
+		unsigned int chunk_size_in_byte = chunk_dedup ? dedup_chunk_size_in_byte : PageSizeInByte;
+		//** Append for CAFTL: the fingerprint filter is equally partitioned among concurrent streams
+		if (fp_filter_size_in_byte > 0) {
+			if (dedup_mode != Dedup_Mode::INLINE)
+				PRINT_ERROR("The fingerprint filter requires INLINE Dedup_Mode!")
+			if (fp_filter_size_in_byte / no_of_input_streams == 0 || fp_filter_hash_no == 0)
+				PRINT_ERROR("FP_Filter_Size should give each I/O flow at least one byte, and FP_Filter_Hash_No should be positive!")
+		}
+		//** Append for CAFTL: a duplicate is verified against the flash page of the chunk it matched
+		if (dedup_verify_enabled && (dedup_mode != Dedup_Mode::INLINE || chunk_dedup || compression_enabled))
+			PRINT_ERROR("Dedup verification requires INLINE Dedup_Mode and whole page dedup, without Dedup_Chunk_Size or compression!")
+		//** Append for CAFTL: the streams of a global dedup domain share a fingerprint index and an SMT that are entirely kept in DRAM
+		if (global_dedup_enabled && (dedup_mode != Dedup_Mode::INLINE || chunk_dedup || compression_enabled || dedup_sampling_unit > 1 || dedup_prehash_enabled
+			|| fp_cache_capacity_in_byte > 0 || smt_cache_capacity_in_byte > 0))
+			PRINT_ERROR("A global dedup domain requires INLINE Dedup_Mode and whole page dedup, without sampling, pre-hashing, Dedup_Chunk_Size, compression, FP_Cache_Capacity or SMT_Cache_Capacity!")
+		//** Append for CAFTL: GC dedup works on whole pages, a packed chunk page is repacked by GC instead
+		if (gc_dedup_enabled && (chunk_dedup || compression_enabled))
+			PRINT_ERROR("GC dedup requires whole page dedup, without Dedup_Chunk_Size or compression!")
+
 		Write_transactions_for_overfull_planes = new std::set<NVM_Transaction_Flash_WR*>***[channel_count];
 		for (unsigned int channel_id = 0; channel_id < channel_count; channel_id++) {
 			Write_transactions_for_overfull_planes[channel_id] = new std::set<NVM_Transaction_Flash_WR*>**[chip_no_per_channel];
@@ -374,6 +471,18 @@ namespace SSD_Components
 			//In GTD we do not need to store lpa
 			GTD_entry_size = (unsigned int)std::ceil((std::log2(total_physical_pages_no) + sector_no_per_page) / 8);
 			no_of_translation_entries_per_page = (SectorsPerPage * SECTOR_SIZE_IN_BYTE) / GTD_entry_size;
+			//** Append for CAFTL: the fingerprint cache is equally partitioned among concurrent streams
+			FP_entry_size = FP_DIGEST_SIZE + (unsigned int)std::ceil(std::log2(total_physical_pages_no) / 8) + sizeof(uint32_t);
+			unsigned int per_stream_fp_cache_capacity = fp_cache_capacity_in_byte / FP_entry_size / no_of_input_streams;
+			if (fp_cache_capacity_in_byte > 0 && per_stream_fp_cache_capacity == 0) {
+				PRINT_ERROR("FP_Cache_Capacity is too small to hold one fingerprint per I/O flow!")
+			}
+			//** Append for CAFTL: so is the SMT cache
+			SMT_entry_size = (unsigned int)std::ceil(std::log2(total_physical_pages_no) / 8);
+			unsigned int per_stream_smt_cache_capacity = smt_cache_capacity_in_byte / SMT_entry_size / no_of_input_streams;
+			if (smt_cache_capacity_in_byte > 0 && per_stream_smt_cache_capacity == 0) {
+				PRINT_ERROR("SMT_Cache_Capacity is too small to hold one SMT entry per I/O flow!")
+			}
 
 			Cached_Mapping_Table* sharedCMT = NULL;
 			unsigned int per_stream_cmt_capacity = 0;
@@ -432,7 +541,25 @@ namespace SSD_Components
 				channel_ids, (unsigned int)(stream_channel_ids[domainID].size()), chip_ids, (unsigned int)(stream_chip_ids[domainID].size()), die_ids, 
 				(unsigned int)(stream_die_ids[domainID].size()), plane_ids, (unsigned int)(stream_plane_ids[domainID].size()),
 				Utils::Logical_Address_Partitioning_Unit::PDA_count_allocate_to_flow(domainID), Utils::Logical_Address_Partitioning_Unit::LHA_count_allocate_to_flow_from_device_view(domainID),
-				sector_no_per_page);
+				sector_no_per_page, domainID < stream_fingerprint_file_paths.size() ? stream_fingerprint_file_paths[domainID] : "",
+				per_stream_fp_cache_capacity, fp_cache_replacement_policy, dedup_sampling_unit, dedup_sampling_rule, dedup_prehash_enabled, dedup_mode,
+				(SectorsPerPage * SECTOR_SIZE_IN_BYTE) / FP_entry_size, per_stream_smt_cache_capacity, smt_cache_replacement_policy,
+				(SectorsPerPage * SECTOR_SIZE_IN_BYTE) / SMT_entry_size);
+			if (chunk_dedup || compression_enabled) {
+				domains[domainID]->deduplicator->Chunks = new Chunk_Store(domains[domainID]->Total_logical_pages_no, total_physical_pages_no,
+					PageSizeInByte / chunk_size_in_byte, chunk_size_in_byte / SECTOR_SIZE_IN_BYTE, channel_count * chip_no_per_channel * die_no_per_chip * plane_no_per_die,
+					compression_enabled);
+			}
+			if (fp_filter_size_in_byte > 0 && !global_dedup_enabled) {
+				domains[domainID]->deduplicator->Filter = new Fingerprint_Filter(fp_filter_size_in_byte / no_of_input_streams, fp_filter_hash_no, fp_filter_probe_time);
+			} else if (fp_filter_size_in_byte > 0 && domainID == 0) {//A global dedup domain has a single fingerprint index, so a single filter
+				domains[domainID]->deduplicator->Filter = new Fingerprint_Filter(fp_filter_size_in_byte, fp_filter_hash_no, fp_filter_probe_time);
+			}
+			if (global_dedup_enabled) {
+				domains[domainID]->deduplicator->Join_global_domain(domains[0]->deduplicator, domainID);
+			}
+			domains[domainID]->deduplicator->Verify_enabled = dedup_verify_enabled;
+			domains[domainID]->deduplicator->GC_dedup_enabled = gc_dedup_enabled;
 			delete[] channel_ids;
 			delete[] chip_ids;
 			delete[] die_ids;
@@ -447,7 +574,19 @@ namespace SSD_Components
 	}
 
 	Address_Mapping_Unit_Page_Level::~Address_Mapping_Unit_Page_Level()
-	{		
+	{
+		//** Append for CAFTL: the sharing of a global dedup domain is summarized first, since the loop below deletes the domains
+		bool global_dedup = domains[0]->deduplicator->In_global_domain();
+		size_t stored_chunk_no = 0, shared_chunk_no = 0, excess_copy_no = 0, all_chunk_write_no = 0, all_cross_stream_dup_no = 0;
+		if (global_dedup) {
+			stored_chunk_no = domains[0]->deduplicator->Get_FPtable_size();
+			domains[0]->deduplicator->Get_cross_stream_sharing(shared_chunk_no, excess_copy_no);
+			for (unsigned int i = 0; i < no_of_input_streams; i++) {
+				all_chunk_write_no += domains[i]->deduplicator->Total_chunk_no;
+				all_cross_stream_dup_no += domains[i]->deduplicator->Cross_stream_dup_no;
+			}
+		}
+
 		for (unsigned int i = 0; i < no_of_input_streams; i++) {
 			PRINT_MESSAGE("\n============== Dedup Output: =======================");
 			PRINT_MESSAGE("* Setting:");
@@ -464,15 +603,29 @@ namespace SSD_Components
 			PRINT_MESSAGE(" - Write no in chunks (after dedup): " << domains[i]->deduplicator->Total_chunk_no - domains[i]->deduplicator->Dup_chunk_no);
 			PRINT_MESSAGE(" - Stats: Issued_Flash_Program_CMD (Excluding RBW): " << Stats::IssuedProgramCMD);
 			PRINT_MESSAGE(" - Dedup Rate: " << domains[i]->deduplicator->Get_DedupRate() * 100.0 << "%");
+			if (global_dedup)
+				PRINT_MESSAGE(" - Cross-stream duplicates #: " << domains[i]->deduplicator->Cross_stream_dup_no << " (chunks that no page of this stream referenced)");
+			if (domains[i]->deduplicator->Verify_read_no > 0)
+				PRINT_MESSAGE(" - Verify reads #: " << domains[i]->deduplicator->Verify_read_no << ", added write latency per duplicate (us): "
+					<< double(domains[i]->deduplicator->Verify_time) / domains[i]->deduplicator->Verify_read_no / SIM_TIME_TO_MICROSECONDS_COEFF);
+			if (domains[i]->deduplicator->Trim_page_no > 0)
+				PRINT_MESSAGE(" - TRIM: pages #: " << domains[i]->deduplicator->Trim_page_no << ", dropped references #: " << domains[i]->deduplicator->Trim_released_no
+					<< ", freed #: " << domains[i]->deduplicator->Trim_freed_no);
 			
 			PRINT_MESSAGE("\n* GC:");
 			PRINT_MESSAGE("Stats: Total gc executions (from STATs): " << Stats::Total_gc_executions);
 			PRINT_MESSAGE("Stats: GC page write: " << Stats::Total_page_movements_for_gc);
+			PRINT_MESSAGE("GC page moves: " << domains[i]->deduplicator->GC_page_write_no << ", moves of shared chunks (with SMT update): " << domains[i]->deduplicator->GC_shared_page_write_no);
+			if (domains[i]->deduplicator->GC_dedup_enabled)
+				PRINT_MESSAGE("GC dedup: pages fingerprinted #: " << domains[i]->deduplicator->GC_hash_no << ", duplicates merged #: " << domains[i]->deduplicator->GC_merge_no
+					<< ", skipped pages still unfingerprinted #: " << domains[i]->deduplicator->Get_skipped_chunk_no());
 			//PRINT_MESSAGE("Total page movements for gc (from STATs): " << Stats::Total_page_movements_for_gc);
 			
 			PRINT_MESSAGE("\n* Page I/O with GC:");
-			PRINT_MESSAGE("Total pages write num (including GC write): " << domains[i]->deduplicator->Total_chunk_no + domains[i]->GC_page_write_no);
-			PRINT_MESSAGE("Actual pages write num (including GC write): " << domains[i]->deduplicator->Total_chunk_no - domains[i]->deduplicator->Dup_chunk_no + domains[i]->GC_page_write_no);
+			PRINT_MESSAGE("Total pages write num (including GC write): " << domains[i]->deduplicator->Total_chunk_no + domains[i]->deduplicator->GC_page_write_no);
+			PRINT_MESSAGE("Actual pages write num (including GC write): " << domains[i]->deduplicator->Total_chunk_no - domains[i]->deduplicator->Dup_chunk_no + domains[i]->deduplicator->GC_page_write_no);
+			if (domains[i]->deduplicator->Total_chunk_no > 0 && domains[i]->deduplicator->Chunks == NULL)
+				PRINT_MESSAGE("WAF (flash page writes per host page write): " << double(domains[i]->deduplicator->Total_chunk_no - domains[i]->deduplicator->Dup_chunk_no + domains[i]->deduplicator->GC_page_write_no) / domains[i]->deduplicator->Total_chunk_no);
 			
 			PRINT_MESSAGE("\n* I/O Performance:");
 			PRINT_MESSAGE("Done page FP #: " << domains[i]->deduplicator->Total_chunk_no);
@@ -482,15 +635,103 @@ namespace SSD_Components
 			
 			PRINT_MESSAGE("\n* Cache Mapping:");
 			PRINT_MESSAGE("Simple CMT write triggers #: " << domains[i]->simpleCMT->GMT_write_count);
-			domains[i]->DedupOutputFile.open("C:\\Users\\Ron\\Desktop\\DedupOutput\\CAFTL_output.csv", std::ios::out | std::ios::app);
-			domains[i]->DedupOutputFile << "Flash space" << "," << "page size" << "," << "DedupRate" << "," << "Total_write#" << "," << "GMT_write#" << "," << "Total_read#" << "," << "rbw#" << "," << "update read #" << "," << "ssdTrace" << "," << "Linux" << "," << std::endl;
-			domains[i]->DedupOutputFile << std::to_string(float((page_size_in_byte / 1024.0) * total_physical_pages_no / 1024.0 / 1024.0)) + "GB" << "," << std::to_string(page_size_in_byte) << "," << std::to_string(domains[i]->deduplicator->Get_DedupRate() * 100.0) + "%" << "," << Stats::IssuedProgramCMD << "," << domains[i]->simpleCMT->GMT_write_count << "," << Stats::IssuedReadCMD << "," << read_before_write << "," << update_read << std::endl;
-			
+			PRINT_MESSAGE("Reverse mapping entries #: " << block_manager->page_metadata_no[i] << ", invalid #: " << block_manager->invalid_page_metadata_no[i]);
+
+			Fingerprint_Cache* fp_cache = domains[i]->deduplicator->FPcache;
+			if (fp_cache != NULL) {
+				PRINT_MESSAGE("\n* Fingerprint Store:");
+				PRINT_MESSAGE("FP cache capacity (entries): " << fp_cache->Get_capacity() << ", buckets on flash: " << fp_cache->Get_bucket_no());
+				PRINT_MESSAGE("FP cache hits #: " << fp_cache->Hits << ", misses #: " << fp_cache->Misses);
+				PRINT_MESSAGE("FP cache hit rate: " << fp_cache->Get_hit_rate() * 100.0 << "%");
+				PRINT_MESSAGE("FP bucket flash reads #: " << domains[i]->deduplicator->FP_bucket_reads);
+				PRINT_MESSAGE("FP bucket flash writes #: " << domains[i]->deduplicator->FP_bucket_writes);
+			}
+			Fingerprint_Filter* fp_filter = domains[i]->deduplicator->Filter;
+			if (fp_filter != NULL) {
+				PRINT_MESSAGE("\n* Fingerprint Filter:");
+				PRINT_MESSAGE("Filter size (bytes): " << fp_filter->Get_size_in_byte() << ", bits per stored FP: "
+					<< (domains[i]->deduplicator->Get_FPtable_size() == 0 ? 0 : fp_filter->Get_size_in_byte() * 8.0 / domains[i]->deduplicator->Get_FPtable_size()));
+				PRINT_MESSAGE("Hash functions #: " << fp_filter->Get_hash_no() << ", lookup time (ns): " << fp_filter->Get_lookup_time());
+				PRINT_MESSAGE("Filter lookups #: " << fp_filter->Lookup_no << ", negatives #: " << fp_filter->Negative_no << ", false positives #: " << fp_filter->False_positive_no);
+				PRINT_MESSAGE("False positive rate: " << fp_filter->Get_false_positive_rate() * 100.0 << "% (expected: " << fp_filter->Get_expected_false_positive_rate() * 100.0 << "%)");
+				PRINT_MESSAGE("FP bucket flash reads avoided #: " << domains[i]->deduplicator->FP_bucket_reads_filtered);
+			}
+			SMT_Cache* smt_cache = domains[i]->deduplicator->SMTcache;
+			if (smt_cache != NULL) {
+				PRINT_MESSAGE("\n* SMT Cache:");
+				PRINT_MESSAGE("SMT cache capacity (entries): " << smt_cache->Get_capacity() << ", SMT pages on flash: " << smt_cache->Get_page_no());
+				PRINT_MESSAGE("SMT cache hits #: " << smt_cache->Hits << ", misses #: " << smt_cache->Misses);
+				PRINT_MESSAGE("SMT cache hit rate: " << smt_cache->Get_hit_rate() * 100.0 << "%");
+				PRINT_MESSAGE("SMT page flash reads #: " << Stats::Total_flash_reads_for_SMT_per_stream[i]);
+				PRINT_MESSAGE("SMT page flash writes #: " << Stats::Total_flash_writes_for_SMT_per_stream[i]);
+			}
+			Dedup_Sampler* sampler = domains[i]->deduplicator->Sampler;
+			if (sampler != NULL && sampler->Page_no > 0) {
+				PRINT_MESSAGE("\n* Fingerprint Sampling:");
+				PRINT_MESSAGE("Sampling unit (pages): " << sampler->Get_unit_size() << ", rule: " << (sampler->Get_rule() == Dedup_Sampling_Rule::CONTENT ? "CONTENT" : "FIRST")
+					<< ", pre-hashing: " << (sampler->Is_prehash_enabled() ? "on" : "off"));
+				PRINT_MESSAGE("Full hashes #: " << sampler->Full_hash_no << " (deferred: " << sampler->Deferred_hash_no << "), weak hashes #: " << sampler->Weak_hash_no);
+				PRINT_MESSAGE("Pages written without fingerprint #: " << sampler->Skipped_page_no << ", known duplicates among them #: " << sampler->Missed_dup_no);
+				PRINT_MESSAGE("Full hash work saved: " << (1.0 - double(sampler->Full_hash_no) / sampler->Page_no) * 100.0 << "%");
+				PRINT_MESSAGE("Dedup rate lost on known duplicates: " << (domains[i]->deduplicator->Total_chunk_no == 0 ? 0 : double(sampler->Missed_dup_no) / domains[i]->deduplicator->Total_chunk_no * 100.0) << "%");
+			}
+			Deduplicator* deduplicator = domains[i]->deduplicator;
+			Content_Generator* content = deduplicator->Content;
+			if (content != NULL) {
+				PRINT_MESSAGE("\n* Synthetic Content:");
+				PRINT_MESSAGE("Target duplicate ratio: " << content->Get_duplicate_ratio() * 100.0 << "%, content universe: " << content->Get_universe_size()
+					<< ", popularity: " << (content->Get_popularity() == Utils::Content_Popularity_Type::ZIPF ? "ZIPF" : "UNIFORM"));
+				PRINT_MESSAGE("Generated contents #: " << content->Generated_no << ", duplicates among them #: " << content->Duplicate_no);
+				if (content->Get_compressed_percentage() < 100)
+					PRINT_MESSAGE("Mean compressed size: " << content->Get_compressed_percentage() << "% of a chunk");
+			}
+			if (deduplicator->Mode == Dedup_Mode::OUT_OF_LINE) {
+				PRINT_MESSAGE("\n* Out-of-line Dedup:");
+				PRINT_MESSAGE("Background reads #: " << deduplicator->Background_read_no << ", chunks fingerprinted during GC #: " << deduplicator->GC_piggyback_no);
+				PRINT_MESSAGE("Merged duplicates #: " << deduplicator->Background_merge_no << ", overwritten before dedup #: " << deduplicator->Dropped_pending_no);
+				PRINT_MESSAGE("Chunks still pending #: " << deduplicator->Get_pending_chunk_no());
+			}
+			Chunk_Store* chunks = deduplicator->Chunks;
+			if (chunks != NULL) {
+				PRINT_MESSAGE("\n* Chunk Dedup:");
+				PRINT_MESSAGE("Chunk size (bytes): " << chunks->Get_sectors_per_chunk() * SECTOR_SIZE_IN_BYTE << ", chunks per page: " << chunks->Get_chunks_per_page());
+				PRINT_MESSAGE("Stored chunks #: " << chunks->Get_chunk_no() << ", waiting in packing buffers #: " << chunks->Get_buffered_chunk_no());
+				PRINT_MESSAGE("Chunk page programs #: " << deduplicator->Chunk_page_program_no);
+				PRINT_MESSAGE("Partially written chunks #: " << deduplicator->Partial_chunk_write_no << ", merge reads #: " << deduplicator->Chunk_merge_read_no);
+				PRINT_MESSAGE("Fragment reads #: " << deduplicator->Fragment_read_no << ", chunk reads from packing buffers #: " << deduplicator->Buffered_chunk_read_no);
+				if (deduplicator->Total_chunk_no > 0)
+					PRINT_MESSAGE("WAF (flash chunk writes per host chunk write): " << double(deduplicator->Chunk_page_program_no + deduplicator->GC_page_write_no) * chunks->Get_chunks_per_page() / deduplicator->Total_chunk_no);
+			}
+			if (chunks != NULL && chunks->Is_compressed()) {
+				PRINT_MESSAGE("\n* Compression:");
+				PRINT_MESSAGE("Sectors of unique chunks #: " << deduplicator->Unique_chunk_sector_no << ", stored after compression #: " << deduplicator->Compressed_chunk_sector_no);
+				PRINT_MESSAGE("Write saving from dedup: " << (deduplicator->Total_chunk_no == 0 ? 0 : double(deduplicator->Dup_chunk_no) / deduplicator->Total_chunk_no * 100.0) << "%, from compression: "
+					<< (deduplicator->Unique_chunk_sector_no == 0 ? 0 : (1.0 - double(deduplicator->Compressed_chunk_sector_no) / deduplicator->Unique_chunk_sector_no) * 100.0) << "%");
+				PRINT_MESSAGE("Pages compacted by GC #: " << deduplicator->GC_compacted_page_no << ", chunks repacked #: " << deduplicator->GC_compacted_chunk_no);
+				if (deduplicator->Total_chunk_no > 0)
+					PRINT_MESSAGE("WAF (flash sector writes per host sector write): " << double(deduplicator->Chunk_page_program_no + deduplicator->GC_page_write_no) * sector_no_per_page
+						/ (double(deduplicator->Total_chunk_no) * chunks->Get_sectors_per_chunk()));
+			}
+			if (deduplicator->Batch_no > 0) {
+				PRINT_MESSAGE("\n* Batched Lookups:");
+				PRINT_MESSAGE("Batches #: " << deduplicator->Batch_no << ", average writes per batch: " << double(deduplicator->Batch_write_no) / deduplicator->Batch_no);
+				PRINT_MESSAGE("Duplicates inside a batch #: " << deduplicator->Batch_dup_no);
+			}
+
 			//std::cout << "GC partial pages write: " << domains[i]->GC_Partial_write_page_no << std::endl;
 			//domains[i]->Print_Mappings_Detail();
  			delete domains[i];
 		}
 		delete[] domains;
+
+		if (global_dedup) {
+			PRINT_MESSAGE("\n============== Global Dedup Domain: ================");
+			PRINT_MESSAGE("Streams #: " << no_of_input_streams << ", stored chunks #: " << stored_chunk_no);
+			PRINT_MESSAGE("Chunks shared across streams #: " << shared_chunk_no << ", copies that one domain per stream would add #: " << excess_copy_no
+				<< " (GB: " << float((page_size_in_byte / 1024.0) * excess_copy_no / 1024.0 / 1024.0) << ")");
+			PRINT_MESSAGE("Cross-stream duplicates #: " << all_cross_stream_dup_no << ", share of chunk writes: "
+				<< (all_chunk_write_no == 0 ? 0 : double(all_cross_stream_dup_no) / all_chunk_write_no * 100.0) << "%");
+		}
 		
 	}
 
@@ -498,6 +739,7 @@ namespace SSD_Components
 	{
 		Sim_Object::Setup_triggers();
 		flash_controller->ConnectToTransactionServicedSignal(handle_transaction_serviced_signal_from_PHY);
+		flash_controller->ConnectToPageLPAQuery(handle_page_lpa_query_from_PHY);//** Append for CAFTL
 	}
 
 	void Address_Mapping_Unit_Page_Level::Start_simulation()
@@ -511,6 +753,53 @@ namespace SSD_Components
 
 	void Address_Mapping_Unit_Page_Level::Execute_simulator_event(MQSimEngine::Sim_Event* event)
 	{
+		//** Append for CAFTL
+		switch ((Address_Mapping_Event_Type)event->Type) {
+			case Address_Mapping_Event_Type::DUPLICATE_WRITE_SERVICED:
+				flash_controller->Complete_without_flash_access((NVM_Transaction_Flash*)event->Parameters);
+				break;
+			case Address_Mapping_Event_Type::GC_LPA_RELEASED:
+			{
+				std::pair<stream_id_type, LPA_type>* released_lpa = (std::pair<stream_id_type, LPA_type>*)event->Parameters;
+				Remove_barrier_for_accessing_lpa(released_lpa->first, released_lpa->second);
+				delete released_lpa;
+				break;
+			}
+		}
+	}
+
+	/*
+	* A duplicate write (or a chunk write that only fills a packing buffer) is never submitted to the TSU, so the
+	* flash controller would never report it serviced and the data cache would never release its back-pressure
+	* slot. It is reported serviced in a separate event, once the current dispatch has finished.
+	*/
+	void Address_Mapping_Unit_Page_Level::complete_duplicate_write(NVM_Transaction_Flash_WR* transaction)
+	{
+		if (transaction->Verify_PPA != NO_PPA) {
+			issue_verify_read(transaction);
+			return;
+		}
+		Simulator->Register_sim_event(Simulator->Time(), this, transaction, (int)Address_Mapping_Event_Type::DUPLICATE_WRITE_SERVICED);
+	}
+
+	/*
+	* With dedup verification, a fingerprint match is only trusted once the matched page has been read and compared
+	* with the written data. The mapping is already updated, since the simulated fingerprints never collide; the
+	* write is reported serviced when its verify read returns, so the read time adds to the write latency.
+	*/
+	void Address_Mapping_Unit_Page_Level::issue_verify_read(NVM_Transaction_Flash_WR* transaction)
+	{
+		PPA_type ppa = transaction->Verify_PPA;
+		transaction->Verify_PPA = NO_PPA;
+		NVM_Transaction_Flash_RD* readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, transaction->Stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+			transaction->LPA, ppa, NULL, 0, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+		Convert_ppa_to_address(ppa, readTR->Address);
+		block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+		domains[transaction->Stream_id]->Verify_reads[readTR] = transaction;
+		domains[transaction->Stream_id]->deduplicator->Verify_read_no++;
+		ftl->TSU->Prepare_for_transaction_submit();
+		ftl->TSU->Submit_transaction(readTR);
+		ftl->TSU->Schedule();
 	}
 
 	void Address_Mapping_Unit_Page_Level::Store_mapping_table_on_flash_at_start()
@@ -534,6 +823,44 @@ namespace SSD_Components
 		mapping_table_stored_on_flash = true;
 	}
 
+	/*
+	* Saves the state that preconditioning builds, plus every CAFTL table. Transactions that wait for
+	* mapping or fingerprint pages cannot be saved, so a checkpoint is only taken while the device is idle.
+	*/
+	void Address_Mapping_Unit_Page_Level::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Begin_section("AMUP");
+		writer.Write(no_of_input_streams);
+		writer.Write(ideal_mapping_table);
+		writer.Write(mapping_table_stored_on_flash);
+		for (unsigned int stream_id = 0; stream_id < no_of_input_streams; stream_id++) {
+			AddressMappingDomain* domain = domains[stream_id];
+			if (domain->Waiting_unmapped_read_transactions.size() > 0 || domain->Waiting_unmapped_program_transactions.size() > 0
+				|| domain->Waiting_fingerprint_lookup_transactions.size() > 0 || domain->Waiting_SMT_lookup_transactions.size() > 0
+				|| domain->Locked_LPAs.size() > 0 || domain->Locked_MVPNs.size() > 0)
+				PRINT_ERROR("A checkpoint cannot be taken while the address mapping unit has transactions in flight!")
+			domain->Save_checkpoint(writer);
+			bool shared_cmt = stream_id > 0 && domain->CMT == domains[0]->CMT;//A shared CMT is saved with the first domain
+			writer.Write(shared_cmt);
+			if (!shared_cmt)
+				domain->CMT->Save_checkpoint(writer);
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Begin_section("AMUP");
+		reader.Expect(no_of_input_streams, "the number of I/O flows");
+		reader.Expect(ideal_mapping_table, "Ideal_Mapping_Table");
+		mapping_table_stored_on_flash = reader.Read<bool>();
+		for (unsigned int stream_id = 0; stream_id < no_of_input_streams; stream_id++) {
+			domains[stream_id]->Load_checkpoint(reader);
+			reader.Expect(stream_id > 0 && domains[stream_id]->CMT == domains[0]->CMT, "CMT_Sharing_Mode");
+			if (!(stream_id > 0 && domains[stream_id]->CMT == domains[0]->CMT))
+				domains[stream_id]->CMT->Load_checkpoint(reader);
+		}
+	}
+
 	int Address_Mapping_Unit_Page_Level::Bring_to_CMT_for_preconditioning(stream_id_type stream_id, LPA_type lpa)
 	{
 		if (domains[stream_id]->GlobalMappingTable[lpa].PPA == NO_PPA) {
@@ -572,11 +899,20 @@ namespace SSD_Components
 
 	void Address_Mapping_Unit_Page_Level::Translate_lpa_to_ppa_and_dispatch(const std::list<NVM_Transaction*>& transactionList)
 	{
+		if (dedup_logging_period > 0 && Simulator->Time() > next_dedup_logging_milestone) {//** Append for CAFTL
+			log_dedup_epoch();
+			next_dedup_logging_milestone = Simulator->Time() + dedup_logging_period;
+		}
+		prepare_dedup_batch(transactionList);//** Append for CAFTL
 		for (std::list<NVM_Transaction*>::const_iterator it = transactionList.begin();
 			it != transactionList.end(); ) {
 			if (is_lpa_locked_for_gc((*it)->Stream_id, ((NVM_Transaction_Flash*)(*it))->LPA)) {
 				//iterator should be post-incremented since the iterator may be deleted from list
 				manage_user_transaction_facing_barrier((NVM_Transaction_Flash*)*(it++));
+			} else if ((*it)->Type == Transaction_Type::WRITE && !fetch_fingerprint_for_write((NVM_Transaction_Flash_WR*)(*it))) {
+				it++;//** Append for CAFTL, the write waits for its fingerprint bucket to be read from flash
+			} else if ((*it)->Type == Transaction_Type::READ && !fetch_smt_entry_for_read((NVM_Transaction_Flash_RD*)(*it))) {
+				it++;//** Append for CAFTL, the read of a shared page waits for its SMT page to be read from flash
 			} else {
 				query_cmt((NVM_Transaction_Flash*)(*it++));	
 			}
@@ -586,8 +922,10 @@ namespace SSD_Components
 			ftl->TSU->Prepare_for_transaction_submit();
 			for (std::list<NVM_Transaction*>::const_iterator it = transactionList.begin();
 				it != transactionList.end(); it++) {
-				if (((NVM_Transaction_Flash_WR*)(*it))->dedup_wr == true)
+				if ((*it)->Type == Transaction_Type::WRITE && ((NVM_Transaction_Flash_WR*)(*it))->dedup_wr == true) {
+					complete_duplicate_write((NVM_Transaction_Flash_WR*)(*it));
 					continue;
+				}
 				if (((NVM_Transaction_Flash*)(*it))->Physical_address_determined) {
 					ftl->TSU->Submit_transaction(static_cast<NVM_Transaction_Flash*>(*it));
 					if (((NVM_Transaction_Flash*)(*it))->Type == Transaction_Type::WRITE) {
@@ -701,7 +1039,8 @@ namespace SSD_Components
 
 		if (ppa == NO_PPA) {
 			/* First time access */
-			if (transaction->Type == Transaction_Type::WRITE) {
+			/*A write that was postponed for an overfull plane (GC) is translated again, its slot already exists*/
+			if (transaction->Type == Transaction_Type::WRITE && !domain->simpleCMT->Exists(streamID, transaction->LPA)) {
 				/*If its a write, the entry will be marked as dirty later*/
 				/*For simplicity, we don't create a new entry for non-existed mapping (e.g., read before write)*/
 				domain->simpleCMT->Reserve_slot_for_lpn(streamID, transaction->LPA);
@@ -725,9 +1064,14 @@ namespace SSD_Components
 				read_before_write++;
 				ppa = online_create_entry_for_reads(transaction->LPA, streamID, transaction->Address, ((NVM_Transaction_Flash_RD*)transaction)->read_sectors_bitmap);
 			}
+			else if (ppa == CHUNK_MAPPED_PPA) {//** Append for CAFTL
+				ppa = translate_chunks_for_read(streamID, (NVM_Transaction_Flash_RD*)transaction);
+			}
 			else{
-				if (In_SMT(ppa)){
-					ppa = Get_SMTEntry(ppa).PPA;
+				if (domain->deduplicator->In_SMT(ppa)){
+					if (domain->deduplicator->SMTcache != NULL && !domain->deduplicator->SMTcache->Exists(ppa))//** Append for CAFTL: not fetched before the CMT lookup
+						access_smt_entry(streamID, ppa, false);
+					ppa = domain->deduplicator->Get_SMTEntry(ppa).PPA;
 				}
 			}
 			transaction->PPA = ppa;
@@ -736,6 +1080,10 @@ namespace SSD_Components
 			Total_read++;
 			transaction->Physical_address_determined = true;
 			return true;
+		} else if (((NVM_Transaction_Flash_WR*)transaction)->Trim) {//** Append for CAFTL: nothing is programmed, the write completes once the LPA is unmapped
+			deallocate_lpa((NVM_Transaction_Flash_WR*)transaction);
+			transaction->Physical_address_determined = true;
+			return true;
 		} else {//This is a write transaction	
 			allocate_plane_for_user_write((NVM_Transaction_Flash_WR*)transaction);
 			//there are too few free pages remaining only for GC
@@ -906,7 +1254,14 @@ namespace SSD_Components
 			allocate_page_in_plane_for_translation_write(transaction, (MVPN_type)transaction->LPA, true);
 			transaction->Physical_address_determined = true;
 		} else {
-			if (!domains[transaction->Stream_id]->Mapping_entry_accessible(ideal_mapping_table, transaction->Stream_id, transaction->LPA)) {
+			//** Append for CAFTL: a duplicate found by GC dedup is merged, there is nothing to program
+			if (domains[transaction->Stream_id]->deduplicator->GC_dedup_enabled && merge_duplicate_for_gc(transaction)) {
+				transaction->Physical_address_determined = true;
+				return;
+			}
+			//** Append for CAFTL: the LPAs of a shared page map to its VPA, so moving the page only changes its SMT entry
+			bool shared_page = Get_page_metadata(Convert_address_to_ppa(transaction->Address))->use_SMT;
+			if (!shared_page && !domains[transaction->Stream_id]->Mapping_entry_accessible(ideal_mapping_table, transaction->Stream_id, transaction->LPA)) {
 				if (!domains[transaction->Stream_id]->CMT->Check_free_slot_availability()) {
 					LPA_type evicted_lpa;
 					CMTSlotType evictedItem = domains[transaction->Stream_id]->CMT->Evict_one_slot(evicted_lpa);
@@ -930,6 +1285,9 @@ namespace SSD_Components
 
 			allocate_page_in_plane_for_user_write(transaction, true);
 			transaction->Physical_address_determined = true;
+			if (shared_page) {
+				return;
+			}
 
 			//the mapping entry should be updated
 			stream_id_type stream_id = transaction->Stream_id;
@@ -965,6 +1323,16 @@ namespace SSD_Components
 				domains[stream_id]->CMT->Reserve_slot_for_lpn(stream_id, transaction->LPA);
 				domains[stream_id]->CMT->Insert_new_mapping_info(stream_id, transaction->LPA, transaction->PPA, transaction->write_sectors_bitmap);
 			}
+
+			//** Append for CAFTL: the data of a moved page passes through the controller, so a pending chunk is fingerprinted on the way
+			if (domains[stream_id]->deduplicator->Mode == Dedup_Mode::OUT_OF_LINE) {
+				RMEntryType metadata;
+				Get_metadata_from_ReverseMapping(transaction->PPA, metadata);
+				FP_type fp;
+				if (domains[stream_id]->deduplicator->Get_pending_chunk(metadata.FP, fp) && merge_pending_chunk(stream_id, metadata.FP, true)) {
+					domains[stream_id]->deduplicator->GC_piggyback_no++;
+				}
+			}
 		}
 	}
 
@@ -1295,28 +1663,33 @@ namespace SSD_Components
 	void Address_Mapping_Unit_Page_Level::allocate_page_in_plane_for_user_write(NVM_Transaction_Flash_WR* transaction, bool is_for_gc)
 	{
 		transaction->dedup_wr = false;
+		transaction->Verify_PPA = NO_PPA;
 		AddressMappingDomain* domain = domains[transaction->Stream_id];
+		if (domain->deduplicator->Chunks != NULL) {//** Append for CAFTL: sub-page chunk dedup
+			if (is_for_gc)
+				move_chunk_page_for_gc(transaction);
+			else
+				allocate_chunks_for_user_write(transaction);
+			return;
+		}
 		PPA_type old_ppa = domain->Get_ppa(ideal_mapping_table, transaction->Stream_id, transaction->LPA);
 		//** Modified for CAFTL
 		//(1)hash table initialization (2)PPN->VPN (3)VPN-to-PPN mapping
 		bool PPA_invalid = false, use_SMT = false, get_new_FP = true;
 		page_status_type cur_bitmap = ((NVM_Transaction_Flash_WR*)transaction)->write_sectors_bitmap | domain->Get_page_status(ideal_mapping_table, transaction->Stream_id, transaction->LPA);
 		ChunkInfo cur_chunk;
-		std::pair<FP_type, ChunkInfo> FP_entry;
 		VPA_type VPA = NO_PPA;
 
 		if (is_for_gc) {//GC for CAFTL
-			if (In_SMT(old_ppa))
-				old_ppa = Get_SMTEntry(old_ppa).PPA;
-				
-			if (old_ppa == NO_PPA)
+			//The source page of the move, the LPA in its OOB area does not map to it anymore if the page is shared and that LPA has been remapped
+			old_ppa = Convert_address_to_ppa(transaction->Address);
+			OOBEntryType* source_page = Get_page_metadata(old_ppa);
+			if (source_page == NULL || !source_page->Has_metadata())
 				PRINT_ERROR("Unexpected mapping table status in allocate_page_in_plane_for_user_write function for a GC/WL write!")
 			else{
-				NVM::FlashMemory::Physical_Page_Address addr;
-				Convert_ppa_to_address(old_ppa, addr);
-				block_manager->Invalidate_page_in_block(transaction->Stream_id, addr);
+				block_manager->Invalidate_page_in_block(transaction->Stream_id, transaction->Address);
 				page_status_type page_status_in_cmt = domain->Get_page_status(ideal_mapping_table, transaction->Stream_id, transaction->LPA);
-				if (page_status_in_cmt != transaction->write_sectors_bitmap)
+				if (!source_page->use_SMT && page_status_in_cmt != transaction->write_sectors_bitmap)
 					PRINT_ERROR("Unexpected mapping table status in allocate_page_in_plane_for_user_write for a GC/WL write!")
 			}
 
@@ -1327,19 +1700,23 @@ namespace SSD_Components
 				PRINT_ERROR("ERROR: LPA in metadata doesn't match with transaction!")
 
 			/*Allocate a new address for GC*/
-			block_manager->Allocate_block_and_page_in_plane_for_gc_write(transaction->Stream_id, transaction->Address);
+			block_manager->Allocate_block_and_page_in_plane_for_gc_write(transaction->Stream_id, transaction->Address, metadata.use_SMT);
 			transaction->PPA = Convert_address_to_ppa(transaction->Address);
 			/*1. Update FP table*/
-			ChunkInfo moved_chunk = domain->deduplicator->GetChunkInfo(metadata.FP);
-			moved_chunk.PPA = transaction->PPA;
-			std::pair<FP_type, ChunkInfo> target_pair(metadata.FP, moved_chunk);
-			domain->deduplicator->Update_FPtable(target_pair);
+			ChunkInfo* moved_chunk = domain->deduplicator->Find_chunk(metadata.FP);
+			if (moved_chunk == NULL)
+				PRINT_ERROR("This chunk is not in Fingerprint Table")
+			moved_chunk->PPA = transaction->PPA;
+			update_block_reference_stats(old_ppa, -(int)moved_chunk->ref, metadata.use_SMT ? -1 : 0);
+			update_block_reference_stats(transaction->PPA, (int)moved_chunk->ref, metadata.use_SMT ? 1 : 0);
+			if (metadata.use_SMT)
+				domain->deduplicator->GC_shared_page_write_no++;
+			update_fingerprint_in_cache(transaction->Stream_id, metadata.FP);
 
 			/*2. Update mapping*/
 			if (metadata.use_SMT) {//if use_SMT == true, update ppa in SMT
-				SMTEntryType cur_SMTEntry = { transaction->PPA };//new ppa
-				std::pair<VPA_type, SMTEntryType> cur_SMT_pair(metadata.VPA, cur_SMTEntry);
-				Update_SMT(cur_SMT_pair);
+				domain->deduplicator->Update_SMT(metadata.VPA, transaction->PPA);//new ppa
+				access_smt_entry(transaction->Stream_id, metadata.VPA, true);
 			}
 			else {//else update PMT
 				domain->Update_mapping_info(ideal_mapping_table, transaction->Stream_id, transaction->LPA, transaction->PPA,cur_bitmap);
@@ -1350,37 +1727,25 @@ namespace SSD_Components
 			std::pair<PPA_type, RMEntryType> cur_RMEntry(transaction->PPA, RMEntry);
 			Update_ReverseMapping(cur_RMEntry);
 			//domain->Delete_ReverseMapping(old_ppa);
-			domain->GC_page_write_no++;
+			domain->deduplicator->GC_page_write_no++;
 		}
 		else {//Its full page write and not GC
 			//bool no_invalid = false;
 			if (old_ppa != NO_PPA) {
-				if (In_SMT(old_ppa))//If this ppa is converted into vpa already
-					old_ppa = Get_SMTEntry(old_ppa).PPA;//fetch ppa but not vpa
-				FP_type old_fp = ReverseMapping[old_ppa].FP;//Get its fingerprint by RM
-				if (!domain->deduplicator->In_FPtable(old_fp))//Avoid invalidating the invalid page, since when ref == 0, this fp entry will be erased.
+				bool page_freed;
+				if (!release_page_reference(transaction->Stream_id, old_ppa, page_freed))//Avoid invalidating the invalid page, since when ref == 0, this fp entry will be erased.
 					return;
-				ChunkInfo old_chunk = domain->deduplicator->GetChunkInfo(old_fp);//For updation of old_fp info in FPtable  
-				old_chunk.ref -= 1;//Assume this LPA will ref to another PPA
-				std::pair<FP_type, ChunkInfo> target_pair(old_fp, old_chunk);//Create FP pair to update FPtable
-				domain->deduplicator->Update_FPtable(target_pair);//Update old fp ref, if the ref == 0 after updation this fp entry will be erased
 
-				if (old_chunk.ref == 0)//Should this PPA got invalid? If it gots multiple LPA ref this PPA, this PPA should not be invalid
+				if (page_freed)//Should this PPA got invalid? If it gots multiple LPA ref this PPA, this PPA should not be invalid
 				{
 					page_status_type prev_page_status = domain->Get_page_status(ideal_mapping_table, transaction->Stream_id, transaction->LPA);
 					page_status_type status_intersection = transaction->write_sectors_bitmap & prev_page_status;
 
-					RMEntryType metadata;
-					Get_metadata_from_ReverseMapping(old_ppa, metadata);
-					RMEntryType RMEntry = { metadata.FP, metadata.LPA, metadata.VPA, metadata.use_SMT, true };
-					std::pair<PPA_type, RMEntryType> cur_RMEntry(old_ppa, RMEntry);
-
 					//check if an update read is required
 					if (status_intersection == prev_page_status) {
 						NVM::FlashMemory::Physical_Page_Address addr;
 						Convert_ppa_to_address(old_ppa, addr);
-						Update_ReverseMapping(cur_RMEntry);
-						block_manager->Invalidate_page_in_block(transaction->Stream_id, addr);
+						invalidate_released_page(addr);
 					}
 					else {
 						page_status_type read_pages_bitmap = status_intersection ^ prev_page_status;
@@ -1388,56 +1753,87 @@ namespace SSD_Components
 							count_sector_no_from_status_bitmap(read_pages_bitmap) * SECTOR_SIZE_IN_BYTE, transaction->LPA, old_ppa, transaction->UserIORequest,
 							transaction->Content, transaction, read_pages_bitmap, domain->GlobalMappingTable[transaction->LPA].TimeStamp);
 						Convert_ppa_to_address(old_ppa, update_read_tr->Address);
-						Update_ReverseMapping(cur_RMEntry);
 						block_manager->Read_transaction_issued(update_read_tr->Address);//Inform block manager about a new transaction as soon as the transaction's target address is determined
 						update_read++;
-						block_manager->Invalidate_page_in_block(transaction->Stream_id, update_read_tr->Address);
+						invalidate_released_page(update_read_tr->Address);
 						transaction->RelatedRead = update_read_tr;
 					}
 				}
 			}
 
-			if (std::getline(domain->fp_input_file, domain->cur_fp)) {//Make sure that fingerprints are sufficient for full page write trace
-				if (!domain->fp_input_file.is_open()){
-					PRINT_ERROR("Fail to open fingerprint input!");
+			bool fp_available = transaction->FP_available;
+			if (fp_available)//The fingerprint came inline with the trace record
+				domain->deduplicator->cur_fp = transaction->FP;
+			else {
+				if (!domain->deduplicator->Has_fingerprint_feed()) {
+					PRINT_ERROR("No fingerprint for LPA " << transaction->LPA << ": the trace line has none, no Fingerprint_File_Path is set and the flow has no Content_Popularity!");
 					return;
 				}
+				fp_available = domain->deduplicator->Next_fingerprint(domain->deduplicator->cur_fp);
+			}
+			if (fp_available) {//Make sure that fingerprints are sufficient for full page write trace
 				//std::cout << "\n------------------------------ Read trace line no: " << domain->Write_with_fp_no << " ------------------------------\nLPA: " << transaction->LPA << ", old PPA: " << old_ppa << ", FP: " << domain->cur_fp << std::endl;
-				/* Dedup current FP */
-				if (!domain->deduplicator->In_FPtable(domain->cur_fp)) {//First time insertion
+				/* Out-of-line dedup: the page is stored as a unique chunk now and fingerprinted in the background */
+				if (domain->deduplicator->Mode == Dedup_Mode::OUT_OF_LINE) {
+					FP_type placeholder;
+					domain->deduplicator->Make_placeholder(placeholder);
+					domain->deduplicator->Add_pending_chunk(placeholder, domain->deduplicator->cur_fp);
+					domain->deduplicator->cur_fp = placeholder;
+					ftl->Fingerprint_engine->Notify_pending_chunk();
+				}
+
+				/* Dedup current FP: one probe finds the entry or reserves it */
+				bool new_fp;
+				LPA_type rm_lpa = transaction->LPA;
+				ChunkInfo* chunk = domain->deduplicator->Find_or_insert_chunk(domain->deduplicator->cur_fp, new_fp);
+				if (new_fp) {//First time insertion
 					block_manager->Allocate_block_and_page_in_plane_for_user_write(transaction->Stream_id, transaction->Address);
 					transaction->PPA = Convert_address_to_ppa(transaction->Address);
-					cur_chunk = { transaction->PPA, 1 };//Insert first chunk of this entry of hash table
+					chunk->PPA = transaction->PPA;//Insert first chunk of this entry of hash table
+					chunk->ref = 1;
+					update_block_reference_stats(chunk->PPA, 1, 0);
+					domain->deduplicator->Add_stream_reference(domain->deduplicator->cur_fp);
 				}
 				else {//Found duplication
 					transaction->dedup_wr = true;
 					use_SMT = true;
-					size_t new_ref = domain->deduplicator->GetChunkInfo(domain->cur_fp).ref + 1;//With ref increases
-					PPA_type PPA = domain->deduplicator->GetChunkInfo(domain->cur_fp).PPA;//Get original PPA from FP table
-						
-					cur_chunk = {PPA, new_ref};//Update the chunk info to be inserted into hash table
-					VPA = PPA ^ (1ULL << (63));//Convert PPA to VPA
-					if (new_ref == 2 && ReverseMapping[PPA].use_SMT == false) {//Convert PPA-to-VPA and change previous LPA-to-PPA mapping to LPA-to-VPA
-						LPA_type old_lpa = ReverseMapping[PPA].LPA;
-						if (old_lpa == 113394)
-							PRINT_MESSAGE("here");
-						domain->Update_mapping_info(ideal_mapping_table, transaction->Stream_id, old_lpa, VPA, domain->Get_page_status(ideal_mapping_table, transaction->Stream_id, old_lpa));
-						ReverseMapping[PPA].use_SMT = true;
+					chunk->ref++;
+					PPA_type PPA = chunk->PPA;//Get original PPA from FP table
+					size_t new_ref = chunk->ref;
+					if (domain->deduplicator->Verify_enabled)
+						transaction->Verify_PPA = PPA;
+					flash_page_ID_type page_id;
+					Block_Pool_Slot_Type* shared_block = get_page_block(PPA, page_id);
+					OOBEntryType* shared_page = &(shared_block->OOB[page_id]);
+					VPA = shared_page->use_SMT ? shared_page->VPA : domain->deduplicator->Assign_VPA(PPA);//A shared chunk keeps its VPA when GC moves it
+					update_block_reference_stats(PPA, 1, shared_page->use_SMT ? 0 : 1);
+					if (new_ref == 2 && shared_page->use_SMT == false) {//Convert PPA-to-VPA and change previous LPA-to-PPA mapping to LPA-to-VPA
+						LPA_type old_lpa = shared_page->LPA;
+						if (shared_block->Stream_id == transaction->Stream_id) {
+							domain->Update_mapping_info(ideal_mapping_table, transaction->Stream_id, old_lpa, VPA, domain->Get_page_status(ideal_mapping_table, transaction->Stream_id, old_lpa));
+						} else {//Global dedup domain, the LPA belongs to the stream that stored the chunk and is not being accessed
+							update_mapping_for_background_dedup(shared_block->Stream_id, old_lpa, VPA);
+						}
+						shared_page->use_SMT = true;
+					}
+					if (shared_block->Stream_id != transaction->Stream_id) {//The LPA in the OOB area of a page always belongs to the stream of its block, GC locks it there
+						rm_lpa = shared_page->LPA;
+					}
+					//Add_stream_reference also returns 0 for a domain of its own, where no other stream can hold the chunk
+					if (domain->deduplicator->Add_stream_reference(domain->deduplicator->cur_fp) == 0 && domain->deduplicator->In_global_domain()) {
+						domain->deduplicator->Cross_stream_dup_no++;
 					}
 					domain->deduplicator->Dup_chunk_no++;
 				}
 
-				FP_entry = { domain->cur_fp, cur_chunk };
-				domain->deduplicator->Update_FPtable(FP_entry);//If this FP entry already exists deduplicator will update ref and physical address, or it will directly insert into hash table.
+				cur_chunk = *chunk;
+				update_fingerprint_in_cache(transaction->Stream_id, domain->deduplicator->cur_fp);
 					
 				/* Update mapping */
 				if (use_SMT){
 					domain->Update_mapping_info(ideal_mapping_table, transaction->Stream_id, transaction->LPA, VPA, cur_bitmap);//Map current LPA to VPA
-					SMTEntryType cur_SMTEntry = { domain->deduplicator->GetChunkInfo(domain->cur_fp).PPA };
-					std::pair<VPA_type, SMTEntryType> cur_SMTpair(VPA, cur_SMTEntry);
-					if (In_SMT(VPA))
-						SecondaryMappingTable.erase(VPA);
-					SecondaryMappingTable.insert(cur_SMTpair);
+					domain->deduplicator->Insert_SMT(VPA, cur_chunk.PPA);
+					access_smt_entry(transaction->Stream_id, VPA, true);
 					//PRINT_MESSAGE("dedup LPA: " << transaction->LPA << ", to PPA: " << domain->deduplicator->GetChunkInfo(domain->cur_fp).PPA << " ((VPA: " << VPA);
 					//domain->Print_Mappings_Detail();
 				}
@@ -1447,7 +1843,7 @@ namespace SSD_Components
 
 					
 				/* Update Reverse Mapping */
-				RMEntryType RMEntry = { domain->cur_fp, transaction->LPA, VPA, use_SMT , false};
+				RMEntryType RMEntry = { domain->deduplicator->cur_fp, rm_lpa, VPA, use_SMT , false};
 				std::pair<PPA_type, RMEntryType> cur_RMEntry(cur_chunk.PPA, RMEntry);
 				Update_ReverseMapping(cur_RMEntry);
 				//PlaneBookKeepingType *plane_record = &block_manager->plane_manager[transaction->Address.ChannelID][transaction->Address.ChipID][transaction->Address.DieID][transaction->Address.PlaneID];
@@ -1457,58 +1853,97 @@ namespace SSD_Components
 		}
 	}
 
-	Deduplicator::Deduplicator():Total_chunk_no(0), Dup_chunk_no(0) {}
-	Deduplicator::~Deduplicator() {}
-	void Deduplicator::Update_FPtable(const std::pair<FP_type, ChunkInfo> &FP_entry)
+	/*
+	* Drops the reference of an LPA to the page it maps to (Append for CAFTL). A VPA in old_ppa is resolved through the
+	* SMT, so old_ppa holds the physical page on return. If this was the last reference, the chunk, its SMT entry and
+	* its reverse mapping entry are removed and page_freed is set: the caller invalidates the page, or reads its
+	* unchanged sectors first. Returns false if the page holds no chunk.
+	*/
+	bool Address_Mapping_Unit_Page_Level::release_page_reference(const stream_id_type stream_id, PPA_type& old_ppa, bool& page_freed)
 	{
-		std::unordered_map<FP_type, ChunkInfo>::iterator iter = FPtable.find(FP_entry.first);
-		if (iter != FPtable.end())//duplicate
-		{
-			iter->second.ref = FP_entry.second.ref;
-			iter->second.PPA = FP_entry.second.PPA;
-			if (iter->second.ref == 0)
-				FPtable.erase(FP_entry.first);
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		page_freed = false;
+		if (deduplicator->In_SMT(old_ppa)) {//If this ppa is converted into vpa already
+			access_smt_entry(stream_id, old_ppa, false);
+			old_ppa = deduplicator->Get_SMTEntry(old_ppa).PPA;//fetch ppa but not vpa
 		}
-		else//unique
-		{
-			FPtable.insert(FP_entry);
+		RMEntryType metadata;
+		Get_metadata_from_ReverseMapping(old_ppa, metadata);
+		ChunkInfo* old_chunk = deduplicator->Find_chunk(metadata.FP);//Get its fingerprint by RM
+		if (old_chunk == NULL) {
+			return false;
 		}
-	}
-	void Deduplicator::Print_FPtable()
-	{
-		std::cout << "========== Print FP table =================\n";
-		if (FPtable.size() == 0)
-			std::cout << "(Empty)\n";
-		for (auto const &pair : FPtable) {
-			std::cout << "{FP: " << pair.first << ", ref: " << pair.second.ref << ", PPA: " << pair.second.PPA << "}\n";
+		old_chunk->ref -= 1;//Assume this LPA will ref to another PPA
+		deduplicator->Remove_stream_reference(metadata.FP);
+		update_fingerprint_in_cache(stream_id, metadata.FP);
+		update_block_reference_stats(old_ppa, -1, (old_chunk->ref == 0 && metadata.use_SMT) ? -1 : 0);
+		if (old_chunk->ref > 0) {
+			return true;
 		}
-	}
-	bool Deduplicator::In_FPtable(const FP_type &FP)
-	{
-		std::unordered_map<FP_type, ChunkInfo>::const_iterator got = FPtable.find(FP);
-		if (got == FPtable.end())
-			return false;
-		else return true;
-	}
 
-	float Deduplicator::Get_DedupRate()
-	{
-		return float (Dup_chunk_no) / (Total_chunk_no);
+		deduplicator->Remove_chunk(metadata.FP);
+		if (metadata.use_SMT) {//No LPA maps to the VPA anymore, so it can be given to another chunk
+			deduplicator->Remove_SMT(metadata.VPA);
+			access_smt_entry(stream_id, metadata.VPA, true);
+		}
+		RMEntryType RMEntry = { metadata.FP, metadata.LPA, metadata.VPA, metadata.use_SMT, true };
+		Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(old_ppa, RMEntry));
+		page_freed = true;
+		return true;
 	}
-	size_t Deduplicator::Get_FPtable_size() 
+
+	/*
+	* TRIM of the sectors in write_sectors_bitmap of an LPA (Append for CAFTL). An LPA with sectors left keeps its
+	* mapping, only its bitmap shrinks. Otherwise, its reference to the stored page is dropped as on an overwrite,
+	* but no data takes its place: the LPA is unmapped and a page without references is invalidated right away, so GC
+	* does not move it anymore. With sub-page chunks, each chunk without sectors left is released on its own.
+	*/
+	void Address_Mapping_Unit_Page_Level::deallocate_lpa(NVM_Transaction_Flash_WR* transaction)
 	{
-		return FPtable.size();
+		stream_id_type stream_id = transaction->Stream_id;
+		AddressMappingDomain* domain = domains[stream_id];
+		Deduplicator* deduplicator = domain->deduplicator;
+		transaction->dedup_wr = true;//Nothing is programmed
+		PPA_type mapped_ppa = domain->Get_ppa(ideal_mapping_table, stream_id, transaction->LPA);
+		if (mapped_ppa == NO_PPA) {
+			return;
+		}
+
+		deduplicator->Trim_page_no++;
+		page_status_type remaining_sectors = domain->Get_page_status(ideal_mapping_table, stream_id, transaction->LPA) & ~transaction->write_sectors_bitmap;
+		if (mapped_ppa == CHUNK_MAPPED_PPA) {
+			Chunk_Store* chunks = deduplicator->Chunks;
+			unsigned int sectors_per_chunk = chunks->Get_sectors_per_chunk();
+			page_status_type chunk_mask = (((page_status_type)1) << sectors_per_chunk) - 1;
+			for (unsigned int index = 0; index < chunks->Get_chunks_per_page(); index++) {
+				CID_type cid = chunks->Get_logical_chunk(transaction->LPA, index);
+				if (cid == NO_CHUNK || ((remaining_sectors >> (index * sectors_per_chunk)) & chunk_mask) != 0) {
+					continue;
+				}
+				FP_type FP = chunks->Get_chunk(cid).FP;
+				chunks->Set_logical_chunk(transaction->LPA, index, NO_CHUNK);
+				release_chunk(stream_id, cid);
+				deduplicator->Trim_released_no++;
+				if (deduplicator->Find_chunk(FP) == NULL) {
+					deduplicator->Trim_freed_no++;
+				}
+			}
+		} else if (remaining_sectors == 0) {
+			PPA_type old_ppa = mapped_ppa;
+			bool page_freed = deduplicator->Chunks != NULL;//With sub-page chunks, a page mapped as a whole (e.g., by preconditioning) has no chunk
+			if (!page_freed && release_page_reference(stream_id, old_ppa, page_freed)) {
+				deduplicator->Trim_released_no++;
+			}
+			if (page_freed) {
+				NVM::FlashMemory::Physical_Page_Address addr;
+				Convert_ppa_to_address(old_ppa, addr);
+				invalidate_released_page(addr);
+				deduplicator->Trim_freed_no++;
+			}
+		}
+		domain->Update_mapping_info(ideal_mapping_table, stream_id, transaction->LPA, remaining_sectors == 0 ? NO_PPA : mapped_ppa, remaining_sectors);
 	}
 
-	ChunkInfo Deduplicator::GetChunkInfo(const FP_type &FP)
-	{
-		std::unordered_map<FP_type, ChunkInfo>::const_iterator got = FPtable.find(FP);
-		if (got == FPtable.end())
-			PRINT_ERROR("This chunk is not in Fingerprint Table")
-		else 
-			return got->second;
-	} 
-	
 	void AddressMappingDomain::Print_PMT()
 	{
 		std::cout << "========== Print PMT (Full Page) ==========\n";
@@ -1519,113 +1954,93 @@ namespace SSD_Components
 			//std::cout << "{LPN: "  << i << ", PPA/VPA: "  << GlobalMappingTable[i].PPA << ", Bitmap: " << GlobalMappingTable[i].WrittenStateBitmap << ", TimeStamp: " << GlobalMappingTable[i].TimeStamp << "}\n";
 		}
 	}
-	void Print_SMT()
-	{
-		std::cout << "========== Print SMT ======================\n";
-		if (SecondaryMappingTable.size() == 0)
-			std::cout << "(Empty)\n";
-		for (const auto &entry : SecondaryMappingTable) {
-			std::cout << "{VPN: " << entry.first << ", PPN: " << entry.second.PPA << "}\n";
-		}
-	}
-
-	bool In_SMT(VPA_type VPA)
-	{
-		std::map<VPA_type, SMTEntryType>::const_iterator got = SecondaryMappingTable.find(VPA);
-		if (got == SecondaryMappingTable.end())
-			return false;
-		else return true;
-	}
-
-	SMTEntryType Get_SMTEntry(VPA_type VPA)
-	{
-		std::map<VPA_type, SMTEntryType>::const_iterator got = SecondaryMappingTable.find(VPA);
-		
-		if (got == SecondaryMappingTable.end())
-		{
-			PRINT_MESSAGE(VPA);
-			Print_SMT();
-			//Print_ReverseMapping();
-			PRINT_ERROR("This VPA is not in SMT")
-		}
-		else return got->second;
-	}
-
-	void Print_ReverseMapping()
+	void Address_Mapping_Unit_Page_Level::Print_ReverseMapping()
 	{
 		std::cout << "========== Print ReverseMapping ===========\n";
-		if (ReverseMapping.size() == 0)
-			std::cout << "(Empty)\n";
-		for (const auto &entry : ReverseMapping) {
-			std::cout << "{PPN: " << std::setw(8) << entry.first << ", FP: " << entry.second.FP << ", LPA: "<< entry.second.LPA << ", VPA: " << entry.second.VPA << ", use_SMT: " << entry.second.use_SMT << "}\n";
+		bool empty = true;
+		for (PPA_type ppa = 0; ppa < total_physical_pages_no; ppa++) {
+			OOBEntryType* entry = Get_page_metadata(ppa);
+			if (!entry->Has_metadata())
+				continue;
+			empty = false;
+			std::cout << "{PPN: " << std::setw(8) << ppa << ", FP: " << block_manager->oob_fingerprints.Get(entry->FP_slot) << ", LPA: "<< entry->LPA << ", VPA: " << entry->VPA << ", use_SMT: " << entry->use_SMT << "}\n";
 		}
+		if (empty)
+			std::cout << "(Empty)\n";
 	}
 
-	void Update_ReverseMapping(const std::pair<PPA_type, RMEntryType> &cur_rev_pair)
+	void Address_Mapping_Unit_Page_Level::Update_ReverseMapping(const std::pair<PPA_type, RMEntryType> &cur_rev_pair)
 	{
-		std::map<PPA_type, RMEntryType>::iterator got = ReverseMapping.find(cur_rev_pair.first);
-		if (got == ReverseMapping.end())
+		flash_page_ID_type page_id;
+		Block_Pool_Slot_Type* block = get_page_block(cur_rev_pair.first, page_id);
+		if (block == NULL)
+			PRINT_ERROR("Reverse mapping update for an invalid physical address: " << cur_rev_pair.first)
+		OOBEntryType* entry = &block->OOB[page_id];
+		block_manager->uncount_page_metadata(block, *entry);
+		if (!entry->Has_metadata())
 		{
-			ReverseMapping.insert(cur_rev_pair);
+			entry->FP_slot = block_manager->oob_fingerprints.Store(cur_rev_pair.second.FP);
+			entry->LPA = cur_rev_pair.second.LPA;
+			entry->VPA = cur_rev_pair.second.VPA;
+			entry->use_SMT = cur_rev_pair.second.use_SMT;
+			entry->status = cur_rev_pair.second.status;
 		}
 		else
 		{
-			got->second.FP = cur_rev_pair.second.FP;
-			got->second.use_SMT = cur_rev_pair.second.use_SMT;
-			got->second.status = cur_rev_pair.second.status;
+			block_manager->oob_fingerprints.Set(entry->FP_slot, cur_rev_pair.second.FP);
+			entry->use_SMT = cur_rev_pair.second.use_SMT;
+			entry->status = cur_rev_pair.second.status;
 
 			if (cur_rev_pair.second.use_SMT == true)
-				got->second.VPA = cur_rev_pair.second.VPA;
+				entry->VPA = cur_rev_pair.second.VPA;
 			else
 			{
-				got->second.LPA = cur_rev_pair.second.LPA;
-				got->second.VPA = NO_PPA;
+				entry->LPA = cur_rev_pair.second.LPA;
+				entry->VPA = NO_PPA;
 			}
 		}
+		block_manager->count_page_metadata(block, *entry);
 		//Print_ReverseMapping();
 	}
 
-	void Delete_ReverseMapping(const PPA_type &target_ppa)
+	void Address_Mapping_Unit_Page_Level::Delete_ReverseMapping(const PPA_type &target_ppa)
 	{
-		std::map<PPA_type, RMEntryType>::iterator got = ReverseMapping.find(target_ppa);
-		if (got == ReverseMapping.end())
+		flash_page_ID_type page_id;
+		Block_Pool_Slot_Type* block = get_page_block(target_ppa, page_id);
+		if (block == NULL || !block->OOB[page_id].Has_metadata())
 			PRINT_ERROR("Nothing can be deleted in Reverse Mapping!")
-		else
-			ReverseMapping.erase(target_ppa);
+		else {
+			OOBEntryType* entry = &block->OOB[page_id];
+			block_manager->uncount_page_metadata(block, *entry);
+			block_manager->oob_fingerprints.Release(entry->FP_slot);
+			entry->Reset();
+		}
 	}
-	void Get_metadata_from_ReverseMapping(const PPA_type &target_ppa, RMEntryType &metadata)
+	void Address_Mapping_Unit_Page_Level::Get_metadata_from_ReverseMapping(const PPA_type &target_ppa, RMEntryType &metadata)
 	{
-		std::map<PPA_type, RMEntryType>::iterator got = ReverseMapping.find(target_ppa);
-		if (got == ReverseMapping.end()){
+		OOBEntryType* entry = Get_page_metadata(target_ppa);
+		if (entry == NULL || !entry->Has_metadata()){
 			//Print_Mappings_Detail();
 			PRINT_ERROR(" No metdata Found in Reverse Mapping!");
 		}
-		metadata.FP = got->second.FP;
-		metadata.LPA = got->second.LPA;
-		metadata.VPA = got->second.VPA;
-		metadata.use_SMT = got->second.use_SMT;
-		metadata.status = got->second.status;
+		metadata.FP = block_manager->oob_fingerprints.Get(entry->FP_slot);
+		metadata.LPA = entry->LPA;
+		metadata.VPA = entry->VPA;
+		metadata.use_SMT = entry->use_SMT;
+		metadata.status = entry->status;
 	}
 
-	void Get_LPA_from_ReverseMapping(const PPA_type &target_ppa, LPA_type &LPA)
+	void Address_Mapping_Unit_Page_Level::Get_LPA_from_ReverseMapping(const PPA_type &target_ppa, LPA_type &LPA)
 	{
-		std::map<PPA_type, RMEntryType>::iterator got = ReverseMapping.find(target_ppa);
-		if (got == ReverseMapping.end()){
+		OOBEntryType* entry = Get_page_metadata(target_ppa);
+		if (entry == NULL || !entry->Has_metadata()){
 			//Print_ReverseMapping();
 			//PRINT_ERROR(" No LPA Found in Reverse Mapping: " << target_ppa);
+			return;
 		}
-		LPA = got->second.LPA;
+		LPA = entry->LPA;
 	}
 
-	void Update_SMT(const std::pair<VPA_type, SMTEntryType> &cur_SMT_pair)
-	{
-		std::map<VPA_type, SMTEntryType>::iterator got = SecondaryMappingTable.find(cur_SMT_pair.first);
-		if(got == SecondaryMappingTable.end())
-			PRINT_ERROR("No PPA found in SMT!");
-		got->second.PPA = cur_SMT_pair.second.PPA;
-	}
-
-
 	void Address_Mapping_Unit_Page_Level::allocate_plane_for_translation_write(NVM_Transaction_Flash* transaction)
 	{
 		allocate_plane_for_user_write((NVM_Transaction_Flash_WR*)transaction);
@@ -1836,9 +2251,9 @@ namespace SSD_Components
 				size_t new_ref = domain->deduplicator->GetChunkInfo(domain->cur_fp).ref + 1;//With ref increases
 				PPA_type PPA = domain->deduplicator->GetChunkInfo(domain->cur_fp).PPA;//Get original PPA from FP table
 				cur_chunk = { PPA, new_ref };//Update the chunk info to be inserted into hash table
-				VPA = PPA ^ (1ULL << (63));//Convert PPA to VPA
-				if (new_ref == 2 && ReverseMapping[PPA].use_SMT == false) {//Convert PPA-to-VPA and change previous LPA-to-PPA mapping to LPA-to-VPA
-					LPA_type old_lpa = ReverseMapping[PPA].LPA;
+				VPA = PPA_TO_VPA(PPA);//Convert PPA to VPA
+				if (new_ref == 2 && Get_page_metadata(PPA)->use_SMT == false) {//Convert PPA-to-VPA and change previous LPA-to-PPA mapping to LPA-to-VPA
+					LPA_type old_lpa = Get_page_metadata(PPA)->LPA;
 					domain->Update_mapping_info(ideal_mapping_table, stream_id, old_lpa, VPA, domain->Get_page_status(ideal_mapping_table, stream_id, old_lpa));
 				}
 				domain->deduplicator->Dup_chunk_no++;
@@ -1852,10 +2267,7 @@ namespace SSD_Components
 		if (use_SMT) {
 			domain->Update_mapping_info(ideal_mapping_table, stream_id, lpa, VPA, read_sectors_bitmap);//Map current LPA to VPA
 			SMTEntryType cur_SMTEntry = { domain->deduplicator->GetChunkInfo(domain->cur_fp).PPA };
-			std::pair<VPA_type, SMTEntryType> cur_SMTpair(VPA, cur_SMTEntry);
-			if (In_SMT(VPA))
-				SecondaryMappingTable.erase(VPA);
-			SecondaryMappingTable.insert(cur_SMTpair);
+			SecondaryMappingTable.Insert(VPA, cur_SMTEntry);
 		}
 		else
 			domain->Update_mapping_info(ideal_mapping_table, stream_id, lpa, cur_chunk.PPA, read_sectors_bitmap);
@@ -1876,9 +2288,10 @@ namespace SSD_Components
 		return cur_chunk.PPA;
 		*/
 
-		for (const auto &entry : ReverseMapping) {
-			if (entry.second.status == false)
-				return entry.first;
+		for (PPA_type ppa = 0; ppa < total_physical_pages_no; ppa++) {
+			OOBEntryType* entry = Get_page_metadata(ppa);
+			if (entry->Has_metadata() && entry->status == false)
+				return ppa;
 		}
 		return 0;
 	}
@@ -1887,9 +2300,10 @@ namespace SSD_Components
 	{
 		if (domains[stream_id]->Mapping_entry_accessible(ideal_mapping_table, stream_id, lpa)) {
 			ppa = domains[stream_id]->Get_ppa(ideal_mapping_table, stream_id, lpa);
-			if (In_SMT(ppa)){
+			if (domains[stream_id]->deduplicator->In_SMT(ppa)){
 				VPA_type vpa = ppa;
-				ppa = Get_SMTEntry(vpa).PPA;
+				access_smt_entry(stream_id, vpa, false);
+				ppa = domains[stream_id]->deduplicator->Get_SMTEntry(vpa).PPA;
 			}
 			page_state = domains[stream_id]->Get_page_status(ideal_mapping_table, stream_id, lpa);
 		} else {
@@ -1949,6 +2363,74 @@ namespace SSD_Components
 
 	}
 
+	Deduplicator* Address_Mapping_Unit_Page_Level::Get_deduplicator(const stream_id_type stream_id)
+	{
+		return domains[stream_id]->deduplicator;
+	}
+
+	OOBEntryType* Address_Mapping_Unit_Page_Level::Get_page_metadata(const PPA_type ppa)
+	{
+		flash_page_ID_type page_id;
+		Block_Pool_Slot_Type* block = get_page_block(ppa, page_id);
+		if (block == NULL)
+			return NULL;
+		return &(block->OOB[page_id]);
+	}
+
+	Block_Pool_Slot_Type* Address_Mapping_Unit_Page_Level::get_page_block(const PPA_type ppa, flash_page_ID_type& page_id)
+	{
+		if (IS_VPA(ppa) || ppa >= total_physical_pages_no)
+			return NULL;
+		NVM::FlashMemory::Physical_Page_Address addr;
+		Convert_ppa_to_address(ppa, addr);
+		page_id = addr.PageID;
+		return &(block_manager->plane_manager[addr.ChannelID][addr.ChipID][addr.DieID][addr.PlaneID].Blocks[addr.BlockID]);
+	}
+
+	void Address_Mapping_Unit_Page_Level::invalidate_released_page(const NVM::FlashMemory::Physical_Page_Address& page_address)
+	{
+		//In a global dedup domain, the last reference to a page may be dropped by another stream than the one owning its block
+		Block_Pool_Slot_Type* block = &block_manager->plane_manager[page_address.ChannelID][page_address.ChipID][page_address.DieID][page_address.PlaneID].Blocks[page_address.BlockID];
+		block_manager->Invalidate_page_in_block(block->Stream_id, page_address);
+
+		//The LPAs of a GC victim are locked when its GC starts, but a postponed GC only moves the pages that are still valid once
+		//it is executed. The lock of this page is released in a separate event, since it dispatches the waiting transactions again.
+		if (block->Has_ongoing_gc_wl && block->Erase_transaction == NULL && !block->Holds_mapping_data) {
+			RMEntryType metadata;
+			Get_metadata_from_ReverseMapping(Convert_address_to_ppa(page_address), metadata);
+			Simulator->Register_sim_event(Simulator->Time(), this, new std::pair<stream_id_type, LPA_type>(block->Stream_id, metadata.LPA), (int)Address_Mapping_Event_Type::GC_LPA_RELEASED);
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::update_block_reference_stats(const PPA_type ppa, int reference_delta, int shared_page_delta)
+	{
+		if (IS_VPA(ppa) || ppa >= total_physical_pages_no)
+			return;
+		NVM::FlashMemory::Physical_Page_Address addr;
+		Convert_ppa_to_address(ppa, addr);
+		Block_Pool_Slot_Type* block = &block_manager->plane_manager[addr.ChannelID][addr.ChipID][addr.DieID][addr.PlaneID].Blocks[addr.BlockID];
+		block->Reference_count += reference_delta;
+		block->Shared_page_count += shared_page_delta;
+	}
+
+	LPA_type Address_Mapping_Unit_Page_Level::handle_page_lpa_query_from_PHY(NVM_Transaction_Flash* transaction)
+	{
+		PPA_type ppa = transaction->PPA;
+		if (_my_instance->domains[transaction->Stream_id]->deduplicator->In_SMT(ppa))
+			ppa = _my_instance->domains[transaction->Stream_id]->deduplicator->Get_SMTEntry(ppa).PPA;
+		LPA_type lpa = NO_LPA;
+		_my_instance->Get_LPA_from_ReverseMapping(ppa, lpa);
+		if (lpa == NO_LPA) {//Translation and fingerprint bucket pages have no CAFTL metadata, their OOB area holds the MVPN
+			if (transaction->Type == Transaction_Type::WRITE) {
+				lpa = transaction->LPA;
+			} else {
+				lpa = _my_instance->flash_controller->Get_metadata(transaction->Address.ChannelID, transaction->Address.ChipID, transaction->Address.DieID,
+					transaction->Address.PlaneID, transaction->Address.BlockID, transaction->Address.PageID);
+			}
+		}
+		return lpa;
+	}
+
 	inline PPA_type Address_Mapping_Unit_Page_Level::Convert_address_to_ppa(const NVM::FlashMemory::Physical_Page_Address& pageAddress)
 	{
 		return (PPA_type)this->page_no_per_chip * (PPA_type)(pageAddress.ChannelID * this->chip_no_per_channel + pageAddress.ChipID)
@@ -2164,39 +2646,1238 @@ namespace SSD_Components
 		}
 	}
 
-	inline void Address_Mapping_Unit_Page_Level::handle_transaction_serviced_signal_from_PHY(NVM_Transaction_Flash* transaction)
+	//** Append for CAFTL: bounded fingerprint store
+	inline bool Address_Mapping_Unit_Page_Level::is_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn)
 	{
-		//First check if the transaction source is Mapping Module
-		if (transaction->Source != Transaction_Source_Type::MAPPING) {
+		return mvpn >= domains[stream_id]->FP_bucket_base_MVPN && mvpn < domains[stream_id]->FP_bucket_base_MVPN + domains[stream_id]->FP_bucket_no;
+	}
+
+	/*Looks the fingerprint of a user write up in the fingerprint cache before the write is deduplicated.
+	* Returns false if the write has to wait for its fingerprint bucket to be read from flash.*/
+	bool Address_Mapping_Unit_Page_Level::fetch_fingerprint_for_write(NVM_Transaction_Flash_WR* transaction)
+	{
+		AddressMappingDomain* domain = domains[transaction->Stream_id];
+		Fingerprint_Cache* cache = domain->deduplicator->FPcache;
+		if (cache == NULL || domain->deduplicator->Mode == Dedup_Mode::OUT_OF_LINE || transaction->Trim) {
+			return true;
+		}
+
+		//The fingerprint is bound to the write here, so the write keeps it while waiting for its bucket
+		if (!transaction->FP_available) {
+			if (!domain->deduplicator->Has_fingerprint_feed() || !domain->deduplicator->Next_fingerprint(transaction->FP)) {
+				return true;//allocate_page_in_plane_for_user_write deals with the missing fingerprint
+			}
+			transaction->FP_available = true;
+		}
+
+		if (cache->Lookup(transaction->FP)) {
+			return true;
+		}
+
+		//If the bucket has never been written back, or it is being written back right now, its content is known without a flash read
+		MVPN_type mvpn = domain->FP_bucket_base_MVPN + cache->Get_bucket(transaction->FP);
+		if (domain->GlobalTranslationDirectory[mvpn].MPPN == NO_MPPN
+			|| domain->DepartingMappingEntries.find(mvpn) != domain->DepartingMappingEntries.end()) {
+			insert_fingerprint_into_cache(transaction->Stream_id, transaction->FP, false);
+			return true;
+		}
+		//A fingerprint the filter has never seen is not in its bucket either
+		if (domain->deduplicator->Filter != NULL && !domain->deduplicator->Filter->Contains(transaction->FP)) {
+			insert_fingerprint_into_cache(transaction->Stream_id, transaction->FP, false);
+			domain->deduplicator->FP_bucket_reads_filtered++;
+			return true;
+		}
+
+		domain->Waiting_fingerprint_lookup_transactions.insert(std::pair<MVPN_type, NVM_Transaction_Flash*>(mvpn, transaction));
+		if (domain->ArrivingFingerprintBuckets.find(mvpn) == domain->ArrivingFingerprintBuckets.end()) {
+			domain->ArrivingFingerprintBuckets.insert(mvpn);
+			generate_flash_read_request_for_fingerprint_bucket(transaction->Stream_id, mvpn);
+		}
+
+		return false;
+	}
+
+	/*Batched dedup stage of a dispatch list: the fingerprints of all its writes are bound in arrival order and their index
+	* probes are prefetched, so the one-by-one dedup of the writes that follows mostly hits the CPU cache. One sorted pass
+	* finds the writes that duplicate another write of the same list; only the first of them needs a new page.*/
+	void Address_Mapping_Unit_Page_Level::prepare_dedup_batch(const std::list<NVM_Transaction*>& transactionList)
+	{
+		dedup_batch.clear();
+		for (auto it = transactionList.begin(); it != transactionList.end(); it++) {
+			if ((*it)->Type != Transaction_Type::WRITE) {
+				continue;
+			}
+			NVM_Transaction_Flash_WR* write = (NVM_Transaction_Flash_WR*)(*it);
+			Deduplicator* deduplicator = domains[write->Stream_id]->deduplicator;
+			if (deduplicator->Mode == Dedup_Mode::OUT_OF_LINE || write->Trim) {
+				continue;//A placeholder has nothing to look up yet, a TRIM nothing at all
+			}
+			if (deduplicator->Chunks != NULL) {//One lookup per chunk, they are prefetched but not counted as a batch of pages
+				bind_chunk_fingerprints(write);
+				for (auto FP = write->Chunk_FPs.begin(); FP != write->Chunk_FPs.end(); FP++) {
+					deduplicator->Prefetch_chunk(*FP);
+				}
+				continue;
+			}
+			if (!write->FP_available) {
+				if (!deduplicator->Has_fingerprint_feed() || !deduplicator->Next_fingerprint(write->FP)) {
+					continue;//allocate_page_in_plane_for_user_write deals with the missing fingerprint
+				}
+				write->FP_available = true;
+			}
+			deduplicator->Prefetch_chunk(write->FP);
+			dedup_batch.push_back(write);
+		}
+		if (dedup_batch.size() < 2) {
 			return;
 		}
 
-		if (_my_instance->ideal_mapping_table){
-			throw std::logic_error("There should not be any flash read/write when ideal mapping is enabled!");
+		std::sort(dedup_batch.begin(), dedup_batch.end(), [](const NVM_Transaction_Flash_WR* a, const NVM_Transaction_Flash_WR* b) {
+			if (a->Stream_id != b->Stream_id)
+				return a->Stream_id < b->Stream_id;
+			return std::memcmp(a->FP.Digest, b->FP.Digest, FP_DIGEST_SIZE) < 0;
+		});
+		for (size_t i = 0; i < dedup_batch.size(); i++) {
+			Deduplicator* deduplicator = domains[dedup_batch[i]->Stream_id]->deduplicator;
+			bool same_stream = i > 0 && dedup_batch[i]->Stream_id == dedup_batch[i - 1]->Stream_id;
+			if (!same_stream)
+				deduplicator->Batch_no++;
+			deduplicator->Batch_write_no++;
+			if (same_stream && dedup_batch[i]->FP == dedup_batch[i - 1]->FP)
+				deduplicator->Batch_dup_no++;
 		}
+	}
 
-		if (transaction->Type == Transaction_Type::WRITE) {
-			_my_instance->domains[transaction->Stream_id]->DepartingMappingEntries.erase((MVPN_type)((NVM_Transaction_Flash_WR*)transaction)->Content);
-		} else {
-			/*If this is a read for an MVP that is required for merging unchanged mapping enries
-			* (stored on flash) with those updated entries that are evicted from CMT*/
-			if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite != NULL) {
-				((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
+	void Address_Mapping_Unit_Page_Level::insert_fingerprint_into_cache(const stream_id_type stream_id, const FP_type& FP, bool dirty)
+	{
+		Fingerprint_Cache* cache = domains[stream_id]->deduplicator->FPcache;
+		if (!cache->Check_free_slot_availability()) {
+			bool evicted_dirty;
+			FP_type evicted_fp = cache->Evict_one_slot(evicted_dirty);
+			if (evicted_dirty) {
+				generate_flash_writeback_request_for_fingerprint_bucket(stream_id, domains[stream_id]->FP_bucket_base_MVPN + cache->Get_bucket(evicted_fp));
 			}
+		}
+		cache->Insert(FP, dirty);
+	}
 
-			_my_instance->ftl->TSU->Prepare_for_transaction_submit();
-			MVPN_type mvpn = (MVPN_type)((NVM_Transaction_Flash_RD*)transaction)->Content;
-			std::multimap<MVPN_type, LPA_type>::iterator it = _my_instance->domains[transaction->Stream_id]->ArrivingMappingEntries.find(mvpn);
-			while (it != _my_instance->domains[transaction->Stream_id]->ArrivingMappingEntries.end()) {
-				if ((*it).first == mvpn) {
-					LPA_type lpa = (*it).second;
+	/*Any change to the entry of a fingerprint (insertion, reference count, physical address or removal) makes it dirty.
+	* An entry that is not cached is brought in without a flash read; the write back merges it with its bucket.*/
+	void Address_Mapping_Unit_Page_Level::update_fingerprint_in_cache(const stream_id_type stream_id, const FP_type& FP)
+	{
+		Fingerprint_Cache* cache = domains[stream_id]->deduplicator->FPcache;
+		if (cache == NULL) {
+			return;
+		}
 
-					//This mapping entry may arrived due to an update read request that is required for merging new and old mapping entries.
-					//If that is the case, we should not insert it into CMT
-					if (_my_instance->domains[transaction->Stream_id]->CMT->Is_slot_reserved_for_lpn_and_waiting(transaction->Stream_id, lpa)) {
-						_my_instance->domains[transaction->Stream_id]->CMT->Insert_new_mapping_info(transaction->Stream_id, lpa,
-							_my_instance->domains[transaction->Stream_id]->GlobalMappingTable[lpa].PPA,
-							_my_instance->domains[transaction->Stream_id]->GlobalMappingTable[lpa].WrittenStateBitmap);
+		if (cache->Exists(FP)) {
+			cache->Make_dirty(FP);
+		} else {
+			insert_fingerprint_into_cache(stream_id, FP, true);
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::generate_flash_read_request_for_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn)
+	{
+		if (is_mvpn_locked_for_gc(stream_id, mvpn)) {
+			manage_mapping_transaction_facing_barrier(stream_id, mvpn, true);
+		} else {
+			ftl->TSU->Prepare_for_transaction_submit();
+
+			MPPN_type mppn = domains[stream_id]->GlobalTranslationDirectory[mvpn].MPPN;
+			if (mppn == NO_MPPN) {
+				PRINT_ERROR("Reading an invalid physical flash page address in function generate_flash_read_request_for_fingerprint_bucket!")
+			}
+
+			NVM_Transaction_Flash_RD* readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id,
+				SECTOR_SIZE_IN_BYTE * sector_no_per_page, mvpn, mppn, NULL, mvpn, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+			Convert_ppa_to_address(mppn, readTR->Address);
+			block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+			ftl->TSU->Submit_transaction(readTR);
+			domains[stream_id]->deduplicator->FP_bucket_reads++;
+
+			ftl->TSU->Schedule();
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::generate_flash_writeback_request_for_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn)
+	{
+		if (is_mvpn_locked_for_gc(stream_id, mvpn)) {
+			manage_mapping_transaction_facing_barrier(stream_id, mvpn, false);
+			domains[stream_id]->DepartingMappingEntries.insert(mvpn);
+		} else {
+			ftl->TSU->Prepare_for_transaction_submit();
+
+			//The evicted entry is merged with the rest of its bucket, so the old bucket page is read first
+			NVM_Transaction_Flash_RD* readTR = NULL;
+			MPPN_type mppn = domains[stream_id]->GlobalTranslationDirectory[mvpn].MPPN;
+			if (mppn != NO_MPPN) {
+				readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+					mvpn, mppn, NULL, mvpn, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+				Convert_ppa_to_address(mppn, readTR->Address);
+				block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+				domains[stream_id]->deduplicator->FP_bucket_reads++;
+			}
+
+			NVM_Transaction_Flash_WR* writeTR = new NVM_Transaction_Flash_WR(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+				mvpn, mppn, NULL, mvpn, readTR, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+			allocate_plane_for_translation_write(writeTR);
+			allocate_page_in_plane_for_translation_write(writeTR, mvpn, false);
+			domains[stream_id]->DepartingMappingEntries.insert(mvpn);
+			if (readTR != NULL) {
+				readTR->RelatedWrite = writeTR;
+				ftl->TSU->Submit_transaction(readTR);
+			}
+			ftl->TSU->Submit_transaction(writeTR);
+			domains[stream_id]->deduplicator->FP_bucket_writes++;
+
+			ftl->TSU->Schedule();
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::handle_fingerprint_bucket_serviced(NVM_Transaction_Flash* transaction)
+	{
+		AddressMappingDomain* domain = domains[transaction->Stream_id];
+		if (transaction->Type == Transaction_Type::WRITE) {
+			domain->DepartingMappingEntries.erase((MVPN_type)((NVM_Transaction_Flash_WR*)transaction)->Content);
+			return;
+		}
+
+		//The old content of a bucket that is being written back
+		if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite != NULL) {
+			((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
+			return;
+		}
+
+		//A lookup read: the fingerprints of the waiting writes are now known and the writes continue with address translation
+		MVPN_type mvpn = (MVPN_type)((NVM_Transaction_Flash_RD*)transaction)->Content;
+		domain->ArrivingFingerprintBuckets.erase(mvpn);
+		ftl->TSU->Prepare_for_transaction_submit();
+		auto it = domain->Waiting_fingerprint_lookup_transactions.find(mvpn);
+		while (it != domain->Waiting_fingerprint_lookup_transactions.end() && (*it).first == mvpn) {
+			NVM_Transaction_Flash_WR* write = (NVM_Transaction_Flash_WR*)(*it).second;
+			if (!domain->deduplicator->FPcache->Exists(write->FP)) {
+				insert_fingerprint_into_cache(write->Stream_id, write->FP, false);
+			}
+			if (is_lpa_locked_for_gc(write->Stream_id, write->LPA)) {
+				manage_user_transaction_facing_barrier(write);
+			} else if (query_cmt(write)) {
+				if (write->dedup_wr) {
+					complete_duplicate_write(write);
+				} else {
+					ftl->TSU->Submit_transaction(write);
+					if (write->RelatedRead != NULL) {
+						ftl->TSU->Submit_transaction(write->RelatedRead);
+					}
+				}
+			}
+			domain->Waiting_fingerprint_lookup_transactions.erase(it++);
+		}
+		ftl->TSU->Schedule();
+	}
+
+	//** Append for CAFTL: bounded Secondary Mapping Table
+	inline bool Address_Mapping_Unit_Page_Level::is_smt_page(const stream_id_type stream_id, const MVPN_type mvpn)
+	{
+		return mvpn >= domains[stream_id]->SMT_page_base_MVPN && mvpn < domains[stream_id]->SMT_page_base_MVPN + domains[stream_id]->SMT_page_no;
+	}
+
+	/*Looks the SMT entry of a user read up in the SMT cache before the read is translated. The PMT entry of the LPA
+	* may not be in the CMT yet, in that case the GMT tells whether the LPA is shared; translate_lpa_to_ppa catches the rest.
+	* Returns false if the read has to wait for its SMT page to be read from flash.*/
+	bool Address_Mapping_Unit_Page_Level::fetch_smt_entry_for_read(NVM_Transaction_Flash_RD* transaction)
+	{
+		AddressMappingDomain* domain = domains[transaction->Stream_id];
+		SMT_Cache* cache = domain->deduplicator->SMTcache;
+		if (cache == NULL) {
+			return true;
+		}
+
+		PPA_type ppa = domain->Mapping_entry_accessible(ideal_mapping_table, transaction->Stream_id, transaction->LPA) ?
+			domain->Get_ppa(ideal_mapping_table, transaction->Stream_id, transaction->LPA) : domain->GlobalMappingTable[transaction->LPA].PPA;
+		if (!domain->deduplicator->In_SMT(ppa) || cache->Lookup(ppa)) {
+			return true;
+		}
+
+		//If the SMT page has never been written back, or it is being written back right now, its content is known without a flash read
+		MVPN_type mvpn = domain->SMT_page_base_MVPN + cache->Get_page(ppa);
+		if (domain->GlobalTranslationDirectory[mvpn].MPPN == NO_MPPN
+			|| domain->DepartingMappingEntries.find(mvpn) != domain->DepartingMappingEntries.end()) {
+			insert_smt_entry_into_cache(transaction->Stream_id, ppa, false);
+			return true;
+		}
+
+		domain->Waiting_SMT_lookup_transactions.insert(std::pair<MVPN_type, NVM_Transaction_Flash*>(mvpn, transaction));
+		if (domain->ArrivingSMTPages.find(mvpn) == domain->ArrivingSMTPages.end()) {
+			domain->ArrivingSMTPages.insert(mvpn);
+			generate_flash_read_request_for_smt_page(transaction->Stream_id, mvpn);
+		}
+
+		return false;
+	}
+
+	/*An SMT access on the write or GC path. These paths do not wait for the SMT page: a missing entry that is only
+	* looked up is read from flash in the background, and an entry that is changed (insertion, GC move or removal)
+	* is brought in dirty without a flash read, since the write back merges it with the rest of its SMT page.*/
+	void Address_Mapping_Unit_Page_Level::access_smt_entry(const stream_id_type stream_id, const VPA_type VPA, bool dirty)
+	{
+		AddressMappingDomain* domain = domains[stream_id];
+		SMT_Cache* cache = domain->deduplicator->SMTcache;
+		if (cache == NULL) {
+			return;
+		}
+
+		if (cache->Lookup(VPA)) {
+			if (dirty) {
+				cache->Make_dirty(VPA);
+			}
+			return;
+		}
+
+		MVPN_type mvpn = domain->SMT_page_base_MVPN + cache->Get_page(VPA);
+		if (!dirty && domain->GlobalTranslationDirectory[mvpn].MPPN != NO_MPPN
+			&& domain->DepartingMappingEntries.find(mvpn) == domain->DepartingMappingEntries.end()
+			&& domain->ArrivingSMTPages.find(mvpn) == domain->ArrivingSMTPages.end()) {
+			domain->ArrivingSMTPages.insert(mvpn);
+			generate_flash_read_request_for_smt_page(stream_id, mvpn);
+		}
+		insert_smt_entry_into_cache(stream_id, VPA, dirty);
+	}
+
+	void Address_Mapping_Unit_Page_Level::insert_smt_entry_into_cache(const stream_id_type stream_id, const VPA_type VPA, bool dirty)
+	{
+		SMT_Cache* cache = domains[stream_id]->deduplicator->SMTcache;
+		if (!cache->Check_free_slot_availability()) {
+			bool evicted_dirty;
+			VPA_type evicted_vpa = cache->Evict_one_slot(evicted_dirty);
+			if (evicted_dirty) {
+				generate_flash_writeback_request_for_smt_page(stream_id, domains[stream_id]->SMT_page_base_MVPN + cache->Get_page(evicted_vpa));
+			}
+		}
+		cache->Insert(VPA, dirty);
+	}
+
+	void Address_Mapping_Unit_Page_Level::generate_flash_read_request_for_smt_page(const stream_id_type stream_id, const MVPN_type mvpn)
+	{
+		if (is_mvpn_locked_for_gc(stream_id, mvpn)) {
+			manage_mapping_transaction_facing_barrier(stream_id, mvpn, true);
+		} else {
+			ftl->TSU->Prepare_for_transaction_submit();
+
+			MPPN_type mppn = domains[stream_id]->GlobalTranslationDirectory[mvpn].MPPN;
+			if (mppn == NO_MPPN) {
+				PRINT_ERROR("Reading an invalid physical flash page address in function generate_flash_read_request_for_smt_page!")
+			}
+
+			NVM_Transaction_Flash_RD* readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id,
+				SECTOR_SIZE_IN_BYTE * sector_no_per_page, mvpn, mppn, NULL, mvpn, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+			Convert_ppa_to_address(mppn, readTR->Address);
+			block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+			ftl->TSU->Submit_transaction(readTR);
+			Stats::Total_flash_reads_for_SMT++;
+			Stats::Total_flash_reads_for_SMT_per_stream[stream_id]++;
+
+			ftl->TSU->Schedule();
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::generate_flash_writeback_request_for_smt_page(const stream_id_type stream_id, const MVPN_type mvpn)
+	{
+		if (is_mvpn_locked_for_gc(stream_id, mvpn)) {
+			manage_mapping_transaction_facing_barrier(stream_id, mvpn, false);
+			domains[stream_id]->DepartingMappingEntries.insert(mvpn);
+		} else {
+			ftl->TSU->Prepare_for_transaction_submit();
+
+			//The evicted entry is merged with the rest of its SMT page, so the old SMT page is read first
+			NVM_Transaction_Flash_RD* readTR = NULL;
+			MPPN_type mppn = domains[stream_id]->GlobalTranslationDirectory[mvpn].MPPN;
+			if (mppn != NO_MPPN) {
+				readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+					mvpn, mppn, NULL, mvpn, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+				Convert_ppa_to_address(mppn, readTR->Address);
+				block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+				Stats::Total_flash_reads_for_SMT++;
+				Stats::Total_flash_reads_for_SMT_per_stream[stream_id]++;
+			}
+
+			NVM_Transaction_Flash_WR* writeTR = new NVM_Transaction_Flash_WR(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+				mvpn, mppn, NULL, mvpn, readTR, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+			allocate_plane_for_translation_write(writeTR);
+			allocate_page_in_plane_for_translation_write(writeTR, mvpn, false);
+			domains[stream_id]->DepartingMappingEntries.insert(mvpn);
+			if (readTR != NULL) {
+				readTR->RelatedWrite = writeTR;
+				ftl->TSU->Submit_transaction(readTR);
+			}
+			ftl->TSU->Submit_transaction(writeTR);
+			Stats::Total_flash_writes_for_SMT++;
+			Stats::Total_flash_writes_for_SMT_per_stream[stream_id]++;
+
+			ftl->TSU->Schedule();
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::handle_smt_page_serviced(NVM_Transaction_Flash* transaction)
+	{
+		AddressMappingDomain* domain = domains[transaction->Stream_id];
+		if (transaction->Type == Transaction_Type::WRITE) {
+			domain->DepartingMappingEntries.erase((MVPN_type)((NVM_Transaction_Flash_WR*)transaction)->Content);
+			return;
+		}
+
+		//The old content of an SMT page that is being written back
+		if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite != NULL) {
+			((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
+			return;
+		}
+
+		//A lookup read: the SMT entries of the waiting reads are now in DRAM and the reads continue with address translation
+		MVPN_type mvpn = (MVPN_type)((NVM_Transaction_Flash_RD*)transaction)->Content;
+		domain->ArrivingSMTPages.erase(mvpn);
+		ftl->TSU->Prepare_for_transaction_submit();
+		auto it = domain->Waiting_SMT_lookup_transactions.find(mvpn);
+		while (it != domain->Waiting_SMT_lookup_transactions.end() && (*it).first == mvpn) {
+			NVM_Transaction_Flash* read = (*it).second;
+			PPA_type vpa = domain->Mapping_entry_accessible(ideal_mapping_table, read->Stream_id, read->LPA) ?
+				domain->Get_ppa(ideal_mapping_table, read->Stream_id, read->LPA) : domain->GlobalMappingTable[read->LPA].PPA;
+			if (domain->deduplicator->In_SMT(vpa) && !domain->deduplicator->SMTcache->Exists(vpa)) {
+				insert_smt_entry_into_cache(read->Stream_id, vpa, false);
+			}
+			if (is_lpa_locked_for_gc(read->Stream_id, read->LPA)) {
+				manage_user_transaction_facing_barrier(read);
+			} else if (query_cmt(read)) {
+				ftl->TSU->Submit_transaction(read);
+			}
+			domain->Waiting_SMT_lookup_transactions.erase(it++);
+		}
+		ftl->TSU->Schedule();
+	}
+
+	//** Append for CAFTL: out-of-line dedup
+	/*Reads up to max_read_no pending chunks back from flash, so that the fingerprint engine can hash them.
+	* Pages that GC is moving right now are skipped, GC fingerprints them while moving them. Pages on a chip that is
+	* running GC are skipped too: the TSU serves background reads as mapping reads, before the GC transactions of
+	* the chip, so they could hold the GC off for as long as they are issued, e.g., while a chunk whose duplicate
+	* is locked by that GC is read over and over again.*/
+	unsigned int Address_Mapping_Unit_Page_Level::Issue_background_dedup_reads(unsigned int max_read_no, bool& deferred)
+	{
+		unsigned int issued_read_no = 0;
+		deferred = false;
+		for (stream_id_type stream_id = 0; stream_id < no_of_input_streams && issued_read_no < max_read_no; stream_id++) {
+			Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+			if (deduplicator->Mode != Dedup_Mode::OUT_OF_LINE) {
+				continue;
+			}
+
+			FP_type placeholder;
+			std::list<FP_type> deferred_chunks;
+			while (issued_read_no < max_read_no && deduplicator->Next_pending_chunk(placeholder)) {
+				PPA_type ppa = deduplicator->Find_chunk(placeholder)->PPA;
+				OOBEntryType* page = Get_page_metadata(ppa);
+				NVM::FlashMemory::Physical_Page_Address addr;
+				Convert_ppa_to_address(ppa, addr);
+				if (is_lpa_locked_for_gc(stream_id, page->LPA) || chip_has_ongoing_gc(addr)) {
+					deferred_chunks.push_back(placeholder);
+					continue;
+				}
+
+				if (issued_read_no == 0) {
+					ftl->TSU->Prepare_for_transaction_submit();
+				}
+				NVM_Transaction_Flash_RD* readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
+					page->LPA, ppa, NULL, 0, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
+				Convert_ppa_to_address(ppa, readTR->Address);
+				block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+				domains[stream_id]->Background_dedup_reads[readTR] = placeholder;
+				ftl->TSU->Submit_transaction(readTR);
+				deduplicator->Background_read_no++;
+				issued_read_no++;
+			}
+			for (auto it = deferred_chunks.begin(); it != deferred_chunks.end(); it++) {
+				deduplicator->Requeue_pending_chunk(*it);
+			}
+			if (deferred_chunks.size() > 0) {
+				deferred = true;
+			}
+		}
+		if (issued_read_no > 0) {
+			ftl->TSU->Schedule();
+		}
+
+		return issued_read_no;
+	}
+
+	bool Address_Mapping_Unit_Page_Level::chip_has_ongoing_gc(const NVM::FlashMemory::Physical_Page_Address& address)
+	{
+		for (flash_die_ID_type die_id = 0; die_id < die_no_per_chip; die_id++) {
+			for (flash_plane_ID_type plane_id = 0; plane_id < plane_no_per_die; plane_id++) {
+				if (block_manager->plane_manager[address.ChannelID][address.ChipID][die_id][plane_id].Ongoing_erase_operations.size() > 0) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void Address_Mapping_Unit_Page_Level::Merge_pending_chunk(const stream_id_type stream_id, const FP_type& placeholder)
+	{
+		//GC locked the page while it was being read and hashed, so it is retried in a later idle period
+		if (!merge_pending_chunk(stream_id, placeholder, false)) {
+			domains[stream_id]->deduplicator->Requeue_pending_chunk(placeholder);
+		}
+	}
+
+	void Address_Mapping_Unit_Page_Level::Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter)
+	{
+		std::string tmp = name_prefix + ".Dedup";
+		for (unsigned int stream_id = 0; stream_id < no_of_input_streams; stream_id++) {
+			Dedup_Epoch_Record record;
+			record_dedup_state(stream_id, record);
+			xmlwriter.Write_start_element_tag(tmp);
+
+			std::string attr = "Stream_ID";
+			std::string val = std::to_string(stream_id);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Dedup_Rate";
+			val = std::to_string(record.Chunk_no == 0 ? 0 : double(record.Dup_chunk_no) / record.Chunk_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Total_Chunk_Writes";
+			val = std::to_string(record.Chunk_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Writes_Avoided";
+			val = std::to_string(record.Dup_chunk_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "FP_Table_Size";
+			val = std::to_string(record.FP_table_size);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "SMT_Size";
+			val = std::to_string(record.SMT_size);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Live_Reverse_Entries";
+			val = std::to_string(record.Live_reverse_entry_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Invalid_Reverse_Entries";
+			val = std::to_string(record.Invalid_reverse_entry_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Hash_Engine_Utilization";
+			val = std::to_string(record.Hash_engine_utilization);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+			if (deduplicator->Chunks != NULL && deduplicator->Chunks->Is_compressed()) {
+				attr = "Compression_Saving";
+				val = std::to_string(deduplicator->Unique_chunk_sector_no == 0 ? 0 : 1.0 - double(deduplicator->Compressed_chunk_sector_no) / deduplicator->Unique_chunk_sector_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Stored_Sectors";
+				val = std::to_string(deduplicator->Compressed_chunk_sector_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "GC_Compacted_Pages";
+				val = std::to_string(deduplicator->GC_compacted_page_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+			}
+			if (deduplicator->Verify_enabled) {
+				attr = "Verify_Reads";
+				val = std::to_string(deduplicator->Verify_read_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Verify_Latency_Per_Duplicate";
+				val = std::to_string(deduplicator->Verify_read_no == 0 ? 0 : double(deduplicator->Verify_time) / deduplicator->Verify_read_no / SIM_TIME_TO_MICROSECONDS_COEFF);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+			}
+			if (deduplicator->In_global_domain()) {
+				attr = "Cross_Stream_Duplicates";
+				val = std::to_string(deduplicator->Cross_stream_dup_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+			}
+			if (deduplicator->GC_dedup_enabled) {
+				attr = "GC_Fingerprinted_Pages";
+				val = std::to_string(deduplicator->GC_hash_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "GC_Merged_Duplicates";
+				val = std::to_string(deduplicator->GC_merge_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+			}
+
+			xmlwriter.Write_end_element_tag();
+
+			//The dedup rate of an epoch only counts the chunks written during that epoch
+			size_t prev_chunk_no = 0, prev_dup_chunk_no = 0;
+			for (auto& epoch : domains[stream_id]->Dedup_epochs) {
+				xmlwriter.Write_start_element_tag(tmp + ".Epoch");
+
+				attr = "Stream_ID";
+				val = std::to_string(stream_id);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Time";
+				val = std::to_string(epoch.Time);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Dedup_Rate";
+				val = std::to_string(epoch.Chunk_no == 0 ? 0 : double(epoch.Dup_chunk_no) / epoch.Chunk_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Epoch_Dedup_Rate";
+				val = std::to_string(epoch.Chunk_no == prev_chunk_no ? 0 : double(epoch.Dup_chunk_no - prev_dup_chunk_no) / (epoch.Chunk_no - prev_chunk_no));
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Writes_Avoided";
+				val = std::to_string(epoch.Dup_chunk_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "FP_Table_Size";
+				val = std::to_string(epoch.FP_table_size);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "SMT_Size";
+				val = std::to_string(epoch.SMT_size);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Live_Reverse_Entries";
+				val = std::to_string(epoch.Live_reverse_entry_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Invalid_Reverse_Entries";
+				val = std::to_string(epoch.Invalid_reverse_entry_no);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				attr = "Hash_Engine_Utilization";
+				val = std::to_string(epoch.Hash_engine_utilization);
+				xmlwriter.Write_attribute_string_inline(attr, val);
+
+				xmlwriter.Write_end_element_tag();
+				prev_chunk_no = epoch.Chunk_no;
+				prev_dup_chunk_no = epoch.Dup_chunk_no;
+			}
+		}
+
+		//** Append for CAFTL: sharing across the streams of a global dedup domain
+		Deduplicator* deduplicator = domains[0]->deduplicator;
+		if (deduplicator->In_global_domain()) {
+			size_t shared_chunk_no, excess_copy_no, chunk_write_no = 0, cross_stream_dup_no = 0;
+			deduplicator->Get_cross_stream_sharing(shared_chunk_no, excess_copy_no);
+			for (unsigned int stream_id = 0; stream_id < no_of_input_streams; stream_id++) {
+				chunk_write_no += domains[stream_id]->deduplicator->Total_chunk_no;
+				cross_stream_dup_no += domains[stream_id]->deduplicator->Cross_stream_dup_no;
+			}
+			xmlwriter.Write_start_element_tag(tmp + ".Global");
+
+			std::string attr = "Stored_Chunks";
+			std::string val = std::to_string(deduplicator->Get_FPtable_size());
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Cross_Stream_Shared_Chunks";
+			val = std::to_string(shared_chunk_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Excess_Copies_Avoided";
+			val = std::to_string(excess_copy_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Cross_Stream_Duplicates";
+			val = std::to_string(cross_stream_dup_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			attr = "Cross_Stream_Write_Saving";
+			val = std::to_string(chunk_write_no == 0 ? 0 : double(cross_stream_dup_no) / chunk_write_no);
+			xmlwriter.Write_attribute_string_inline(attr, val);
+
+			xmlwriter.Write_end_element_tag();
+		}
+	}
+
+	//All the counters are maintained incrementally, so a record costs the same whatever the size of the tables
+	void Address_Mapping_Unit_Page_Level::record_dedup_state(const stream_id_type stream_id, Dedup_Epoch_Record& record)
+	{
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		record.Time = Simulator->Time();
+		record.Chunk_no = deduplicator->Total_chunk_no;
+		record.Dup_chunk_no = deduplicator->Dup_chunk_no;
+		record.FP_table_size = deduplicator->Get_FPtable_size();
+		record.SMT_size = deduplicator->Get_SMT_size();
+		record.Live_reverse_entry_no = block_manager->page_metadata_no[stream_id] - block_manager->invalid_page_metadata_no[stream_id];
+		record.Invalid_reverse_entry_no = block_manager->invalid_page_metadata_no[stream_id];
+		record.Hash_engine_utilization = (ftl->Fingerprint_engine == NULL ? 0 : ftl->Fingerprint_engine->Get_utilization());
+	}
+
+	void Address_Mapping_Unit_Page_Level::log_dedup_epoch()
+	{
+		for (unsigned int stream_id = 0; stream_id < no_of_input_streams; stream_id++) {
+			domains[stream_id]->Dedup_epochs.push_back(Dedup_Epoch_Record());
+			record_dedup_state(stream_id, domains[stream_id]->Dedup_epochs.back());
+		}
+	}
+
+	/*Gives a pending chunk its real fingerprint and merges it if it is a duplicate.
+	* Returns false if the chunk cannot be touched, since GC is moving its page.*/
+	bool Address_Mapping_Unit_Page_Level::merge_pending_chunk(const stream_id_type stream_id, const FP_type& placeholder, bool is_for_gc)
+	{
+		AddressMappingDomain* domain = domains[stream_id];
+		Deduplicator* deduplicator = domain->deduplicator;
+		FP_type fp;
+		if (!deduplicator->Get_pending_chunk(placeholder, fp)) {
+			return true;//Already merged, e.g., by GC while the page was being read
+		}
+		ChunkInfo* pending_chunk = deduplicator->Find_chunk(placeholder);
+		if (pending_chunk == NULL) {//The page was overwritten before it was fingerprinted
+			deduplicator->Remove_pending_chunk(placeholder);
+			deduplicator->Dropped_pending_no++;
+			return true;
+		}
+		PPA_type ppa = pending_chunk->PPA;
+		LPA_type lpa = Get_page_metadata(ppa)->LPA;
+		if (!is_for_gc && is_lpa_locked_for_gc(stream_id, lpa)) {
+			return false;
+		}
+		ChunkInfo* existing_chunk = deduplicator->Find_chunk(fp);
+		if (existing_chunk != NULL && Get_page_metadata(existing_chunk->PPA)->LPA != lpa
+			&& is_lpa_locked_for_gc(stream_id, Get_page_metadata(existing_chunk->PPA)->LPA)) {
+			return false;//The page of the existing chunk is being moved by GC
+		}
+
+		deduplicator->Remove_pending_chunk(placeholder);
+		if (resolve_placeholder_chunk(stream_id, placeholder, fp, ppa, lpa)) {
+			deduplicator->Background_merge_no++;
+		}
+
+		return true;
+	}
+
+	/*Replaces the placeholder of a chunk with its real fingerprint, the chunk being stored alone at ppa for lpa.
+	* If the fingerprint is already in the table, the LPA is remapped to the existing chunk (exactly as an inline
+	* duplicate would be) and the redundant copy is invalidated. Returns true in that case.*/
+	bool Address_Mapping_Unit_Page_Level::resolve_placeholder_chunk(const stream_id_type stream_id, const FP_type& placeholder, const FP_type& fp, const PPA_type ppa, const LPA_type lpa)
+	{
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		update_fingerprint_in_cache(stream_id, placeholder);
+		deduplicator->Remove_chunk(placeholder);
+		bool new_fp;
+		ChunkInfo* chunk = deduplicator->Find_or_insert_chunk(fp, new_fp);
+		if (new_fp) {//Unique content, the chunk only gets its real fingerprint
+			chunk->PPA = ppa;
+			chunk->ref = 1;
+			update_fingerprint_in_cache(stream_id, fp);
+			RMEntryType RMEntry = { fp, lpa, NO_PPA, false, false };
+			Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(ppa, RMEntry));
+			return false;
+		}
+
+		chunk->ref++;
+		PPA_type shared_ppa = chunk->PPA;
+		OOBEntryType* shared_page = Get_page_metadata(shared_ppa);
+		VPA_type VPA = shared_page->use_SMT ? shared_page->VPA : deduplicator->Assign_VPA(shared_ppa);
+		update_block_reference_stats(shared_ppa, 1, shared_page->use_SMT ? 0 : 1);
+		update_block_reference_stats(ppa, -1, 0);//The redundant copy held the only reference of the placeholder chunk
+		if (chunk->ref == 2 && shared_page->use_SMT == false) {//Convert PPA-to-VPA and change previous LPA-to-PPA mapping to LPA-to-VPA
+			update_mapping_for_background_dedup(stream_id, shared_page->LPA, VPA);
+			shared_page->use_SMT = true;
+		}
+		update_fingerprint_in_cache(stream_id, fp);
+		update_mapping_for_background_dedup(stream_id, lpa, VPA);
+		deduplicator->Insert_SMT(VPA, shared_ppa);
+		access_smt_entry(stream_id, VPA, true);
+		RMEntryType shared_RMEntry = { fp, lpa, VPA, true, false };
+		Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(shared_ppa, shared_RMEntry));
+
+		//The redundant copy is garbage now, GC reclaims it like any other invalid page
+		RMEntryType RMEntry = { fp, lpa, NO_PPA, false, true };
+		Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(ppa, RMEntry));
+		NVM::FlashMemory::Physical_Page_Address addr;
+		Convert_ppa_to_address(ppa, addr);
+		invalidate_released_page(addr);
+		deduplicator->Dup_chunk_no++;
+
+		return true;
+	}
+
+	/*GC dedup: the data of a moved page passes through the controller, so a page that was written under a placeholder
+	* (skipped by sampling, or still pending in OUT_OF_LINE mode) is fingerprinted before it is programmed again.
+	* Returns true if it was a duplicate and merged, the GC write is then dropped. A unique page is moved as usual,
+	* but under its real fingerprint, so later writes of the same content are deduplicated against it.*/
+	bool Address_Mapping_Unit_Page_Level::merge_duplicate_for_gc(NVM_Transaction_Flash_WR* transaction)
+	{
+		stream_id_type stream_id = transaction->Stream_id;
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		PPA_type ppa = Convert_address_to_ppa(transaction->Address);
+		RMEntryType metadata;
+		Get_metadata_from_ReverseMapping(ppa, metadata);
+		if (metadata.use_SMT || metadata.LPA != transaction->LPA) {
+			return false;//A shared chunk already has its real fingerprint
+		}
+		FP_type fp;
+		bool pending = deduplicator->Get_pending_chunk(metadata.FP, fp);
+		if (!pending && !deduplicator->Get_skipped_chunk(metadata.FP, fp)) {
+			return false;
+		}
+		ChunkInfo* existing_chunk = deduplicator->Find_chunk(fp);
+		if (existing_chunk != NULL && Get_page_metadata(existing_chunk->PPA)->LPA != metadata.LPA
+			&& is_lpa_locked_for_gc(stream_id, Get_page_metadata(existing_chunk->PPA)->LPA)) {
+			return false;//The page of the existing chunk is being moved too, a later GC of this page retries
+		}
+
+		deduplicator->GC_hash_no++;
+		if (pending) {
+			deduplicator->Remove_pending_chunk(metadata.FP);
+			deduplicator->GC_piggyback_no++;
+		} else {
+			deduplicator->Remove_skipped_chunk(metadata.FP);
+		}
+		if (!resolve_placeholder_chunk(stream_id, metadata.FP, fp, ppa, metadata.LPA)) {
+			return false;
+		}
+		if (pending) {
+			deduplicator->Background_merge_no++;
+		}
+		deduplicator->GC_merge_no++;
+		transaction->dedup_wr = true;
+
+		return true;
+	}
+
+	/*Background dedup remaps LPAs that are not being accessed by any user request, so their mapping entries may
+	* not be cached. Such entries are updated in GMT directly, as MQSim does for entries evicted from CMT.*/
+	void Address_Mapping_Unit_Page_Level::update_mapping_for_background_dedup(const stream_id_type stream_id, const LPA_type lpa, const PPA_type ppa)
+	{
+		AddressMappingDomain* domain = domains[stream_id];
+		if (domain->Mapping_entry_accessible(ideal_mapping_table, stream_id, lpa)) {
+			domain->Update_mapping_info(ideal_mapping_table, stream_id, lpa, ppa, domain->Get_page_status(ideal_mapping_table, stream_id, lpa));
+		} else {
+			domain->GlobalMappingTable[lpa].PPA = ppa;
+			domain->GlobalMappingTable[lpa].TimeStamp = CurrentTimeStamp;
+		}
+	}
+
+	/*Sub-page chunk dedup. The PMT entry of a chunk-mapped LPA holds CHUNK_MAPPED_PPA, and the chunk store of the domain maps
+	* each chunk of the LPA. The fingerprint index keeps the CID of a chunk in place of its PPA. A unique chunk waits in the
+	* packing buffer of the plane of its write, and the write that fills the buffer programs the whole page of chunks.
+	* Chunk pages are marked as shared (use_SMT) in their OOB area, so GC locks and moves them like shared pages.
+	* With compression, a unique chunk takes the sectors of its compressed content in the buffer, and GC repacks the live
+	* chunks of a partially valid page into the buffer of the plane instead of copying the page.*/
+	inline unsigned int Address_Mapping_Unit_Page_Level::get_plane_index(const NVM::FlashMemory::Physical_Page_Address& address)
+	{
+		return ((address.ChannelID * chip_no_per_channel + address.ChipID) * die_no_per_chip + address.DieID) * plane_no_per_die + address.PlaneID;
+	}
+
+	void Address_Mapping_Unit_Page_Level::bind_chunk_fingerprints(NVM_Transaction_Flash_WR* transaction)
+	{
+		Deduplicator* deduplicator = domains[transaction->Stream_id]->deduplicator;
+		if (transaction->FP_available) {
+			if (transaction->Chunk_FPs.size() == 0) {//A page-sized chunk, the host bound the page fingerprint
+				transaction->Chunk_FPs.push_back(transaction->FP);
+			}
+			return;
+		}
+		unsigned int sectors_per_chunk = deduplicator->Chunks->Get_sectors_per_chunk();
+		page_status_type chunk_mask = (((page_status_type)1) << sectors_per_chunk) - 1;
+		size_t chunk_no = 0;
+		for (unsigned int index = 0; index < deduplicator->Chunks->Get_chunks_per_page(); index++) {
+			if (((transaction->write_sectors_bitmap >> (index * sectors_per_chunk)) & chunk_mask) != 0) {
+				chunk_no++;
+			}
+		}
+		//The trace may carry the fingerprints of the first chunks only, the rest come from the fingerprint input
+		while (transaction->Chunk_FPs.size() < chunk_no) {
+			FP_type FP;
+			uint32_t compressed_size;
+			if (!deduplicator->Has_fingerprint_feed() || !deduplicator->Next_fingerprint(FP, compressed_size))
+				PRINT_ERROR("No fingerprint for a chunk of LPA " << transaction->LPA << ": the trace line has too few and the fingerprint input has run out!")
+			transaction->Compressed_sizes.resize(transaction->Chunk_FPs.size(), 0);
+			transaction->Chunk_FPs.push_back(FP);
+			transaction->Compressed_sizes.push_back(compressed_size);
+		}
+		transaction->FP_available = true;
+	}
+
+	//Sectors that a new chunk takes in flash, the whole chunk if its compressed size is unknown
+	unsigned int Address_Mapping_Unit_Page_Level::get_chunk_length(Chunk_Store* chunks, NVM_Transaction_Flash_WR* transaction, size_t fp_index)
+	{
+		unsigned int sectors_per_chunk = chunks->Get_sectors_per_chunk();
+		if (!chunks->Is_compressed() || transaction->Compressed_sizes.size() <= fp_index || transaction->Compressed_sizes[fp_index] == 0) {
+			return sectors_per_chunk;
+		}
+		unsigned int length = (transaction->Compressed_sizes[fp_index] + SECTOR_SIZE_IN_BYTE - 1) / SECTOR_SIZE_IN_BYTE;
+
+		return length > sectors_per_chunk ? sectors_per_chunk : length;
+	}
+
+	//The write programs the packing buffer of the plane into a newly allocated page
+	void Address_Mapping_Unit_Page_Level::program_chunk_buffer(NVM_Transaction_Flash_WR* transaction, unsigned int plane, bool is_for_gc)
+	{
+		stream_id_type stream_id = transaction->Stream_id;
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		Chunk_Store* chunks = deduplicator->Chunks;
+		const std::vector<CID_type>& buffer = chunks->Get_buffer(plane);
+		int reference_no = 0;
+		bool shared_data = false;
+		for (auto buffered_cid = buffer.begin(); buffered_cid != buffer.end(); buffered_cid++) {
+			size_t ref = deduplicator->Find_chunk(chunks->Get_chunk(*buffered_cid).FP)->ref;
+			reference_no += (int)ref;
+			shared_data = shared_data || ref > 1;
+		}
+
+		if (is_for_gc) {
+			block_manager->Allocate_block_and_page_in_plane_for_gc_write(stream_id, transaction->Address, shared_data);
+		} else {
+			block_manager->Allocate_block_and_page_in_plane_for_user_write(stream_id, transaction->Address);
+		}
+		transaction->PPA = Convert_address_to_ppa(transaction->Address);
+		RMEntryType RMEntry = { chunks->Get_chunk(buffer.front()).FP, transaction->LPA, NO_PPA, true, false };
+		chunks->Place_buffer(plane, transaction->PPA);
+		update_block_reference_stats(transaction->PPA, reference_no, 1);
+		Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(transaction->PPA, RMEntry));
+	}
+
+	void Address_Mapping_Unit_Page_Level::allocate_chunks_for_user_write(NVM_Transaction_Flash_WR* transaction)
+	{
+		stream_id_type stream_id = transaction->Stream_id;
+		AddressMappingDomain* domain = domains[stream_id];
+		Deduplicator* deduplicator = domain->deduplicator;
+		Chunk_Store* chunks = deduplicator->Chunks;
+		bind_chunk_fingerprints(transaction);
+
+		PPA_type old_ppa = domain->Get_ppa(ideal_mapping_table, stream_id, transaction->LPA);
+		page_status_type prev_page_status = domain->Get_page_status(ideal_mapping_table, stream_id, transaction->LPA);
+		if (old_ppa != NO_PPA && old_ppa != CHUNK_MAPPED_PPA) {//A page that was mapped as a whole, e.g., by preconditioning
+			NVM::FlashMemory::Physical_Page_Address addr;
+			Convert_ppa_to_address(old_ppa, addr);
+			invalidate_released_page(addr);
+		}
+
+		unsigned int sectors_per_chunk = chunks->Get_sectors_per_chunk();
+		page_status_type chunk_mask = (((page_status_type)1) << sectors_per_chunk) - 1;
+		unsigned int plane = get_plane_index(transaction->Address);
+		size_t fp_index = 0;
+		bool programmed = false;
+		PPA_type merge_ppa = NO_PPA;
+		page_status_type merge_bitmap = 0;
+		for (unsigned int index = 0; index < chunks->Get_chunks_per_page(); index++) {
+			page_status_type written_sectors = (transaction->write_sectors_bitmap >> (index * sectors_per_chunk)) & chunk_mask;
+			if (written_sectors == 0) {
+				continue;
+			}
+
+			//The unwritten sectors of a partially written chunk come from its old version, only one page is read for them
+			CID_type old_cid = chunks->Get_logical_chunk(transaction->LPA, index);
+			if (old_cid != NO_CHUNK && written_sectors != chunk_mask) {
+				deduplicator->Partial_chunk_write_no++;
+				Chunk_Entry& old_chunk = chunks->Get_chunk(old_cid);
+				if (old_chunk.PPA != NO_PPA && (merge_ppa == NO_PPA || merge_ppa == old_chunk.PPA)) {
+					merge_ppa = old_chunk.PPA;
+					if (chunks->Is_compressed()) {//The whole chunk is read to be decompressed
+						merge_bitmap |= chunks->Get_chunk_bitmap(old_cid);
+					} else {
+						merge_bitmap |= (chunk_mask & ~written_sectors) << old_chunk.Offset;
+					}
+				}
+			}
+
+			bool new_fp;
+			unsigned int length = get_chunk_length(chunks, transaction, fp_index);
+			const FP_type& FP = transaction->Chunk_FPs[fp_index++];
+			ChunkInfo* chunk = deduplicator->Find_or_insert_chunk(FP, new_fp);
+			CID_type cid;
+			if (new_fp) {
+				cid = chunks->Create_chunk(FP, length);
+				chunk->PPA = cid;
+				chunk->ref = 1;
+				deduplicator->Unique_chunk_sector_no += sectors_per_chunk;
+				deduplicator->Compressed_chunk_sector_no += length;
+				if (!chunks->Fits_in_buffer(cid, plane)) {//Only with compression: the rest of the buffer is too small, so it is programmed as is
+					if (programmed)
+						PRINT_ERROR("A chunk write has to program two pages of chunks!")
+					program_chunk_buffer(transaction, plane, false);
+					deduplicator->Chunk_page_program_no++;
+					programmed = true;
+				}
+				if (chunks->Buffer_chunk(cid, plane) && !programmed) {//The packing buffer holds a whole page, this write programs it
+					program_chunk_buffer(transaction, plane, false);
+					deduplicator->Chunk_page_program_no++;
+					programmed = true;
+				}
+			} else {//Found duplication
+				cid = (CID_type)chunk->PPA;
+				chunk->ref++;
+				if (chunks->Get_chunk(cid).PPA != NO_PPA) {
+					update_block_reference_stats(chunks->Get_chunk(cid).PPA, 1, 0);
+				}
+				deduplicator->Dup_chunk_no++;
+			}
+
+			chunks->Set_logical_chunk(transaction->LPA, index, cid);
+			if (old_cid != NO_CHUNK) {
+				release_chunk(stream_id, old_cid);
+			}
+			deduplicator->Total_chunk_no++;
+		}
+		domain->Update_mapping_info(ideal_mapping_table, stream_id, transaction->LPA, CHUNK_MAPPED_PPA, transaction->write_sectors_bitmap | prev_page_status);
+
+		if (merge_ppa != NO_PPA) {
+			deduplicator->Chunk_merge_read_no++;
+			if (programmed) {//The page program waits for the old sectors, as for an update read
+				NVM_Transaction_Flash_RD* merge_read = new NVM_Transaction_Flash_RD(transaction->Source, stream_id,
+					count_sector_no_from_status_bitmap(merge_bitmap) * SECTOR_SIZE_IN_BYTE, transaction->LPA, merge_ppa, transaction->UserIORequest,
+					transaction->Content, transaction, merge_bitmap, domain->GlobalMappingTable[transaction->LPA].TimeStamp);
+				Convert_ppa_to_address(merge_ppa, merge_read->Address);
+				block_manager->Read_transaction_issued(merge_read->Address);
+				update_read++;
+				transaction->RelatedRead = merge_read;
+			} else {//The merged chunk waits in the packing buffer
+				issue_chunk_read(stream_id, transaction->LPA, merge_ppa, merge_bitmap);
+			}
+		}
+		transaction->dedup_wr = !programmed;
+	}
+
+	void Address_Mapping_Unit_Page_Level::release_chunk(const stream_id_type stream_id, const CID_type cid)
+	{
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		Chunk_Entry& entry = deduplicator->Chunks->Get_chunk(cid);
+		ChunkInfo* chunk = deduplicator->Find_chunk(entry.FP);
+		if (chunk == NULL)
+			PRINT_ERROR("This chunk is not in Fingerprint Table")
+		chunk->ref--;
+		if (entry.PPA != NO_PPA) {
+			update_block_reference_stats(entry.PPA, -1, 0);
+		}
+		if (chunk->ref > 0) {
+			return;
+		}
+
+		deduplicator->Remove_chunk(entry.FP);
+		if (entry.Buffer != NO_BUFFER) {
+			deduplicator->Chunks->Unbuffer_chunk(cid);
+		} else {
+			PPA_type ppa = entry.PPA;
+			if (deduplicator->Chunks->Remove_chunk_from_page(cid)) {//No live chunk is left in the page
+				flash_page_ID_type page_id;
+				Block_Pool_Slot_Type* block = get_page_block(ppa, page_id);
+				block_manager->uncount_page_metadata(block, block->OOB[page_id]);
+				block->OOB[page_id].status = true;
+				block_manager->count_page_metadata(block, block->OOB[page_id]);
+				update_block_reference_stats(ppa, 0, -1);
+				NVM::FlashMemory::Physical_Page_Address addr;
+				Convert_ppa_to_address(ppa, addr);
+				invalidate_released_page(addr);
+			}
+		}
+		deduplicator->Chunks->Free_chunk(cid);
+	}
+
+	void Address_Mapping_Unit_Page_Level::move_chunk_page_for_gc(NVM_Transaction_Flash_WR* transaction)
+	{
+		stream_id_type stream_id = transaction->Stream_id;
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		Chunk_Store* chunks = deduplicator->Chunks;
+		PPA_type source_ppa = Convert_address_to_ppa(transaction->Address);
+		OOBEntryType* source_page = Get_page_metadata(source_ppa);
+		if (source_page == NULL || !source_page->Has_metadata() || chunks->Get_live_chunk_no(source_ppa) == 0)
+			PRINT_ERROR("Unexpected chunk store status in move_chunk_page_for_gc for a GC/WL write!")
+		block_manager->Invalidate_page_in_block(stream_id, transaction->Address);
+
+		//A partially valid page of compressed chunks is compacted: its live chunks join the packing buffer of the plane,
+		//and the GC write only programs if the buffer is full, otherwise GC completes it without flash access
+		if (chunks->Is_compressed() && transaction->ExecutionMode != WriteExecutionModeType::COPYBACK
+			&& chunks->Get_live_sector_no(source_ppa) < sector_no_per_page) {
+			int source_reference_no = 0;
+			std::vector<CID_type> live_cids;
+			chunks->Take_page_chunks(source_ppa, live_cids);
+			for (auto cid = live_cids.begin(); cid != live_cids.end(); cid++) {
+				source_reference_no += (int)deduplicator->Find_chunk(chunks->Get_chunk(*cid).FP)->ref;
+			}
+			update_block_reference_stats(source_ppa, -source_reference_no, -1);
+
+			unsigned int plane = get_plane_index(transaction->Address);
+			bool programmed = false;
+			for (auto cid = live_cids.begin(); cid != live_cids.end(); cid++) {
+				if (!chunks->Fits_in_buffer(*cid, plane)) {
+					if (programmed)
+						PRINT_ERROR("A GC write has to program two pages of chunks!")
+					program_chunk_buffer(transaction, plane, true);
+					programmed = true;
+				}
+				if (chunks->Buffer_chunk(*cid, plane) && !programmed) {
+					program_chunk_buffer(transaction, plane, true);
+					programmed = true;
+				}
+			}
+			if (programmed) {
+				deduplicator->GC_page_write_no++;
+			}
+			deduplicator->GC_compacted_page_no++;
+			deduplicator->GC_compacted_chunk_no += live_cids.size();
+			transaction->dedup_wr = !programmed;
+			return;
+		}
+
+		int reference_no = 0;
+		bool shared_data = false;
+		for (unsigned int slot = 0; slot < chunks->Get_slots_per_page(); slot++) {
+			CID_type cid = chunks->Get_page_chunk(source_ppa, slot);
+			if (cid != NO_CHUNK) {
+				size_t ref = deduplicator->Find_chunk(chunks->Get_chunk(cid).FP)->ref;
+				reference_no += (int)ref;
+				shared_data = shared_data || ref > 1;
+			}
+		}
+
+		RMEntryType metadata;
+		Get_metadata_from_ReverseMapping(source_ppa, metadata);
+		block_manager->Allocate_block_and_page_in_plane_for_gc_write(stream_id, transaction->Address, shared_data);
+		transaction->PPA = Convert_address_to_ppa(transaction->Address);
+		chunks->Move_page(source_ppa, transaction->PPA);
+		update_block_reference_stats(source_ppa, -reference_no, -1);
+		update_block_reference_stats(transaction->PPA, reference_no, 1);
+		RMEntryType RMEntry = { metadata.FP, metadata.LPA, NO_PPA, true, false };
+		Update_ReverseMapping(std::pair<PPA_type, RMEntryType>(transaction->PPA, RMEntry));
+		deduplicator->GC_page_write_no++;
+		if (shared_data) {
+			deduplicator->GC_shared_page_write_no++;
+		}
+	}
+
+	PPA_type Address_Mapping_Unit_Page_Level::translate_chunks_for_read(const stream_id_type stream_id, NVM_Transaction_Flash_RD* transaction)
+	{
+		Deduplicator* deduplicator = domains[stream_id]->deduplicator;
+		Chunk_Store* chunks = deduplicator->Chunks;
+		unsigned int sectors_per_chunk = chunks->Get_sectors_per_chunk();
+		page_status_type chunk_mask = (((page_status_type)1) << sectors_per_chunk) - 1;
+
+		//The first page that holds a requested chunk is read by the transaction itself, each other page by a fragment read
+		PPA_type primary_ppa = NO_PPA;
+		std::vector<std::pair<PPA_type, page_status_type>> fragments;
+		for (unsigned int index = 0; index < chunks->Get_chunks_per_page(); index++) {
+			if (((transaction->read_sectors_bitmap >> (index * sectors_per_chunk)) & chunk_mask) == 0) {
+				continue;
+			}
+			CID_type cid = chunks->Get_logical_chunk(transaction->LPA, index);
+			if (cid == NO_CHUNK) {
+				continue;
+			}
+			Chunk_Entry& entry = chunks->Get_chunk(cid);
+			if (entry.PPA == NO_PPA) {//Served from the packing buffer in DRAM
+				deduplicator->Buffered_chunk_read_no++;
+				continue;
+			}
+			if (primary_ppa == NO_PPA || entry.PPA == primary_ppa) {
+				primary_ppa = entry.PPA;
+				continue;
+			}
+			page_status_type slot_bitmap = chunks->Get_chunk_bitmap(cid);
+			auto fragment = fragments.begin();
+			while (fragment != fragments.end() && fragment->first != entry.PPA) {
+				fragment++;
+			}
+			if (fragment == fragments.end()) {
+				fragments.push_back(std::pair<PPA_type, page_status_type>(entry.PPA, slot_bitmap));
+			} else {
+				fragment->second |= slot_bitmap;
+			}
+		}
+
+		for (auto fragment = fragments.begin(); fragment != fragments.end(); fragment++) {
+			issue_chunk_read(stream_id, transaction->LPA, fragment->first, fragment->second);
+			deduplicator->Fragment_read_no++;
+		}
+		if (primary_ppa == NO_PPA) {//Nothing to read from flash
+			return online_create_entry_for_reads(transaction->LPA, stream_id, transaction->Address, transaction->read_sectors_bitmap);
+		}
+
+		return primary_ppa;
+	}
+
+	void Address_Mapping_Unit_Page_Level::issue_chunk_read(const stream_id_type stream_id, const LPA_type lpa, const PPA_type ppa, const page_status_type read_sectors_bitmap)
+	{
+		NVM_Transaction_Flash_RD* readTR = new NVM_Transaction_Flash_RD(Transaction_Source_Type::MAPPING, stream_id, count_sector_no_from_status_bitmap(read_sectors_bitmap) * SECTOR_SIZE_IN_BYTE,
+			lpa, ppa, NULL, 0, NULL, read_sectors_bitmap, CurrentTimeStamp);
+		Convert_ppa_to_address(ppa, readTR->Address);
+		block_manager->Read_transaction_issued(readTR->Address);//Inform block_manager as soon as the transaction's target address is determined
+		domains[stream_id]->Chunk_reads.insert(readTR);
+		ftl->TSU->Prepare_for_transaction_submit();
+		ftl->TSU->Submit_transaction(readTR);
+		ftl->TSU->Schedule();
+	}
+
+	inline void Address_Mapping_Unit_Page_Level::handle_transaction_serviced_signal_from_PHY(NVM_Transaction_Flash* transaction)
+	{
+		//First check if the transaction source is Mapping Module
+		if (transaction->Source != Transaction_Source_Type::MAPPING) {
+			return;
+		}
+
+		//** Append for CAFTL, pending chunks are read back for out-of-line dedup even if the mapping table is ideal
+		AddressMappingDomain* domain = _my_instance->domains[transaction->Stream_id];
+		if (transaction->Type == Transaction_Type::READ && domain->Background_dedup_reads.size() > 0) {
+			auto background_read = domain->Background_dedup_reads.find(transaction);
+			if (background_read != domain->Background_dedup_reads.end()) {
+				FP_type placeholder = background_read->second;
+				domain->Background_dedup_reads.erase(background_read);
+				_my_instance->ftl->Fingerprint_engine->Submit_background_job(transaction->Stream_id, placeholder);
+				return;
+			}
+		}
+		if (transaction->Type == Transaction_Type::READ && domain->Verify_reads.size() > 0) {
+			auto verify_read = domain->Verify_reads.find(transaction);
+			if (verify_read != domain->Verify_reads.end()) {//The matched page is in the controller, so the duplicate write is done
+				domain->deduplicator->Verify_time += Simulator->Time() - transaction->Issue_time;
+				Simulator->Register_sim_event(Simulator->Time(), _my_instance, verify_read->second, (int)Address_Mapping_Event_Type::DUPLICATE_WRITE_SERVICED);
+				domain->Verify_reads.erase(verify_read);
+				return;
+			}
+		}
+		if (transaction->Type == Transaction_Type::READ && domain->Chunk_reads.erase(transaction) > 0) {
+			return;//The data of a sub-page chunk is in the controller now
+		}
+
+		//** Append for CAFTL, fingerprint bucket pages are accessed even if the mapping table is ideal
+		MVPN_type accessed_mvpn = (MVPN_type)(transaction->Type == Transaction_Type::WRITE ? ((NVM_Transaction_Flash_WR*)transaction)->Content : ((NVM_Transaction_Flash_RD*)transaction)->Content);
+		if (_my_instance->is_fingerprint_bucket(transaction->Stream_id, accessed_mvpn)) {
+			_my_instance->handle_fingerprint_bucket_serviced(transaction);
+			return;
+		}
+		if (_my_instance->is_smt_page(transaction->Stream_id, accessed_mvpn)) {
+			_my_instance->handle_smt_page_serviced(transaction);
+			return;
+		}
+
+		if (_my_instance->ideal_mapping_table){
+			throw std::logic_error("There should not be any flash read/write when ideal mapping is enabled!");
+		}
+
+		if (transaction->Type == Transaction_Type::WRITE) {
+			_my_instance->domains[transaction->Stream_id]->DepartingMappingEntries.erase((MVPN_type)((NVM_Transaction_Flash_WR*)transaction)->Content);
+		} else {
+			/*If this is a read for an MVP that is required for merging unchanged mapping enries
+			* (stored on flash) with those updated entries that are evicted from CMT*/
+			if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite != NULL) {
+				((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
+			}
+
+			_my_instance->ftl->TSU->Prepare_for_transaction_submit();
+			MVPN_type mvpn = (MVPN_type)((NVM_Transaction_Flash_RD*)transaction)->Content;
+			std::multimap<MVPN_type, LPA_type>::iterator it = _my_instance->domains[transaction->Stream_id]->ArrivingMappingEntries.find(mvpn);
+			while (it != _my_instance->domains[transaction->Stream_id]->ArrivingMappingEntries.end()) {
+				if ((*it).first == mvpn) {
+					LPA_type lpa = (*it).second;
+
+					//This mapping entry may arrived due to an update read request that is required for merging new and old mapping entries.
+					//If that is the case, we should not insert it into CMT
+					if (_my_instance->domains[transaction->Stream_id]->CMT->Is_slot_reserved_for_lpn_and_waiting(transaction->Stream_id, lpa)) {
+						_my_instance->domains[transaction->Stream_id]->CMT->Insert_new_mapping_info(transaction->Stream_id, lpa,
+							_my_instance->domains[transaction->Stream_id]->GlobalMappingTable[lpa].PPA,
+							_my_instance->domains[transaction->Stream_id]->GlobalMappingTable[lpa].WrittenStateBitmap);
 						auto it2 = _my_instance->domains[transaction->Stream_id]->Waiting_unmapped_read_transactions.find(lpa);
 						while (it2 != _my_instance->domains[transaction->Stream_id]->Waiting_unmapped_read_transactions.end() &&
 							(*it2).first == lpa) {
@@ -2219,9 +3900,13 @@ namespace SSD_Components
 								_my_instance->manage_user_transaction_facing_barrier(it2->second);
 							} else {
 								if (_my_instance->translate_lpa_to_ppa(transaction->Stream_id, it2->second)) {
-									_my_instance->ftl->TSU->Submit_transaction(it2->second);
-									if (((NVM_Transaction_Flash_WR*)it2->second)->RelatedRead != NULL) {
-										_my_instance->ftl->TSU->Submit_transaction(((NVM_Transaction_Flash_WR*)it2->second)->RelatedRead);
+									if (!((NVM_Transaction_Flash_WR*)it2->second)->dedup_wr) {//** Append for CAFTL: a duplicate is not programmed
+										_my_instance->ftl->TSU->Submit_transaction(it2->second);
+										if (((NVM_Transaction_Flash_WR*)it2->second)->RelatedRead != NULL) {
+											_my_instance->ftl->TSU->Submit_transaction(((NVM_Transaction_Flash_WR*)it2->second)->RelatedRead);
+										}
+									} else {
+										_my_instance->complete_duplicate_write((NVM_Transaction_Flash_WR*)it2->second);
 									}
 								} else {
 									_my_instance->mange_unsuccessful_translation(it2->second);
@@ -2299,9 +3984,9 @@ namespace SSD_Components
 
 					//code
 					ppa = domains[block->Stream_id]->GlobalMappingTable[lpa].PPA;
-					if (In_SMT(ppa)) {
+					if (domains[block->Stream_id]->deduplicator->In_SMT(ppa)) {
 						VPA_type VPA = domains[block->Stream_id]->GlobalMappingTable[lpa].PPA;
-						ppa = Get_SMTEntry(VPA).PPA;
+						ppa = domains[block->Stream_id]->deduplicator->Get_SMTEntry(VPA).PPA;
 					}
 					else {
 						ppa = domains[block->Stream_id]->GlobalMappingTable[lpa].PPA;
@@ -2312,12 +3997,16 @@ namespace SSD_Components
 						ppa = domains[block->Stream_id]->CMT->Retrieve_ppa(block->Stream_id, lpa);
 					}
 
-					if (ppa != Convert_address_to_ppa(addr)) {
+					if (!metadata.use_SMT && ppa != Convert_address_to_ppa(addr)) {
  						//domains[block->Stream_id]->Print_Mappings_Detail();
 						PRINT_ERROR("Inconsistency in the global mapping table when locking an LPA!")
 					}
 					
-					Set_barrier_for_accessing_lpa(block->Stream_id, lpa);
+					//The LPA in the OOB area of a shared page may have been remapped to a page of another victim block, so the lock is counted
+					if (metadata.use_SMT || is_lpa_locked_for_gc(block->Stream_id, lpa))
+						domains[block->Stream_id]->Locked_LPAs.insert(lpa);
+					else
+						Set_barrier_for_accessing_lpa(block->Stream_id, lpa);
 				}
 			}
 		}
@@ -2333,24 +4022,29 @@ namespace SSD_Components
 			return;
 		}
 		domains[stream_id]->Locked_LPAs.erase(itr);
+		if (domains[stream_id]->Locked_LPAs.find(lpa) != domains[stream_id]->Locked_LPAs.end())//** Append for CAFTL, another GC still moves a page that carries this LPA
+			return;
 
-		//If there are read requests waiting behind the barrier, then MQSim assumes they can be serviced with the actual page data that is accessed during GC execution
+		//** Modified for CAFTL: the user transactions waiting behind the barrier are dispatched again. A write carries new data, and
+		//its fingerprint, that GC has not moved, and completing the transactions here never informed their user requests.
+		std::list<NVM_Transaction*> waiting_transactions;
 		auto read_tr = domains[stream_id]->Read_transactions_behind_LPA_barrier.find(lpa);
 		while (read_tr != domains[stream_id]->Read_transactions_behind_LPA_barrier.end()) {
-			handle_transaction_serviced_signal_from_PHY((*read_tr).second);
-			delete (*read_tr).second;
+			waiting_transactions.push_back((*read_tr).second);
 			domains[stream_id]->Read_transactions_behind_LPA_barrier.erase(read_tr);
 			read_tr = domains[stream_id]->Read_transactions_behind_LPA_barrier.find(lpa);
 		}
 
-		//If there are write requests waiting behind the barrier, then MQSim assumes they can be serviced with the actual page data that is accessed during GC execution. This may not be 100% true for all write requests, but, to avoid more complexity in the simulation, we accept this assumption.
 		auto write_tr = domains[stream_id]->Write_transactions_behind_LPA_barrier.find(lpa);
 		while (write_tr != domains[stream_id]->Write_transactions_behind_LPA_barrier.end()) {
-			handle_transaction_serviced_signal_from_PHY((*write_tr).second);
-			delete (*write_tr).second;
+			waiting_transactions.push_back((*write_tr).second);
 			domains[stream_id]->Write_transactions_behind_LPA_barrier.erase(write_tr);
 			write_tr = domains[stream_id]->Write_transactions_behind_LPA_barrier.find(lpa);
 		}
+
+		if (waiting_transactions.size() > 0) {
+			Translate_lpa_to_ppa_and_dispatch(waiting_transactions);
+		}
 	}
 
 	inline void Address_Mapping_Unit_Page_Level::Remove_barrier_for_accessing_mvpn(stream_id_type stream_id, MVPN_type mvpn)
@@ -2373,8 +4067,15 @@ namespace SSD_Components
 					SECTOR_SIZE_IN_BYTE, NO_LPA, NO_PPA, NULL, mvpn, ((page_status_type)0x1) << sector_no_per_page, CurrentTimeStamp);
 			Convert_ppa_to_address(ppn, readTR->Address);
 			readTR->PPA = ppn;
-			Stats::Total_flash_reads_for_mapping++;
-			Stats::Total_flash_reads_for_mapping_per_stream[stream_id]++;
+			if (is_fingerprint_bucket(stream_id, mvpn)) {//** Append for CAFTL
+				domains[stream_id]->deduplicator->FP_bucket_reads++;
+			} else if (is_smt_page(stream_id, mvpn)) {
+				Stats::Total_flash_reads_for_SMT++;
+				Stats::Total_flash_reads_for_SMT_per_stream[stream_id]++;
+			} else {
+				Stats::Total_flash_reads_for_mapping++;
+				Stats::Total_flash_reads_for_mapping_per_stream[stream_id]++;
+			}
 
 			handle_transaction_serviced_signal_from_PHY(readTR);
 			
@@ -2389,7 +4090,9 @@ namespace SSD_Components
 			page_status_type readSectorsBitmap = 0;
 			LPA_type start_lpn = get_start_LPN_in_MVP(mvpn);
 			LPA_type end_lpn = get_end_LPN_in_MVP(mvpn);
-			for (LPA_type lpn_itr = start_lpn; lpn_itr <= end_lpn; lpn_itr++) {
+			bool fingerprint_bucket = is_fingerprint_bucket(stream_id, mvpn);//** Append for CAFTL
+			bool smt_page = is_smt_page(stream_id, mvpn);
+			for (LPA_type lpn_itr = start_lpn; lpn_itr <= end_lpn && !fingerprint_bucket && !smt_page; lpn_itr++) {
 				if (domains[stream_id]->CMT->Exists(stream_id, lpn_itr)) {
 					if (domains[stream_id]->CMT->Is_dirty(stream_id, lpn_itr)) {
 						domains[stream_id]->CMT->Make_clean(stream_id, lpn_itr);
@@ -2408,10 +4111,20 @@ namespace SSD_Components
 			NVM_Transaction_Flash_WR* writeTR = new NVM_Transaction_Flash_WR(Transaction_Source_Type::MAPPING, stream_id, SECTOR_SIZE_IN_BYTE * sector_no_per_page,
 				mvpn, mppn, NULL, mvpn, NULL, (((page_status_type)0x1) << sector_no_per_page) - 1, CurrentTimeStamp);
 
-			Stats::Total_flash_reads_for_mapping++;
-			Stats::Total_flash_writes_for_mapping++;
-			Stats::Total_flash_reads_for_mapping_per_stream[stream_id]++;
-			Stats::Total_flash_writes_for_mapping_per_stream[stream_id]++;
+			if (fingerprint_bucket) {
+				domains[stream_id]->deduplicator->FP_bucket_reads++;
+				domains[stream_id]->deduplicator->FP_bucket_writes++;
+			} else if (smt_page) {
+				Stats::Total_flash_reads_for_SMT++;
+				Stats::Total_flash_writes_for_SMT++;
+				Stats::Total_flash_reads_for_SMT_per_stream[stream_id]++;
+				Stats::Total_flash_writes_for_SMT_per_stream[stream_id]++;
+			} else {
+				Stats::Total_flash_reads_for_mapping++;
+				Stats::Total_flash_writes_for_mapping++;
+				Stats::Total_flash_reads_for_mapping_per_stream[stream_id]++;
+				Stats::Total_flash_writes_for_mapping_per_stream[stream_id]++;
+			}
 
 			handle_transaction_serviced_signal_from_PHY(writeTR);
 
@@ -2452,9 +4165,13 @@ namespace SSD_Components
 		auto program = waiting_write_list.begin();
 		while (program != waiting_write_list.end()) {
 			if (translate_lpa_to_ppa((*program)->Stream_id, *program)) {
-				ftl->TSU->Submit_transaction(*program);
-				if ((*program)->RelatedRead != NULL) {
-					ftl->TSU->Submit_transaction((*program)->RelatedRead);
+				if (!(*program)->dedup_wr) {//** Append for CAFTL: a duplicate is not programmed
+					ftl->TSU->Submit_transaction(*program);
+					if ((*program)->RelatedRead != NULL) {
+						ftl->TSU->Submit_transaction((*program)->RelatedRead);
+					}
+				} else {
+					complete_duplicate_write(*program);
 				}
 				waiting_write_list.erase(program++);
 			}
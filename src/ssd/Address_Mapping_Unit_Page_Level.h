@@ -6,17 +6,21 @@
 #include <queue>
 #include <set>
 #include <list>
+#include <vector>
 #include "Address_Mapping_Unit_Base.h"
 #include "Flash_Block_Manager_Base.h"
 #include "SSD_Defs.h"
 #include "NVM_Transaction_Flash_RD.h"
 #include "NVM_Transaction_Flash_WR.h"
+#include "Deduplicator.h"
 
 namespace SSD_Components
 {
 #define MAKE_TABLE_INDEX(LPN,STREAM)
+#define CHUNK_MAPPED_PPA (NO_PPA - 1)//** Append for CAFTL: PMT marker of an LPA whose chunks are mapped by the chunk store of its domain
 
 	enum class CMTEntryStatus {FREE, WAITING, VALID};
+	enum class Address_Mapping_Event_Type { DUPLICATE_WRITE_SERVICED, GC_LPA_RELEASED };//** Append for CAFTL
 
 	struct GTDEntryType //Entry type for the Global Translation Directory
 	{
@@ -41,20 +45,7 @@ namespace SSD_Components
 		data_timestamp_type TimeStamp;
 	};
 	
-	//** GMT equals to Primary Mapping Table in CAFTL
-	//** CAFTL maintains SMT (Secondary Mapping Table) for VPN-to-PPN mapping
-	struct SMTEntryType//** Append for CAFTL
-	{
-		PPA_type PPA;
-	};
-
-	struct ChunkInfo//** Append for CAFTL
-	{
-		PPA_type PPA;
-		size_t ref;//number of this chunk appear
-	}; 
-
-	struct RMEntryType//** Append for CAFTL reverse mapping, it replaces metadata in OOB
+	struct RMEntryType//** Append for CAFTL reverse mapping, a copy of the OOB metadata of a page with its fingerprint resolved
 	{
 		FP_type FP;
 		LPA_type LPA;
@@ -63,40 +54,6 @@ namespace SSD_Components
 		bool status;
 	};
 
-	class Deduplicator//** Append for CAFTL
-	{
-	public:
-		Deduplicator();
-		~Deduplicator();
-		void Update_FPtable(const std::pair<FP_type, ChunkInfo> &FP_entry);
-		void Print_FPtable();
-		bool In_FPtable(const FP_type &FP);//** Check if this FP exists in hash table
-		ChunkInfo GetChunkInfo(const FP_type &FP);
-		float Get_DedupRate();
-		size_t Get_FPtable_size();
-
-		size_t Total_chunk_no;//total chunk(page), including unique and deduped chunks
-		size_t Dup_chunk_no;//discarded chunks
-		
-	private: 
-		std::unordered_map<FP_type, ChunkInfo> FPtable;
-		float Dedup_rate;
-	};
-
-	static std::map<PPA_type, RMEntryType> ReverseMapping;//** Simplify read operation for metadata in OOB e.g., FP by using <PPA, FP> structure to update FP table
-	void Update_ReverseMapping(const std::pair<PPA_type, RMEntryType> &cur_rev_pair);
-	void Delete_ReverseMapping(const PPA_type &target_ppa);
-	void Print_ReverseMapping();
-	void Get_metadata_from_ReverseMapping(const PPA_type &moving_ppa, RMEntryType &metadata);
-	void Get_LPA_from_ReverseMapping(const PPA_type &target_ppa, LPA_type &LPA);
-
-	static std::map<VPA_type, SMTEntryType> SecondaryMappingTable;//** For CAFTL 2-level mapping while GMT as Primary Mapping Table in CAFTL. It should be inserted as pair <VPA, PPA>
-
-	void Print_SMT();
-	bool In_SMT(VPA_type VPA);
-	SMTEntryType Get_SMTEntry(VPA_type VPA);
-	void Update_SMT(const std::pair<VPA_type, SMTEntryType> &cur_SMT_pair);
-
 	/* Latency (microsecond) */
 	const float page_FP_latency = 6.4;
 	const float page_write_latency = 200;
@@ -121,6 +78,8 @@ namespace SSD_Components
 		
 		bool Is_dirty(const stream_id_type streamID, const LPA_type lpa);
 		void Make_clean(const stream_id_type streamID, const LPA_type lpa);
+		void Save_checkpoint(Checkpoint_Writer& writer);//** Append for CAFTL, the slots in LRU order
+		void Load_checkpoint(Checkpoint_Reader& reader);
 
 		void Print_CMT() {//for observation
 			std::cout << "========== Print simple CMT =================\n";
@@ -144,6 +103,18 @@ namespace SSD_Components
 		int GMT_write_count;
 	};
 
+	struct Dedup_Epoch_Record//** Append for CAFTL: dedup state of a stream at the end of a logging epoch
+	{
+		sim_time_type Time;
+		size_t Chunk_no;
+		size_t Dup_chunk_no;
+		size_t FP_table_size;
+		size_t SMT_size;
+		size_t Live_reverse_entry_no;
+		size_t Invalid_reverse_entry_no;
+		double Hash_engine_utilization;
+	};
+
 	/* Each stream has its own address mapping domain. It helps isolation of GC interference
 	* (e.g., multi-streamed SSD HotStorage 2014, and OPS isolation in FAST 2015)
 	* However, CMT is shared among concurrent streams in two ways: 1) each address mapping domain
@@ -158,7 +129,11 @@ namespace SSD_Components
 			Flash_Plane_Allocation_Scheme_Type PlaneAllocationScheme,
 			flash_channel_ID_type* channel_ids, unsigned int channel_no, flash_chip_ID_type* chip_ids, unsigned int chip_no,
 			flash_die_ID_type* die_ids, unsigned int die_no, flash_plane_ID_type* plane_ids, unsigned int plane_no,
-			PPA_type total_physical_sectors_no, LHA_type total_logical_sectors_no, unsigned int sectors_no_per_page);
+			PPA_type total_physical_sectors_no, LHA_type total_logical_sectors_no, unsigned int sectors_no_per_page,
+			const std::string& fingerprint_file_path, unsigned int fp_cache_capacity, FP_Cache_Replacement_Policy fp_cache_replacement_policy,
+			unsigned int dedup_sampling_unit, Dedup_Sampling_Rule dedup_sampling_rule, bool dedup_prehash_enabled, Dedup_Mode dedup_mode,
+			unsigned int fp_entries_per_bucket_page, unsigned int smt_cache_capacity, SMT_Cache_Replacement_Policy smt_cache_replacement_policy,
+			unsigned int smt_entries_per_page);
 		~AddressMappingDomain();
 
 		/*Stores the mapping of Virtual Translation Page Number (MVPN) to Physical Translation Page Number (MPPN).
@@ -186,7 +161,7 @@ namespace SSD_Components
 		std::multimap<LPA_type, NVM_Transaction_Flash*> Waiting_unmapped_program_transactions;
 		std::multimap<MVPN_type, LPA_type> ArrivingMappingEntries;
 		std::set<MVPN_type> DepartingMappingEntries;
-		std::set<LPA_type> Locked_LPAs;//Used to manage race conditions, i.e. a user request accesses and LPA while GC is moving that LPA 
+		std::multiset<LPA_type> Locked_LPAs;//Used to manage race conditions, i.e. a user request accesses and LPA while GC is moving that LPA (** Append for CAFTL: a multiset, since shared pages in several victim blocks may carry the same LPA)
 		std::set<MVPN_type> Locked_MVPNs;//Used to manage race conditions
 		std::multimap<LPA_type, NVM_Transaction_Flash*> Read_transactions_behind_LPA_barrier;
 		std::multimap<LPA_type, NVM_Transaction_Flash*> Write_transactions_behind_LPA_barrier;
@@ -213,22 +188,31 @@ namespace SSD_Components
 		Deduplicator *deduplicator;
 		Simple_Cached_Mapping_Table *simpleCMT;
 
+		/*With a bounded fingerprint cache, the fingerprint table is persisted in bucket pages on flash. Bucket pages are
+		* addressed as translation virtual pages that follow the last MVPN of the mapping table, so the GTD locates them
+		* and GC relocates them like any other translation page.*/
+		MVPN_type FP_bucket_base_MVPN;
+		MVPN_type FP_bucket_no;
+		std::multimap<MVPN_type, NVM_Transaction_Flash*> Waiting_fingerprint_lookup_transactions;//User writes waiting for their fingerprint bucket to be read
+		std::set<MVPN_type> ArrivingFingerprintBuckets;
+		/*With a bounded SMT cache, the Secondary Mapping Table is persisted in SMT pages that follow the fingerprint buckets*/
+		MVPN_type SMT_page_base_MVPN;
+		MVPN_type SMT_page_no;
+		std::multimap<MVPN_type, NVM_Transaction_Flash*> Waiting_SMT_lookup_transactions;//User reads of shared pages waiting for their SMT page to be read
+		std::set<MVPN_type> ArrivingSMTPages;
+		std::map<NVM_Transaction_Flash*, FP_type> Background_dedup_reads;//** Append for CAFTL: flash reads of pending chunks -> their placeholders
+		std::map<NVM_Transaction_Flash*, NVM_Transaction_Flash_WR*> Verify_reads;//** Append for CAFTL: flash reads of matched pages -> the duplicate writes they verify
+		std::set<NVM_Transaction_Flash*> Chunk_reads;//** Append for CAFTL: merge and fragment reads of sub-page chunks
+
 		void Print_Mappings_Detail() {
 			deduplicator->Print_FPtable();
 			Print_PMT();
-			Print_SMT();
-			Print_ReverseMapping();
+			deduplicator->Print_SMT();
 		}
 
-		std::ifstream fp_input_file;//** Append for CAFTL fp input
-		FP_type cur_fp;//** Record current fp
-		size_t Total_fp_no;//** Total number of fingerprints by trace
-
-
-		size_t Total_page_write_no;//** partial and full write, including GC write 
-		size_t GC_page_write_no;
-
-		std::ofstream DedupOutputFile;
+		std::vector<Dedup_Epoch_Record> Dedup_epochs;//** Append for CAFTL: time series of the dedup state, one record per logging epoch
+		void Save_checkpoint(Checkpoint_Writer& writer);//** Append for CAFTL: mapping tables and dedup tables, the CMT is saved by the mapping unit
+		void Load_checkpoint(Checkpoint_Reader& reader);
 	};
 
 	class Address_Mapping_Unit_Page_Level : public Address_Mapping_Unit_Base
@@ -242,7 +226,12 @@ namespace SSD_Components
 			std::vector<std::vector<flash_channel_ID_type>> stream_channel_ids, std::vector<std::vector<flash_chip_ID_type>> stream_chip_ids,
 			std::vector<std::vector<flash_die_ID_type>> stream_die_ids, std::vector<std::vector<flash_plane_ID_type>> stream_plane_ids,
 			unsigned int Block_no_per_plane, unsigned int Page_no_per_block, unsigned int SectorsPerPage, unsigned int PageSizeInBytes,
-			double Overprovisioning_ratio, CMT_Sharing_Mode sharing_mode = CMT_Sharing_Mode::SHARED, bool fold_large_addresses = true);
+			double Overprovisioning_ratio, std::vector<std::string> stream_fingerprint_file_paths,
+			unsigned int fp_cache_capacity_in_byte, FP_Cache_Replacement_Policy fp_cache_replacement_policy,
+			unsigned int fp_filter_size_in_byte, unsigned int fp_filter_hash_no, sim_time_type fp_filter_probe_time,
+			unsigned int smt_cache_capacity_in_byte, SMT_Cache_Replacement_Policy smt_cache_replacement_policy,
+			unsigned int dedup_sampling_unit, Dedup_Sampling_Rule dedup_sampling_rule, bool dedup_prehash_enabled, Dedup_Mode dedup_mode,
+			unsigned int dedup_chunk_size_in_byte, bool compression_enabled, bool dedup_verify_enabled, bool global_dedup_enabled, bool gc_dedup_enabled, sim_time_type dedup_logging_period, CMT_Sharing_Mode sharing_mode = CMT_Sharing_Mode::SHARED, bool fold_large_addresses = true);
 		~Address_Mapping_Unit_Page_Level();
 		void Setup_triggers();
 		void Start_simulation();
@@ -271,6 +260,21 @@ namespace SSD_Components
 		void Remove_barrier_for_accessing_mvpn(stream_id_type stream_id, MVPN_type mpvn);
 		void Start_servicing_writes_for_overfull_plane(const NVM::FlashMemory::Physical_Page_Address plane_address);
 
+		Deduplicator* Get_deduplicator(const stream_id_type stream_id);//** Append for CAFTL
+		unsigned int Issue_background_dedup_reads(unsigned int max_read_no, bool& deferred);//** Append for CAFTL
+		void Merge_pending_chunk(const stream_id_type stream_id, const FP_type& placeholder);//** Append for CAFTL
+		void Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter);//** Append for CAFTL
+		void Save_checkpoint(Checkpoint_Writer& writer);//** Append for CAFTL
+		void Load_checkpoint(Checkpoint_Reader& reader);
+
+		//** Append for CAFTL reverse mapping, it is kept in the OOB area of each physical page (see Block_Pool_Slot_Type::OOB)
+		OOBEntryType* Get_page_metadata(const PPA_type ppa);//NULL for VPAs and out of range addresses
+		void Update_ReverseMapping(const std::pair<PPA_type, RMEntryType> &cur_rev_pair);
+		void Delete_ReverseMapping(const PPA_type &target_ppa);
+		void Print_ReverseMapping();
+		void Get_metadata_from_ReverseMapping(const PPA_type &moving_ppa, RMEntryType &metadata);
+		void Get_LPA_from_ReverseMapping(const PPA_type &target_ppa, LPA_type &LPA);
+
 		//** Append for CAFTL
 		size_t Total_write;
 		size_t Total_read;
@@ -283,17 +287,71 @@ namespace SSD_Components
 		unsigned int CMT_entry_size, GTD_entry_size;//In CMT MQSim stores (lpn, ppn, page status bits) but in GTD it only stores (ppn, page status bits)
 		void allocate_plane_for_user_write(NVM_Transaction_Flash_WR* transaction);
 		void allocate_page_in_plane_for_user_write(NVM_Transaction_Flash_WR* transaction, bool is_for_gc);
+		bool release_page_reference(const stream_id_type stream_id, PPA_type& old_ppa, bool& page_freed);//** Append for CAFTL
+		void deallocate_lpa(NVM_Transaction_Flash_WR* transaction);//** Append for CAFTL: TRIM
 		void allocate_plane_for_translation_write(NVM_Transaction_Flash* transaction);
 		void allocate_page_in_plane_for_translation_write(NVM_Transaction_Flash* transaction, MVPN_type mvpn, bool is_for_gc);
 		void allocate_plane_for_preconditioning(stream_id_type stream_id, LPA_type lpn, NVM::FlashMemory::Physical_Page_Address& targetAddress);
 		bool request_mapping_entry(const stream_id_type streamID, const LPA_type lpn);
 		static void handle_transaction_serviced_signal_from_PHY(NVM_Transaction_Flash* transaction);
+		static LPA_type handle_page_lpa_query_from_PHY(NVM_Transaction_Flash* transaction);//** Append for CAFTL
+		Block_Pool_Slot_Type* get_page_block(const PPA_type ppa, flash_page_ID_type& page_id);//** Append for CAFTL, NULL for VPAs and out of range addresses
+		void invalidate_released_page(const NVM::FlashMemory::Physical_Page_Address& page_address);//** Append for CAFTL, invalidates a page without references in the stream that owns its block, and releases its GC lock
+		void update_block_reference_stats(const PPA_type ppa, int reference_delta, int shared_page_delta);//** Append for CAFTL, used by the DEDUP_AWARE GC policy
+		bool chip_has_ongoing_gc(const NVM::FlashMemory::Physical_Page_Address& address);//** Append for CAFTL, out-of-line dedup leaves such chips to GC
 		bool translate_lpa_to_ppa(stream_id_type streamID, NVM_Transaction_Flash* transaction);
 		std::set<NVM_Transaction_Flash_WR*>**** Write_transactions_for_overfull_planes;
 
 		void generate_flash_read_request_for_mapping_data(const stream_id_type streamID, const LPA_type lpn);
 		void generate_flash_writeback_request_for_mapping_data(const stream_id_type streamID, const LPA_type lpn);
 
+		//** Append for CAFTL: bounded fingerprint store
+		unsigned int FP_entry_size;//In a fingerprint bucket MQSim stores (fingerprint, ppn, reference count)
+		bool is_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn);
+		bool fetch_fingerprint_for_write(NVM_Transaction_Flash_WR* transaction);
+		void prepare_dedup_batch(const std::list<NVM_Transaction*>& transactionList);
+		std::vector<NVM_Transaction_Flash_WR*> dedup_batch;//Scratch list of prepare_dedup_batch, kept to avoid an allocation per dispatch
+		void insert_fingerprint_into_cache(const stream_id_type stream_id, const FP_type& FP, bool dirty);
+		void update_fingerprint_in_cache(const stream_id_type stream_id, const FP_type& FP);
+		void generate_flash_read_request_for_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn);
+		void generate_flash_writeback_request_for_fingerprint_bucket(const stream_id_type stream_id, const MVPN_type mvpn);
+		void handle_fingerprint_bucket_serviced(NVM_Transaction_Flash* transaction);
+
+		//** Append for CAFTL: bounded Secondary Mapping Table
+		unsigned int SMT_entry_size;//An SMT entry only stores a PPA, its VPA is given by its position in the SMT page
+		bool is_smt_page(const stream_id_type stream_id, const MVPN_type mvpn);
+		bool fetch_smt_entry_for_read(NVM_Transaction_Flash_RD* transaction);
+		void access_smt_entry(const stream_id_type stream_id, const VPA_type VPA, bool dirty);
+		void insert_smt_entry_into_cache(const stream_id_type stream_id, const VPA_type VPA, bool dirty);
+		void generate_flash_read_request_for_smt_page(const stream_id_type stream_id, const MVPN_type mvpn);
+		void generate_flash_writeback_request_for_smt_page(const stream_id_type stream_id, const MVPN_type mvpn);
+		void handle_smt_page_serviced(NVM_Transaction_Flash* transaction);
+
+		//** Append for CAFTL: out-of-line dedup
+		bool merge_pending_chunk(const stream_id_type stream_id, const FP_type& placeholder, bool is_for_gc);
+		void update_mapping_for_background_dedup(const stream_id_type stream_id, const LPA_type lpa, const PPA_type ppa);
+		bool resolve_placeholder_chunk(const stream_id_type stream_id, const FP_type& placeholder, const FP_type& fp, const PPA_type ppa, const LPA_type lpa);
+
+		//** Append for CAFTL: GC dedup
+		bool merge_duplicate_for_gc(NVM_Transaction_Flash_WR* transaction);
+
+		//** Append for CAFTL: sub-page chunk dedup
+		unsigned int get_plane_index(const NVM::FlashMemory::Physical_Page_Address& address);
+		void bind_chunk_fingerprints(NVM_Transaction_Flash_WR* transaction);
+		unsigned int get_chunk_length(Chunk_Store* chunks, NVM_Transaction_Flash_WR* transaction, size_t fp_index);
+		void program_chunk_buffer(NVM_Transaction_Flash_WR* transaction, unsigned int plane, bool is_for_gc);
+		void allocate_chunks_for_user_write(NVM_Transaction_Flash_WR* transaction);
+		void move_chunk_page_for_gc(NVM_Transaction_Flash_WR* transaction);
+		void release_chunk(const stream_id_type stream_id, const CID_type cid);
+		PPA_type translate_chunks_for_read(const stream_id_type stream_id, NVM_Transaction_Flash_RD* transaction);
+		void issue_chunk_read(const stream_id_type stream_id, const LPA_type lpa, const PPA_type ppa, const page_status_type read_sectors_bitmap);
+
+		//** Append for CAFTL: dedup reporting
+		sim_time_type dedup_logging_period;//0 if the time series of the dedup state is disabled
+		sim_time_type next_dedup_logging_milestone;
+		void record_dedup_state(const stream_id_type stream_id, Dedup_Epoch_Record& record);
+		void log_dedup_epoch();
+
 		unsigned int no_of_translation_entries_per_page;
 		MVPN_type get_MVPN(const LPA_type lpn, stream_id_type stream_id);
 		LPA_type get_start_LPN_in_MVP(const MVPN_type);
@@ -303,6 +361,8 @@ namespace SSD_Components
 		PPA_type online_create_entry_for_reads(LPA_type lpa, const stream_id_type stream_id, NVM::FlashMemory::Physical_Page_Address& read_address, uint64_t read_sectors_bitmap);
 		void mange_unsuccessful_translation(NVM_Transaction_Flash* transaction);
 		void manage_user_transaction_facing_barrier(NVM_Transaction_Flash* transaction);
+		void complete_duplicate_write(NVM_Transaction_Flash_WR* transaction);//** Append for CAFTL
+		void issue_verify_read(NVM_Transaction_Flash_WR* transaction);//** Append for CAFTL
 		void manage_mapping_transaction_facing_barrier(stream_id_type stream_id, MVPN_type mvpn, bool read);
 		bool is_lpa_locked_for_gc(stream_id_type stream_id, LPA_type lpa);
 		bool is_mvpn_locked_for_gc(stream_id_type stream_id, MVPN_type mvpn);
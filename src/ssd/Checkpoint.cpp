@@ -0,0 +1,89 @@
+#include <cstring>
+#include "Checkpoint.h"
+
+#define CHECKPOINT_MAGIC "MQCK"
+#define CHECKPOINT_VERSION 5
+#define CHECKPOINT_BUFFER_SIZE (4 * 1024 * 1024)
+
+namespace SSD_Components
+{
+	Checkpoint_Writer::Checkpoint_Writer(const std::string& path) : path(path)
+	{
+		file = std::fopen(path.c_str(), "wb");
+		if (file == NULL)
+			PRINT_ERROR("Fail to create checkpoint file: " << path)
+		std::setvbuf(file, NULL, _IOFBF, CHECKPOINT_BUFFER_SIZE);
+		uint32_t version = CHECKPOINT_VERSION;
+		write_bytes(CHECKPOINT_MAGIC, 4);
+		Write(version);
+	}
+
+	Checkpoint_Writer::~Checkpoint_Writer()
+	{
+		if (file != NULL)
+			std::fclose(file);
+	}
+
+	void Checkpoint_Writer::Begin_section(const char* tag)
+	{
+		write_bytes(tag, 4);
+	}
+
+	void Checkpoint_Writer::Close()
+	{
+		bool success = std::fflush(file) == 0 && std::ferror(file) == 0;
+		std::fclose(file);
+		file = NULL;
+		if (!success)
+			PRINT_ERROR("Fail to write checkpoint file: " << path)
+	}
+
+	void Checkpoint_Writer::write_bytes(const void* data, size_t size)
+	{
+		if (size > 0 && std::fwrite(data, 1, size, file) != size)
+			PRINT_ERROR("Fail to write checkpoint file: " << path)
+	}
+
+	Checkpoint_Reader::Checkpoint_Reader(const std::string& path) : path(path)
+	{
+		file = std::fopen(path.c_str(), "rb");
+		if (file == NULL)
+			PRINT_ERROR("Fail to open checkpoint file: " << path)
+		std::setvbuf(file, NULL, _IOFBF, CHECKPOINT_BUFFER_SIZE);
+		char magic[4];
+		read_bytes(magic, 4);
+		if (std::memcmp(magic, CHECKPOINT_MAGIC, 4) != 0)
+			PRINT_ERROR(path << " is not an MQSim checkpoint!")
+		if (Read<uint32_t>() != CHECKPOINT_VERSION)
+			PRINT_ERROR("Unsupported checkpoint version: " << path)
+	}
+
+	Checkpoint_Reader::~Checkpoint_Reader()
+	{
+		if (file != NULL)
+			std::fclose(file);
+	}
+
+	void Checkpoint_Reader::Begin_section(const char* tag)
+	{
+		char stored_tag[4];
+		read_bytes(stored_tag, 4);
+		if (std::memcmp(stored_tag, tag, 4) != 0)
+			PRINT_ERROR("Corrupted checkpoint " << path << ": section " << std::string(tag, 4) << " expected!")
+	}
+
+	void Checkpoint_Reader::Close()
+	{
+		bool at_end = std::fgetc(file) == EOF;
+		std::fclose(file);
+		file = NULL;
+		if (!at_end)
+			PRINT_ERROR("Corrupted checkpoint " << path << ": trailing data!")
+	}
+
+	void Checkpoint_Reader::read_bytes(void* data, size_t size)
+	{
+		if (size > 0 && std::fread(data, 1, size, file) != size)
+			PRINT_ERROR("Corrupted checkpoint " << path << ": unexpected end of file!")
+	}
+}
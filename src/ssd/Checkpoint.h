@@ -0,0 +1,73 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../sim/Sim_Defs.h"
+
+namespace SSD_Components
+{
+	/*
+	* Binary image of the warm FTL state (Append for CAFTL).
+	* Layout: "MQCK", uint32 version, then one section per component. Each section starts with a four
+	* letter tag, so a reader that gets out of step with the writer stops at the next section instead of
+	* loading garbage. Values are raw host-endian PODs; an image is only meant to be loaded by a build
+	* for the same platform. Any I/O or format error is fatal, since a half-loaded device is useless.
+	*/
+	class Checkpoint_Writer
+	{
+	public:
+		Checkpoint_Writer(const std::string& path);
+		~Checkpoint_Writer();
+		void Begin_section(const char* tag);
+		template<typename T>
+		void Write(const T& value) { write_bytes(&value, sizeof(T)); }
+		template<typename T>
+		void Write_array(const T* values, size_t count) { write_bytes(values, sizeof(T) * count); }
+		template<typename T>
+		void Write_vector(const std::vector<T>& values)//Element count first, then the elements
+		{
+			Write((uint64_t)values.size());
+			if (values.size() > 0)
+				Write_array(&values[0], values.size());
+		}
+		void Close();
+	private:
+		std::FILE* file;
+		std::string path;
+		void write_bytes(const void* data, size_t size);
+	};
+
+	class Checkpoint_Reader
+	{
+	public:
+		Checkpoint_Reader(const std::string& path);
+		~Checkpoint_Reader();
+		void Begin_section(const char* tag);
+		template<typename T>
+		T Read() { T value; read_bytes(&value, sizeof(T)); return value; }
+		template<typename T>
+		void Read_array(T* values, size_t count) { read_bytes(values, sizeof(T) * count); }
+		template<typename T>
+		void Read_vector(std::vector<T>& values)
+		{
+			values.resize((size_t)Read<uint64_t>());
+			if (values.size() > 0)
+				Read_array(&values[0], values.size());
+		}
+		template<typename T>
+		void Expect(const T& value, const char* what)//The image must have been taken on the same configuration
+		{
+			if (Read<T>() != value)
+				PRINT_ERROR("The checkpoint " << path << " does not match this configuration: " << what << " differs!")
+		}
+		void Close();//Fails if the image holds more than what was loaded
+	private:
+		std::FILE* file;
+		std::string path;
+		void read_bytes(void* data, size_t size);
+	};
+}
+
+#endif // !CHECKPOINT_H
@@ -0,0 +1,178 @@
+#include "Chunk_Store.h"
+
+namespace SSD_Components
+{
+	Chunk_Store::Chunk_Store(LPA_type logical_pages_no, PPA_type physical_pages_no, unsigned int chunks_per_page, unsigned int sectors_per_chunk, unsigned int plane_no, bool compression) :
+		chunks_per_page(chunks_per_page), sectors_per_chunk(sectors_per_chunk), sectors_per_page(chunks_per_page * sectors_per_chunk),
+		slots_per_page(compression ? chunks_per_page * sectors_per_chunk : chunks_per_page), compression(compression), buffered_chunk_no(0)
+	{
+		logical_map.assign((size_t)logical_pages_no * chunks_per_page, NO_CHUNK);
+		page_slots.assign((size_t)physical_pages_no * slots_per_page, NO_CHUNK);
+		live_chunks.assign((size_t)physical_pages_no, 0);
+		buffers.resize(plane_no);
+		buffer_fill.assign(plane_no, 0);
+		for (unsigned int plane = 0; plane < plane_no; plane++)
+			buffers[plane].reserve(slots_per_page);
+	}
+
+	CID_type Chunk_Store::Create_chunk(const FP_type& FP, unsigned int length)
+	{
+		CID_type cid;
+		if (free_cids.size() > 0) {
+			cid = free_cids.back();
+			free_cids.pop_back();
+		} else {
+			cid = (CID_type)chunks.size();
+			chunks.push_back(Chunk_Entry());
+		}
+		chunks[cid].PPA = NO_PPA;
+		chunks[cid].Slot = 0;
+		chunks[cid].Buffer = NO_BUFFER;
+		chunks[cid].Offset = 0;
+		chunks[cid].Length = (uint16_t)length;
+		chunks[cid].FP = FP;
+
+		return cid;
+	}
+
+	void Chunk_Store::Free_chunk(CID_type cid)
+	{
+		if (chunks[cid].Buffer != NO_BUFFER || chunks[cid].PPA != NO_PPA)
+			PRINT_ERROR("A chunk is freed while it is still buffered or stored!")
+		free_cids.push_back(cid);
+	}
+
+	page_status_type Chunk_Store::Get_chunk_bitmap(CID_type cid) const
+	{
+		const Chunk_Entry& entry = chunks[cid];
+		if (entry.Length >= sizeof(page_status_type) * 8)
+			return ~((page_status_type)0);
+		return ((((page_status_type)1) << entry.Length) - 1) << entry.Offset;
+	}
+
+	bool Chunk_Store::Buffer_chunk(CID_type cid, unsigned int plane)
+	{
+		if (!Fits_in_buffer(cid, plane))
+			PRINT_ERROR("A chunk is buffered in a packing buffer that has no room for it!")
+		chunks[cid].Buffer = plane;
+		chunks[cid].Slot = (unsigned int)buffers[plane].size();
+		buffers[plane].push_back(cid);
+		buffer_fill[plane] += chunks[cid].Length;
+		buffered_chunk_no++;
+
+		return buffer_fill[plane] == sectors_per_page;
+	}
+
+	void Chunk_Store::Unbuffer_chunk(CID_type cid)
+	{
+		std::vector<CID_type>& buffer = buffers[chunks[cid].Buffer];
+		unsigned int slot = chunks[cid].Slot;
+		buffer[slot] = buffer.back();
+		chunks[buffer[slot]].Slot = slot;
+		buffer.pop_back();
+		buffer_fill[chunks[cid].Buffer] -= chunks[cid].Length;
+		chunks[cid].Buffer = NO_BUFFER;
+		buffered_chunk_no--;
+	}
+
+	void Chunk_Store::Place_buffer(unsigned int plane, PPA_type ppa)
+	{
+		std::vector<CID_type>& buffer = buffers[plane];
+		size_t base = (size_t)ppa * slots_per_page;
+		unsigned int offset = 0;
+		for (unsigned int slot = 0; slot < buffer.size(); slot++) {
+			chunks[buffer[slot]].PPA = ppa;
+			chunks[buffer[slot]].Slot = slot;
+			chunks[buffer[slot]].Offset = (uint16_t)offset;
+			chunks[buffer[slot]].Buffer = NO_BUFFER;
+			page_slots[base + slot] = buffer[slot];
+			offset += chunks[buffer[slot]].Length;
+		}
+		live_chunks[(size_t)ppa] = (uint16_t)buffer.size();
+		buffered_chunk_no -= buffer.size();
+		buffer.clear();
+		buffer_fill[plane] = 0;
+	}
+
+	bool Chunk_Store::Remove_chunk_from_page(CID_type cid)
+	{
+		PPA_type ppa = chunks[cid].PPA;
+		page_slots[(size_t)ppa * slots_per_page + chunks[cid].Slot] = NO_CHUNK;
+		chunks[cid].PPA = NO_PPA;
+		live_chunks[(size_t)ppa]--;
+
+		return live_chunks[(size_t)ppa] == 0;
+	}
+
+	void Chunk_Store::Move_page(PPA_type source_ppa, PPA_type destination_ppa)
+	{
+		size_t source = (size_t)source_ppa * slots_per_page, destination = (size_t)destination_ppa * slots_per_page;
+		for (unsigned int slot = 0; slot < slots_per_page; slot++) {
+			CID_type cid = page_slots[source + slot];
+			page_slots[destination + slot] = cid;
+			page_slots[source + slot] = NO_CHUNK;
+			if (cid != NO_CHUNK)
+				chunks[cid].PPA = destination_ppa;
+		}
+		live_chunks[(size_t)destination_ppa] = live_chunks[(size_t)source_ppa];
+		live_chunks[(size_t)source_ppa] = 0;
+	}
+
+	void Chunk_Store::Take_page_chunks(PPA_type ppa, std::vector<CID_type>& cids)
+	{
+		size_t base = (size_t)ppa * slots_per_page;
+		for (unsigned int slot = 0; slot < slots_per_page; slot++) {
+			CID_type cid = page_slots[base + slot];
+			if (cid != NO_CHUNK) {
+				chunks[cid].PPA = NO_PPA;
+				page_slots[base + slot] = NO_CHUNK;
+				cids.push_back(cid);
+			}
+		}
+		live_chunks[(size_t)ppa] = 0;
+	}
+
+	unsigned int Chunk_Store::Get_live_sector_no(PPA_type ppa) const
+	{
+		unsigned int sector_no = 0;
+		size_t base = (size_t)ppa * slots_per_page;
+		for (unsigned int slot = 0; slot < slots_per_page; slot++) {
+			if (page_slots[base + slot] != NO_CHUNK)
+				sector_no += chunks[page_slots[base + slot]].Length;
+		}
+
+		return sector_no;
+	}
+
+	void Chunk_Store::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Write(chunks_per_page);
+		writer.Write(compression);
+		writer.Write_vector(logical_map);
+		writer.Write_vector(chunks);
+		writer.Write_vector(free_cids);
+		for (auto& buffer : buffers)
+			writer.Write_vector(buffer);
+		writer.Write_vector(buffer_fill);
+		writer.Write(buffered_chunk_no);
+		writer.Write_vector(page_slots);
+		writer.Write_vector(live_chunks);
+	}
+
+	void Chunk_Store::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Expect(chunks_per_page, "Dedup_Chunk_Size");
+		reader.Expect(compression, "Compression_Enabled");
+		reader.Read_vector(logical_map);
+		reader.Read_vector(chunks);
+		reader.Read_vector(free_cids);
+		for (auto& buffer : buffers) {
+			reader.Read_vector(buffer);
+			buffer.reserve(slots_per_page);
+		}
+		reader.Read_vector(buffer_fill);
+		buffered_chunk_no = reader.Read<size_t>();
+		reader.Read_vector(page_slots);
+		reader.Read_vector(live_chunks);
+	}
+}
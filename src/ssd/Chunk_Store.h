@@ -0,0 +1,90 @@
+#ifndef CHUNK_STORE_H
+#define CHUNK_STORE_H
+
+#include <vector>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Checkpoint.h"
+
+namespace SSD_Components
+{
+	typedef uint32_t CID_type;//Chunk ID, the index of a chunk in the chunk table
+#define NO_CHUNK 0xffffffff
+#define NO_BUFFER 0xffffffff
+
+	struct Chunk_Entry//** Append for CAFTL
+	{
+		PPA_type PPA;//Flash page that holds the chunk, NO_PPA while the chunk waits in a packing buffer
+		unsigned int Slot;//Position of the chunk in its flash page or in its packing buffer
+		uint32_t Buffer;//Packing buffer (plane index) of the chunk, NO_BUFFER once it is programmed
+		uint16_t Offset;//First sector of the chunk in its flash page
+		uint16_t Length;//Sectors that the chunk takes in flash, less than the chunk size if it is compressed
+		FP_type FP;
+	};
+
+	/*
+	* Sub-page chunk store of the CAFTL deduplicator (Append for CAFTL). With a dedup chunk smaller than a flash
+	* page, a logical page consists of Chunks_per_page chunks, and each of them maps to a chunk ID (CID) instead
+	* of a page. The chunk table gives the location of each stored chunk: a slot of a flash page, or a slot of the
+	* packing buffer of a plane where unique chunks wait until a whole page of them can be programmed. The page slot
+	* table is the chunk-granular reverse mapping: for each physical page it lists the CIDs stored in its slots and
+	* counts the live ones, so a page is invalidated as soon as its last chunk is released and GC moves the chunks of
+	* a page by renaming the page in the chunk table. The reference count of a chunk stays in the fingerprint index.
+	* All tables are flat arrays indexed by LPA, CID or PPA; freed CIDs are recycled through a free list.
+	* With compression, a chunk takes as many sectors as its compressed content, so a page holds up to one chunk per
+	* sector: buffers are filled by sectors, and a chunk that does not fit in the rest of a buffer has it programmed.
+	*/
+	class Chunk_Store
+	{
+	public:
+		Chunk_Store(LPA_type logical_pages_no, PPA_type physical_pages_no, unsigned int chunks_per_page, unsigned int sectors_per_chunk, unsigned int plane_no, bool compression);
+		unsigned int Get_chunks_per_page() const { return chunks_per_page; }
+		unsigned int Get_sectors_per_chunk() const { return sectors_per_chunk; }
+		unsigned int Get_slots_per_page() const { return slots_per_page; }
+		bool Is_compressed() const { return compression; }
+
+		//Logical chunk map, NO_CHUNK for chunks that have never been written
+		CID_type Get_logical_chunk(LPA_type lpa, unsigned int index) const { return logical_map[(size_t)lpa * chunks_per_page + index]; }
+		void Set_logical_chunk(LPA_type lpa, unsigned int index, CID_type cid) { logical_map[(size_t)lpa * chunks_per_page + index] = cid; }
+
+		CID_type Create_chunk(const FP_type& FP, unsigned int length);//A new chunk of length sectors that is neither buffered nor stored
+		void Free_chunk(CID_type cid);//The caller first takes the chunk out of its buffer or page
+		Chunk_Entry& Get_chunk(CID_type cid) { return chunks[cid]; }
+		page_status_type Get_chunk_bitmap(CID_type cid) const;//Sectors of the flash page of the chunk that hold it
+		size_t Get_chunk_no() const { return chunks.size() - free_cids.size(); }
+
+		//Packing buffers
+		bool Fits_in_buffer(CID_type cid, unsigned int plane) const { return buffer_fill[plane] + chunks[cid].Length <= sectors_per_page; }
+		bool Buffer_chunk(CID_type cid, unsigned int plane);//true if the buffer of the plane holds a whole page now
+		void Unbuffer_chunk(CID_type cid);
+		const std::vector<CID_type>& Get_buffer(unsigned int plane) const { return buffers[plane]; }
+		void Place_buffer(unsigned int plane, PPA_type ppa);//The buffered chunks are programmed to page ppa and the buffer is emptied
+		size_t Get_buffered_chunk_no() const { return buffered_chunk_no; }
+
+		//Chunk-granular reverse mapping
+		CID_type Get_page_chunk(PPA_type ppa, unsigned int slot) const { return page_slots[(size_t)ppa * chunks_per_page + slot]; }
+		unsigned int Get_live_chunk_no(PPA_type ppa) const { return live_chunks[(size_t)ppa]; }
+		bool Remove_chunk_from_page(CID_type cid);//true if the page of the chunk holds no live chunk anymore
+		void Move_page(PPA_type source_ppa, PPA_type destination_ppa);//GC moved the live chunks of source_ppa to destination_ppa
+		void Take_page_chunks(PPA_type ppa, std::vector<CID_type>& cids);//GC takes the live chunks out of page ppa to repack them
+		unsigned int Get_live_sector_no(PPA_type ppa) const;
+
+		void Save_checkpoint(Checkpoint_Writer& writer);
+		void Load_checkpoint(Checkpoint_Reader& reader);
+	private:
+		unsigned int chunks_per_page;
+		unsigned int sectors_per_chunk;
+		unsigned int sectors_per_page;
+		unsigned int slots_per_page;
+		bool compression;
+		std::vector<CID_type> logical_map;
+		std::vector<Chunk_Entry> chunks;
+		std::vector<CID_type> free_cids;
+		std::vector<std::vector<CID_type>> buffers;
+		std::vector<unsigned int> buffer_fill;//Sectors taken in each packing buffer
+		size_t buffered_chunk_no;
+		std::vector<CID_type> page_slots;
+		std::vector<uint16_t> live_chunks;
+	};
+}
+
+#endif // !CHUNK_STORE_H
@@ -0,0 +1,70 @@
+#include <cmath>
+#include "Content_Generator.h"
+
+namespace SSD_Components
+{
+	Content_Generator::Content_Generator(double duplicate_ratio, uint64_t universe_size, Utils::Content_Popularity_Type popularity, int seed,
+		unsigned int compressed_percentage, unsigned int content_size_in_byte) :
+		Generated_no(0), Duplicate_no(0), duplicate_ratio(duplicate_ratio), universe_size(universe_size), popularity(popularity),
+		seed((uint64_t)(uint32_t)seed), random_generator(seed), content_no(0),
+		compressed_percentage(compressed_percentage > 100 ? 100 : compressed_percentage), content_size_in_byte(content_size_in_byte)
+	{
+	}
+
+	void Content_Generator::Next(FP_type& FP, uint32_t& compressed_size)
+	{
+		uint64_t content;
+		bool universe_full = universe_size > 0 && content_no >= universe_size;
+		if (content_no > 0 && (universe_full || random_generator.FloatRandom() < duplicate_ratio)) {
+			content = pick_content();
+			Duplicate_no++;
+		} else {
+			content = content_no++;
+		}
+		Generated_no++;
+		make_fingerprint(content, FP);
+		compressed_size = get_compressed_size(content);
+	}
+
+	uint64_t Content_Generator::pick_content()
+	{
+		if (popularity == Utils::Content_Popularity_Type::ZIPF) {
+			//Continuous approximation of a Zipf law with exponent 1 over n contents: P(rank i) ~ 1 / (i + 1)
+			uint64_t rank = (uint64_t)std::pow((double)(content_no + 1), random_generator.FloatRandom()) - 1;
+			return rank < content_no ? rank : content_no - 1;
+		}
+		return random_generator.Uniform_ulong(0, content_no - 1);
+	}
+
+	void Content_Generator::make_fingerprint(uint64_t content, FP_type& FP)
+	{
+		//splitmix64 over (seed, content), so that flows with different seeds never share contents
+		uint64_t state = (seed << 40) ^ content;
+		for (unsigned int i = 0; i < FP_DIGEST_SIZE; i += 8) {
+			state += 0x9e3779b97f4a7c15ULL;
+			uint64_t z = state;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			z ^= z >> 31;
+			for (unsigned int j = 0; j < 8 && i + j < FP_DIGEST_SIZE; j++)
+				FP.Digest[i + j] = (uint8_t)(z >> (8 * j));
+		}
+	}
+
+	uint32_t Content_Generator::get_compressed_size(uint64_t content)
+	{
+		if (compressed_percentage == 100)
+			return content_size_in_byte;
+
+		//One more splitmix64 step with a different salt than the digest
+		uint64_t z = ((seed << 40) ^ content) + 0xd1b54a32d192ed03ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		z ^= z >> 31;
+		double u = double(z >> 11) / double(1ULL << 53);
+		double low = compressed_percentage * 2.0 > 100.0 ? compressed_percentage * 2.0 - 100.0 : 0.0;
+		double high = compressed_percentage * 2.0 < 100.0 ? compressed_percentage * 2.0 : 100.0;
+		uint32_t size = (uint32_t)std::ceil(content_size_in_byte * (low + (high - low) * u) / 100.0);
+		return size == 0 ? 1 : size;
+	}
+}
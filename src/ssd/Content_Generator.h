@@ -0,0 +1,51 @@
+#ifndef CONTENT_GENERATOR_H
+#define CONTENT_GENERATOR_H
+
+#include <cstdint>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "../utils/RandomGenerator.h"
+#include "../utils/DistributionTypes.h"
+
+namespace SSD_Components
+{
+	/*
+	* Synthetic content model of the CAFTL deduplicator (Append for CAFTL). It stands in for a fingerprint feed
+	* when a synthetic flow drives the device. Each written page (or chunk) repeats an earlier content with
+	* probability Duplicate_ratio and gets a new content otherwise. New contents are numbered in write order.
+	* A duplicate picks one of the contents seen so far, either uniformly or by a Zipf law over their age, so the
+	* first contents are the most popular ones. Once Universe_size contents exist, every write is a duplicate.
+	* The digest of a content depends only on its number and on the seed, so a run is fully reproducible.
+	* The achieved dedup rate can be below the target, since a content stops being a duplicate candidate for
+	* the device once all of its copies have been overwritten.
+	* The compressed size of a content is also drawn from its number: its percentage of the content size is
+	* uniform in a range centered on Compressed_percentage, so all copies of a content compress alike.
+	*/
+	class Content_Generator
+	{
+	public:
+		Content_Generator(double duplicate_ratio, uint64_t universe_size, Utils::Content_Popularity_Type popularity, int seed,
+			unsigned int compressed_percentage, unsigned int content_size_in_byte);
+		void Next(FP_type& FP, uint32_t& compressed_size);//compressed_size in bytes
+		double Get_duplicate_ratio() const { return duplicate_ratio; }
+		uint64_t Get_universe_size() const { return universe_size; }
+		Utils::Content_Popularity_Type Get_popularity() const { return popularity; }
+		unsigned int Get_compressed_percentage() const { return compressed_percentage; }
+
+		size_t Generated_no;
+		size_t Duplicate_no;//Writes that repeat an earlier content
+	private:
+		double duplicate_ratio;
+		uint64_t universe_size;//0 for an unbounded universe
+		Utils::Content_Popularity_Type popularity;
+		uint64_t seed;
+		Utils::RandomGenerator random_generator;
+		uint64_t content_no;//Contents that have been written at least once
+		unsigned int compressed_percentage;//Mean compressed size in percent of the content size, 100 for incompressible contents
+		unsigned int content_size_in_byte;
+		uint64_t pick_content();
+		void make_fingerprint(uint64_t content, FP_type& FP);
+		uint32_t get_compressed_size(uint64_t content);
+	};
+}
+
+#endif // !CONTENT_GENERATOR_H
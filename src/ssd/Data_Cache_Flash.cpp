@@ -4,7 +4,8 @@
 
 namespace SSD_Components
 {
-	Data_Cache_Flash::Data_Cache_Flash(unsigned int capacity_in_pages) : capacity_in_pages(capacity_in_pages) {}
+	Data_Cache_Flash::Data_Cache_Flash(unsigned int capacity_in_pages, bool content_aware) : Shared_write_no(0), capacity_in_pages(capacity_in_pages),
+		content_aware(content_aware), shared_slot_no(0) {}
 	bool Data_Cache_Flash::Exists(const stream_id_type stream_id, const LPA_type lpn)
 	{
 		LPA_type key = LPN_TO_UNIQUE_KEY(stream_id, lpn);
@@ -37,12 +38,12 @@ namespace SSD_Components
 
 	bool Data_Cache_Flash::Check_free_slot_availability()
 	{
-		return slots.size() < capacity_in_pages;
+		return occupied_page_no() < capacity_in_pages;
 	}
 
 	bool Data_Cache_Flash::Check_free_slot_availability(unsigned int no_of_slots)
 	{
-		return slots.size() + no_of_slots <= capacity_in_pages;
+		return occupied_page_no() + no_of_slots <= capacity_in_pages;
 	}
 
 	bool Data_Cache_Flash::Empty()
@@ -52,7 +53,7 @@ namespace SSD_Components
 
 	bool Data_Cache_Flash::Full()
 	{
-		return slots.size() == capacity_in_pages;
+		return occupied_page_no() == capacity_in_pages;
 	}
 
 	Data_Cache_Slot_Type Data_Cache_Flash::Evict_one_dirty_slot()
@@ -72,20 +73,35 @@ namespace SSD_Components
 			return evicted_item;
 		}
 
-		slots.erase(lru_list.back().first);
-		delete lru_list.back().second;
-		lru_list.pop_back();
+		erase_slot(lru_list.back().first);
 		
 		return evicted_item;
 	}
 
 	Data_Cache_Slot_Type Data_Cache_Flash::Evict_one_slot_lru()
+	{
+		std::vector<Data_Cache_Slot_Type> sharing_slots;
+		Data_Cache_Slot_Type evicted_item = Evict_one_slot_lru(sharing_slots);
+		assert(sharing_slots.size() == 0);//Only slots of a content-aware cache share payloads
+
+		return evicted_item;
+	}
+
+	Data_Cache_Slot_Type Data_Cache_Flash::Evict_one_slot_lru(std::vector<Data_Cache_Slot_Type>& sharing_slots)
 	{
 		assert(slots.size() > 0);
-		slots.erase(lru_list.back().first);
+		LPA_type key = lru_list.back().first;
 		Data_Cache_Slot_Type evicted_item = *lru_list.back().second;
-		delete lru_list.back().second;
-		lru_list.pop_back();
+		if (evicted_item.FP_available) {//The DRAM page is only freed once no slot uses the payload anymore
+			std::list<LPA_type> sharing_keys = payloads[evicted_item.FP];
+			for (auto sharing_key : sharing_keys) {
+				if (sharing_key != key) {
+					sharing_slots.push_back(*slots[sharing_key]);
+					erase_slot(sharing_key);
+				}
+			}
+		}
+		erase_slot(key);
 
 		return evicted_item;
 	}
@@ -106,7 +122,7 @@ namespace SSD_Components
 		if (slots.find(key) != slots.end()) {
 			throw std::logic_error("Duplicate lpn insertion into data cache!");
 		}
-		if (slots.size() >= capacity_in_pages) {
+		if (occupied_page_no() >= capacity_in_pages) {
 			throw std::logic_error("Data cache overfull!");
 		}
 
@@ -116,13 +132,14 @@ namespace SSD_Components
 		cache_slot->Content = content;
 		cache_slot->Timestamp = timestamp;
 		cache_slot->Status = Cache_Slot_Status::CLEAN;
+		cache_slot->FP_available = false;
 		lru_list.push_front(std::pair<LPA_type, Data_Cache_Slot_Type*>(key, cache_slot));
 		cache_slot->lru_list_ptr = lru_list.begin();
 		slots[key] = cache_slot;
 	}
 
 	void Data_Cache_Flash::Insert_write_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content,
-		const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors)
+		const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors, const FP_type* FP)
 	{
 		LPA_type key = LPN_TO_UNIQUE_KEY(stream_id, lpn);
 		
@@ -130,7 +147,7 @@ namespace SSD_Components
 			throw std::logic_error("Duplicate lpn insertion into data cache!!");
 		}
 		
-		if (slots.size() >= capacity_in_pages) {
+		if (Needs_free_slot(stream_id, lpn, FP) && occupied_page_no() >= capacity_in_pages) {
 			throw std::logic_error("Data cache overfull!");
 		}
 
@@ -140,18 +157,21 @@ namespace SSD_Components
 		cache_slot->Content = content;
 		cache_slot->Timestamp = timestamp;
 		cache_slot->Status = Cache_Slot_Status::DIRTY_NO_FLASH_WRITEBACK;
+		join_payload(key, cache_slot, FP);
 		lru_list.push_front(std::pair<LPA_type, Data_Cache_Slot_Type*>(key, cache_slot));
 		cache_slot->lru_list_ptr = lru_list.begin();
 		slots[key] = cache_slot;
 	}
 
 	void Data_Cache_Flash::Update_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content,
-		const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors)
+		const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors, const FP_type* FP)
 	{
 		LPA_type key = LPN_TO_UNIQUE_KEY(stream_id, lpn);
 		auto it = slots.find(key);
 		assert(it != slots.end());
 
+		leave_payload(it->second);
+		join_payload(key, it->second, FP);
 		it->second->LPA = lpn;
 		it->second->State_bitmap_of_existing_sectors = state_bitmap_of_write_sectors;
 		it->second->Content = content;
@@ -163,10 +183,94 @@ namespace SSD_Components
 	}
 
 	void Data_Cache_Flash::Remove_slot(const stream_id_type stream_id, const LPA_type lpn)
+	{
+		erase_slot(LPN_TO_UNIQUE_KEY(stream_id, lpn));
+	}
+
+	/*
+	* A TRIM drops the trimmed sectors of a cached page (Append for CAFTL). The slot leaves the cache if no sector
+	* is left, or if it is not waiting for its write back, since flash has or will have a copy of it. Otherwise, it
+	* keeps its payload: the trimmed sectors are simply not written back.
+	*/
+	void Data_Cache_Flash::Trim_data(const stream_id_type stream_id, const LPA_type lpn, const page_status_type state_bitmap_of_trimmed_sectors)
 	{
 		LPA_type key = LPN_TO_UNIQUE_KEY(stream_id, lpn);
+		auto it = slots.find(key);
+		if (it == slots.end()) {
+			return;
+		}
+
+		page_status_type remaining_sectors = it->second->State_bitmap_of_existing_sectors & ~state_bitmap_of_trimmed_sectors;
+		if (remaining_sectors == 0 || it->second->Status != Cache_Slot_Status::DIRTY_NO_FLASH_WRITEBACK) {
+			erase_slot(key);
+		} else {
+			it->second->State_bitmap_of_existing_sectors = remaining_sectors;
+		}
+	}
+
+	bool Data_Cache_Flash::Is_payload_cached(const FP_type& FP)
+	{
+		return payloads.find(FP) != payloads.end();
+	}
+
+	bool Data_Cache_Flash::Needs_free_slot(const stream_id_type stream_id, const LPA_type lpn, const FP_type* FP)
+	{
+		if (content_aware && FP != NULL && Is_payload_cached(*FP)) {
+			return false;
+		}
+		auto it = slots.find(LPN_TO_UNIQUE_KEY(stream_id, lpn));
+		if (it == slots.end()) {
+			return true;
+		}
+
+		//An update reuses the DRAM page of the slot, unless other slots still share it
+		return it->second->FP_available && payloads[it->second->FP].size() > 1;
+	}
+
+	unsigned int Data_Cache_Flash::occupied_page_no()
+	{
+		return (unsigned int)slots.size() - shared_slot_no;
+	}
+
+	void Data_Cache_Flash::join_payload(const LPA_type key, Data_Cache_Slot_Type* slot, const FP_type* FP)
+	{
+		slot->FP_available = false;
+		if (!content_aware || FP == NULL) {
+			return;
+		}
+
+		slot->FP = *FP;
+		slot->FP_available = true;
+		std::list<LPA_type>& sharing_keys = payloads[*FP];
+		if (sharing_keys.size() > 0) {
+			shared_slot_no++;
+			Shared_write_no++;
+		}
+		sharing_keys.push_front(key);
+		slot->payload_ptr = sharing_keys.begin();
+	}
+
+	void Data_Cache_Flash::leave_payload(Data_Cache_Slot_Type* slot)
+	{
+		if (!slot->FP_available) {
+			return;
+		}
+
+		auto payload = payloads.find(slot->FP);
+		payload->second.erase(slot->payload_ptr);
+		if (payload->second.size() == 0) {
+			payloads.erase(payload);
+		} else {
+			shared_slot_no--;
+		}
+		slot->FP_available = false;
+	}
+
+	void Data_Cache_Flash::erase_slot(const LPA_type key)
+	{
 		auto it = slots.find(key);
 		assert(it != slots.end());
+		leave_payload(it->second);
 		lru_list.erase(it->second->lru_list_ptr);
 		delete it->second;
 		slots.erase(it);
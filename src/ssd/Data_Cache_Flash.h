@@ -4,10 +4,12 @@
 #include <list>
 #include <queue>
 #include <unordered_map>
+#include <vector>
 #include "../nvm_chip/flash_memory/FlashTypes.h"
 #include "SSD_Defs.h"
 #include "Data_Cache_Manager_Base.h"
 #include "NVM_Transaction_Flash.h"
+#include "Fingerprint_Cache.h"
 
 namespace SSD_Components
 {
@@ -20,6 +22,10 @@ namespace SSD_Components
 		data_timestamp_type Timestamp;
 		Cache_Slot_Status Status;
 		std::list<std::pair<LPA_type, Data_Cache_Slot_Type*>>::iterator lru_list_ptr;//used for fast implementation of LRU
+		//** Append for CAFTL: the content of a dirty slot in the content-aware mode
+		FP_type FP;
+		bool FP_available;
+		std::list<LPA_type>::iterator payload_ptr;//Position of the slot among the slots that share its payload
 	};
 
 	enum class Data_Cache_Simulation_Event_Type {
@@ -37,10 +43,15 @@ namespace SSD_Components
 		stream_id_type Stream_id;
 	};
 
+	/*
+	* In the content-aware mode (Append for CAFTL), the written slots are indexed by fingerprint as well as by LPA.
+	* Slots with the same content share one payload, i.e., one DRAM page, so capacity is counted in payloads
+	* rather than in LPAs, and a payload leaves the cache as a whole: evicting one of its slots evicts them all.
+	*/
 	class Data_Cache_Flash
 	{
 	public:
-		Data_Cache_Flash(unsigned int capacity_in_pages = 0);
+		Data_Cache_Flash(unsigned int capacity_in_pages = 0, bool content_aware = false);
 		~Data_Cache_Flash();
 		bool Exists(const stream_id_type streamID, const LPA_type lpn);
 		bool Check_free_slot_availability();
@@ -50,15 +61,29 @@ namespace SSD_Components
 		Data_Cache_Slot_Type Get_slot(const stream_id_type stream_id, const LPA_type lpn);
 		Data_Cache_Slot_Type Evict_one_dirty_slot();
 		Data_Cache_Slot_Type Evict_one_slot_lru();
+		Data_Cache_Slot_Type Evict_one_slot_lru(std::vector<Data_Cache_Slot_Type>& sharing_slots);//The other slots of the evicted payload go to sharing_slots
 		void Change_slot_status_to_writeback(const stream_id_type stream_id, const LPA_type lpn);
 		void Remove_slot(const stream_id_type stream_id, const LPA_type lpn);
+		void Trim_data(const stream_id_type stream_id, const LPA_type lpn, const page_status_type state_bitmap_of_trimmed_sectors);//** Append for CAFTL
 		void Insert_read_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content, const data_timestamp_type timestamp, const page_status_type state_bitmap_of_read_sectors);
-		void Insert_write_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content, const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors);
-		void Update_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content, const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors);
+		void Insert_write_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content, const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors,
+			const FP_type* FP = NULL);
+		void Update_data(const stream_id_type stream_id, const LPA_type lpn, const data_cache_content_type content, const data_timestamp_type timestamp, const page_status_type state_bitmap_of_write_sectors,
+			const FP_type* FP = NULL);
+		bool Is_payload_cached(const FP_type& FP);
+		bool Needs_free_slot(const stream_id_type stream_id, const LPA_type lpn, const FP_type* FP);//Whether writing this content to the LPA takes one more DRAM page
+		size_t Shared_write_no;//Writes that joined a payload already in the cache
 	private:
 		std::unordered_map<LPA_type, Data_Cache_Slot_Type*> slots;
 		std::list<std::pair<LPA_type, Data_Cache_Slot_Type*>> lru_list;
 		unsigned int capacity_in_pages;
+		bool content_aware;
+		std::unordered_map<FP_type, std::list<LPA_type>, FP_Hasher> payloads;//The keys of the slots that share each cached payload
+		unsigned int shared_slot_no;//Slots that use the DRAM page of another slot
+		unsigned int occupied_page_no();
+		void join_payload(const LPA_type key, Data_Cache_Slot_Type* slot, const FP_type* FP);
+		void leave_payload(Data_Cache_Slot_Type* slot);
+		void erase_slot(const LPA_type key);
 	};
 }
 
@@ -1,9 +1,12 @@
 #include <stdexcept>
+#include <unordered_set>
 #include "../nvm_chip/NVM_Types.h"
 #include "Data_Cache_Manager_Flash_Advanced.h"
 #include "NVM_Transaction_Flash_RD.h"
 #include "NVM_Transaction_Flash_WR.h"
 #include "FTL.h"
+#include "Fingerprint_Engine.h"
+#include "Deduplicator.h"
 
 namespace SSD_Components
 {
@@ -11,17 +14,26 @@ namespace SSD_Components
 		unsigned int total_capacity_in_bytes,
 		unsigned int dram_row_size, unsigned int dram_data_rate, unsigned int dram_busrt_size, sim_time_type dram_tRCD, sim_time_type dram_tCL, sim_time_type dram_tRP,
 		Caching_Mode* caching_mode_per_input_stream, Cache_Sharing_Mode sharing_mode,unsigned int stream_count,
-		unsigned int sector_no_per_page, unsigned int back_pressure_buffer_max_depth)
+		unsigned int sector_no_per_page, unsigned int back_pressure_buffer_max_depth, bool content_aware)
 		: Data_Cache_Manager_Base(id, host_interface, firmware, dram_row_size, dram_data_rate, dram_busrt_size, dram_tRCD, dram_tCL, dram_tRP, caching_mode_per_input_stream, sharing_mode, stream_count),
 		flash_controller(flash_controller), capacity_in_bytes(total_capacity_in_bytes), sector_no_per_page(sector_no_per_page),	memory_channel_is_busy(false),
-		dram_execution_list_turn(0), back_pressure_buffer_max_depth(back_pressure_buffer_max_depth)
+		dram_execution_list_turn(0), back_pressure_buffer_max_depth(back_pressure_buffer_max_depth),
+		content_aware(content_aware), skipped_writeback_no(0), remapped_destage_no(0)
 	{
 		capacity_in_pages = capacity_in_bytes / (SECTOR_SIZE_IN_BYTE * sector_no_per_page);
+		if (content_aware) {
+			for (unsigned int i = 0; i < stream_count; i++) {
+				Deduplicator* deduplicator = static_cast<FTL*>(firmware)->Address_Mapping_Unit->Get_deduplicator(i);
+				if (deduplicator == NULL || deduplicator->Mode != Dedup_Mode::INLINE || deduplicator->Chunks != NULL || deduplicator->Sampler != NULL) {
+					PRINT_ERROR("The content-aware data cache requires INLINE Dedup_Mode of whole pages, without sampling, pre-hashing or compression!")
+				}
+			}
+		}
 		switch (sharing_mode)
 		{
 			case SSD_Components::Cache_Sharing_Mode::SHARED:
 			{
-				Data_Cache_Flash* sharedCache = new Data_Cache_Flash(capacity_in_pages);
+				Data_Cache_Flash* sharedCache = new Data_Cache_Flash(capacity_in_pages, content_aware);
 				per_stream_cache = new Data_Cache_Flash*[stream_count];
 				for (unsigned int i = 0; i < stream_count; i++) {
 					per_stream_cache[i] = sharedCache;
@@ -36,7 +48,7 @@ namespace SSD_Components
 			case SSD_Components::Cache_Sharing_Mode::EQUAL_PARTITIONING:
 				per_stream_cache = new Data_Cache_Flash*[stream_count];
 				for (unsigned int i = 0; i < stream_count; i++) {
-					per_stream_cache[i] = new Data_Cache_Flash(capacity_in_pages / stream_count);
+					per_stream_cache[i] = new Data_Cache_Flash(capacity_in_pages / stream_count, content_aware);
 				}
 				dram_execution_queue = new std::queue<Memory_Transfer_Info*>[stream_count];
 				waiting_user_requests_queue_for_dram_free_slot = new std::list<User_Request*>[stream_count];
@@ -55,6 +67,16 @@ namespace SSD_Components
 	
 	Data_Cache_Manager_Flash_Advanced::~Data_Cache_Manager_Flash_Advanced()
 	{
+		if (content_aware) {
+			size_t shared_write_no = 0;
+			for (unsigned int i = 0; i < (sharing_mode == Cache_Sharing_Mode::SHARED ? 1 : stream_count); i++) {
+				shared_write_no += per_stream_cache[i]->Shared_write_no;
+			}
+			PRINT_MESSAGE("\n* Content-Aware Write Cache:");
+			PRINT_MESSAGE("Writes sharing a cached payload #: " << shared_write_no << ", eager writebacks skipped #: " << skipped_writeback_no);
+			PRINT_MESSAGE("Evicted slots destaged without a DRAM read or a fingerprint #: " << remapped_destage_no);
+		}
+
 		switch (sharing_mode)
 		{
 			case SSD_Components::Cache_Sharing_Mode::SHARED:
@@ -191,6 +213,15 @@ namespace SSD_Components
 			return;
 		}
 
+		//** Append for CAFTL: a TRIM drops its sectors from the cache and goes to the mapping unit without being fingerprinted
+		if (user_request->Type == UserRequestType::TRIM) {
+			for (auto tr = user_request->Transaction_list.begin(); tr != user_request->Transaction_list.end(); tr++) {
+				per_stream_cache[user_request->Stream_id]->Trim_data((*tr)->Stream_id, ((NVM_Transaction_Flash_WR*)(*tr))->LPA, ((NVM_Transaction_Flash_WR*)(*tr))->write_sectors_bitmap);
+			}
+			static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(user_request->Transaction_list);
+			return;
+		}
+
 		if (user_request->Type == UserRequestType::READ) {
 			switch (caching_mode_per_input_stream[user_request->Stream_id]) {
 				case Caching_Mode::TURNED_OFF:
@@ -243,7 +274,7 @@ namespace SSD_Components
 			{
 				case Caching_Mode::TURNED_OFF:
 				case Caching_Mode::READ_CACHE:
-					static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(user_request->Transaction_list);
+					static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(user_request->Transaction_list);
 					return;
 				case Caching_Mode::WRITE_CACHE://The data cache manger unit performs like a destage buffer
 				case Caching_Mode::WRITE_READ_CACHE:
@@ -267,6 +298,7 @@ namespace SSD_Components
 	{
 		//To eliminate race condition, MQSim assumes the management information and user data are stored in separate DRAM modules
 		unsigned int cache_eviction_read_size_in_sectors = 0;//The size of data evicted from cache
+		unsigned int cache_eviction_remap_size_in_sectors = 0;//The size of evicted slots that share the DRAM page of another evicted slot
 		unsigned int flash_written_back_write_size_in_sectors = 0;//The size of data that is both written back to flash and written to DRAM
 		unsigned int dram_write_size_in_sectors = 0;//The size of data written to DRAM (must be >= flash_written_back_write_size_in_sectors)
 		std::list<NVM_Transaction*>* evicted_cache_slots = new std::list<NVM_Transaction*>;
@@ -279,8 +311,17 @@ namespace SSD_Components
 		}
 
 		while (it != user_request->Transaction_list.end() 
-			&& (back_pressure_buffer_depth[queue_id] + cache_eviction_read_size_in_sectors + flash_written_back_write_size_in_sectors) < back_pressure_buffer_max_depth) {
+			&& (back_pressure_buffer_depth[queue_id] + cache_eviction_read_size_in_sectors + cache_eviction_remap_size_in_sectors + flash_written_back_write_size_in_sectors) < back_pressure_buffer_max_depth) {
 			NVM_Transaction_Flash_WR* tr = (NVM_Transaction_Flash_WR*)(*it);
+			const FP_type* FP = bind_fingerprint(tr);
+			bool payload_cached = FP != NULL && per_stream_cache[tr->Stream_id]->Is_payload_cached(*FP);
+			if (per_stream_cache[tr->Stream_id]->Needs_free_slot(tr->Stream_id, tr->LPA, FP) && !per_stream_cache[tr->Stream_id]->Check_free_slot_availability()) {
+				std::vector<Data_Cache_Slot_Type> sharing_slots;
+				Data_Cache_Slot_Type evicted_slot = per_stream_cache[tr->Stream_id]->Evict_one_slot_lru(sharing_slots);
+				cache_eviction_read_size_in_sectors += destage_evicted_payload(evicted_slot, sharing_slots, tr->Stream_id, Transaction_Source_Type::CACHE, IO_Flow_Priority_Class::URGENT,
+					*evicted_cache_slots, cache_eviction_remap_size_in_sectors);
+				//DEBUG2("Evicting page" << evicted_slot.LPA << " from write buffer ")
+			}
 			//If the logical address already exists in the cache
 			if (per_stream_cache[tr->Stream_id]->Exists(tr->Stream_id, tr->LPA)) {
 				/*MQSim should get rid of writting stale data to the cache.
@@ -288,37 +329,33 @@ namespace SSD_Components
 				Data_Cache_Slot_Type slot = per_stream_cache[tr->Stream_id]->Get_slot(tr->Stream_id, tr->LPA);
 				sim_time_type timestamp = slot.Timestamp;
 				NVM::memory_content_type content = slot.Content;
+				const FP_type* content_FP = (slot.FP_available ? &slot.FP : NULL);
 				if (tr->DataTimeStamp > timestamp) {
 					timestamp = tr->DataTimeStamp;
 					content = tr->Content;
+					content_FP = FP;
 				}
-				per_stream_cache[tr->Stream_id]->Update_data(tr->Stream_id, tr->LPA, content, timestamp, tr->write_sectors_bitmap | slot.State_bitmap_of_existing_sectors);
+				per_stream_cache[tr->Stream_id]->Update_data(tr->Stream_id, tr->LPA, content, timestamp, tr->write_sectors_bitmap | slot.State_bitmap_of_existing_sectors, content_FP);
 			} else {//the logical address is not in the cache
-				if (!per_stream_cache[tr->Stream_id]->Check_free_slot_availability()) {
-					Data_Cache_Slot_Type evicted_slot = per_stream_cache[tr->Stream_id]->Evict_one_slot_lru();
-					if (evicted_slot.Status == Cache_Slot_Status::DIRTY_NO_FLASH_WRITEBACK) {
-						evicted_cache_slots->push_back(new NVM_Transaction_Flash_WR(Transaction_Source_Type::CACHE,
-							tr->Stream_id, count_sector_no_from_status_bitmap(evicted_slot.State_bitmap_of_existing_sectors) * SECTOR_SIZE_IN_BYTE,
-							evicted_slot.LPA, NULL, IO_Flow_Priority_Class::URGENT, evicted_slot.Content, evicted_slot.State_bitmap_of_existing_sectors, evicted_slot.Timestamp));
-						cache_eviction_read_size_in_sectors += count_sector_no_from_status_bitmap(evicted_slot.State_bitmap_of_existing_sectors);
-						//DEBUG2("Evicting page" << evicted_slot.LPA << " from write buffer ")
-					}
-				}
-				per_stream_cache[tr->Stream_id]->Insert_write_data(tr->Stream_id, tr->LPA, tr->Content, tr->DataTimeStamp, tr->write_sectors_bitmap);
+				per_stream_cache[tr->Stream_id]->Insert_write_data(tr->Stream_id, tr->LPA, tr->Content, tr->DataTimeStamp, tr->write_sectors_bitmap, FP);
 			}
 			dram_write_size_in_sectors += count_sector_no_from_status_bitmap(tr->write_sectors_bitmap);
 			//hot/cold data separation
 			if (bloom_filter[tr->Stream_id].find(tr->LPA) == bloom_filter[tr->Stream_id].end()) {
-				per_stream_cache[tr->Stream_id]->Change_slot_status_to_writeback(tr->Stream_id, tr->LPA); //Eagerly write back cold data
-				flash_written_back_write_size_in_sectors += count_sector_no_from_status_bitmap(tr->write_sectors_bitmap);
 				bloom_filter[user_request->Stream_id].insert(tr->LPA);
-				writeback_transactions.push_back(tr);
+				if (payload_cached) {//The content takes no DRAM page of its own, so it stays until its payload is destaged
+					skipped_writeback_no++;
+				} else {
+					per_stream_cache[tr->Stream_id]->Change_slot_status_to_writeback(tr->Stream_id, tr->LPA); //Eagerly write back cold data
+					flash_written_back_write_size_in_sectors += count_sector_no_from_status_bitmap(tr->write_sectors_bitmap);
+					writeback_transactions.push_back(tr);
+				}
 			}
 			user_request->Transaction_list.erase(it++);
 		}
 		
 		user_request->Sectors_serviced_from_cache += dram_write_size_in_sectors;//This is very important update. It is used to decide when all data sectors of a user request are serviced
-		back_pressure_buffer_depth[queue_id] += cache_eviction_read_size_in_sectors + flash_written_back_write_size_in_sectors;
+		back_pressure_buffer_depth[queue_id] += cache_eviction_read_size_in_sectors + cache_eviction_remap_size_in_sectors + flash_written_back_write_size_in_sectors;
 
 		//Issue memory read for cache evictions
 		if (evicted_cache_slots->size() > 0) {
@@ -342,7 +379,7 @@ namespace SSD_Components
 
 		//If any writeback should be performed, then issue flash write transactions
 		if (writeback_transactions.size() > 0) {
-					static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(writeback_transactions);
+					static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(writeback_transactions);
 		}
 		
 		//Reset control data structures used for hot/cold separation 
@@ -399,22 +436,22 @@ namespace SSD_Components
 					} else  {
 						if (!((Data_Cache_Manager_Flash_Advanced*)_my_instance)->per_stream_cache[transaction->Stream_id]->Check_free_slot_availability()) {
 							std::list<NVM_Transaction*>* evicted_cache_slots = new std::list<NVM_Transaction*>;
-							Data_Cache_Slot_Type evicted_slot = ((Data_Cache_Manager_Flash_Advanced*)_my_instance)->per_stream_cache[transaction->Stream_id]->Evict_one_slot_lru();
-							if (evicted_slot.Status == Cache_Slot_Status::DIRTY_NO_FLASH_WRITEBACK) {
+							std::vector<Data_Cache_Slot_Type> sharing_slots;
+							Data_Cache_Slot_Type evicted_slot = ((Data_Cache_Manager_Flash_Advanced*)_my_instance)->per_stream_cache[transaction->Stream_id]->Evict_one_slot_lru(sharing_slots);
+							unsigned int cache_eviction_remap_size_in_sectors = 0;
+							unsigned int cache_eviction_read_size_in_sectors = ((Data_Cache_Manager_Flash_Advanced*)_my_instance)->destage_evicted_payload(evicted_slot, sharing_slots,
+								transaction->Stream_id, Transaction_Source_Type::USERIO, IO_Flow_Priority_Class::UNDEFINED, *evicted_cache_slots, cache_eviction_remap_size_in_sectors);
+							if (evicted_cache_slots->size() > 0) {
 								Memory_Transfer_Info* transfer_info = new Memory_Transfer_Info;
-								transfer_info->Size_in_bytes = count_sector_no_from_status_bitmap(evicted_slot.State_bitmap_of_existing_sectors) * SECTOR_SIZE_IN_BYTE;
-								evicted_cache_slots->push_back(new NVM_Transaction_Flash_WR(Transaction_Source_Type::USERIO,
-									transaction->Stream_id, transfer_info->Size_in_bytes, evicted_slot.LPA, NULL, IO_Flow_Priority_Class::UNDEFINED, evicted_slot.Content,
-									evicted_slot.State_bitmap_of_existing_sectors, evicted_slot.Timestamp));
+								transfer_info->Size_in_bytes = cache_eviction_read_size_in_sectors * SECTOR_SIZE_IN_BYTE;
 								transfer_info->Related_request = evicted_cache_slots;
 								transfer_info->next_event_type = Data_Cache_Simulation_Event_Type::MEMORY_READ_FOR_CACHE_EVICTION_FINISHED;
 								transfer_info->Stream_id = transaction->Stream_id;
-								unsigned int cache_eviction_read_size_in_sectors = count_sector_no_from_status_bitmap(evicted_slot.State_bitmap_of_existing_sectors);
 								int sharing_id = transaction->Stream_id;
 								if (((Data_Cache_Manager_Flash_Advanced*)_my_instance)->shared_dram_request_queue) {
 									sharing_id = 0;
 								}
-								((Data_Cache_Manager_Flash_Advanced*)_my_instance)->back_pressure_buffer_depth[sharing_id] += cache_eviction_read_size_in_sectors;
+								((Data_Cache_Manager_Flash_Advanced*)_my_instance)->back_pressure_buffer_depth[sharing_id] += cache_eviction_read_size_in_sectors + cache_eviction_remap_size_in_sectors;
 								((Data_Cache_Manager_Flash_Advanced*)_my_instance)->service_dram_access_request(transfer_info);
 							}
 						}
@@ -435,6 +472,11 @@ namespace SSD_Components
 					break;
 				}
 			}
+		} else if (((NVM_Transaction_Flash_WR*)transaction)->Trim) {//** Append for CAFTL: a TRIM is never cached, it completes as an uncached write
+			transaction->UserIORequest->Transaction_list.remove(transaction);
+			if (_my_instance->is_user_request_finished(transaction->UserIORequest)) {
+				_my_instance->broadcast_user_request_serviced_signal(transaction->UserIORequest);
+			}
 		} else {//This is a write request
 			switch (Data_Cache_Manager_Flash_Advanced::caching_mode_per_input_stream[transaction->Stream_id])
 			{
@@ -514,6 +556,52 @@ namespace SSD_Components
 		}
 	}
 
+	const FP_type* Data_Cache_Manager_Flash_Advanced::bind_fingerprint(NVM_Transaction_Flash_WR* transaction)
+	{
+		if (!content_aware) {
+			return NULL;
+		}
+
+		//The cache indexes a payload by the fingerprint of the data it receives; the hash time is still paid once, when the fingerprint engine sees the payload on its way to flash
+		Deduplicator* deduplicator = static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Get_deduplicator(transaction->Stream_id);
+		if (!transaction->FP_available && deduplicator->Has_fingerprint_feed() && deduplicator->Next_fingerprint(transaction->FP)) {
+			transaction->FP_available = true;
+		}
+
+		return transaction->FP_available ? &transaction->FP : NULL;
+	}
+
+	unsigned int Data_Cache_Manager_Flash_Advanced::destage_evicted_payload(const Data_Cache_Slot_Type& evicted_slot, const std::vector<Data_Cache_Slot_Type>& sharing_slots,
+		const stream_id_type stream_id, Transaction_Source_Type source, IO_Flow_Priority_Class::Priority priority, std::list<NVM_Transaction*>& evicted_cache_slots, unsigned int& remap_size_in_sectors)
+	{
+		//Only the first dirty slot of the payload is read from DRAM, the others are written back as duplicates of it
+		unsigned int read_size_in_sectors = 0;
+		bool payload_read = false;
+		for (unsigned int i = 0; i <= sharing_slots.size(); i++) {
+			const Data_Cache_Slot_Type& slot = (i == 0 ? evicted_slot : sharing_slots[i - 1]);
+			if (slot.Status != Cache_Slot_Status::DIRTY_NO_FLASH_WRITEBACK) {
+				continue;
+			}
+			unsigned int size_in_sectors = count_sector_no_from_status_bitmap(slot.State_bitmap_of_existing_sectors);
+			NVM_Transaction_Flash_WR* write = new NVM_Transaction_Flash_WR(source, stream_id, size_in_sectors * SECTOR_SIZE_IN_BYTE,
+				slot.LPA, NULL, priority, slot.Content, slot.State_bitmap_of_existing_sectors, slot.Timestamp);
+			if (slot.FP_available) {
+				write->FP = slot.FP;
+				write->FP_available = true;
+			}
+			evicted_cache_slots.push_back(write);
+			if (payload_read) {
+				remap_size_in_sectors += size_in_sectors;
+				remapped_destage_no++;
+			} else {
+				read_size_in_sectors += size_in_sectors;
+				payload_read = true;
+			}
+		}
+
+		return read_size_in_sectors;
+	}
+
 	void Data_Cache_Manager_Flash_Advanced::service_dram_access_request(Memory_Transfer_Info* request_info)
 	{
 		if (memory_channel_is_busy) {
@@ -545,9 +633,27 @@ namespace SSD_Components
 					broadcast_user_request_serviced_signal(((User_Request*)(transfer_info)->Related_request));
 				break;
 			case Data_Cache_Simulation_Event_Type::MEMORY_READ_FOR_CACHE_EVICTION_FINISHED://Reading data from DRAM and writing it back to the flash storage
-				static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(*((std::list<NVM_Transaction*>*)(transfer_info->Related_request)));
-				delete (std::list<NVM_Transaction*>*)transfer_info->Related_request;
+			{
+				std::list<NVM_Transaction*>* evicted_cache_slots = (std::list<NVM_Transaction*>*)transfer_info->Related_request;
+				std::list<NVM_Transaction*> remap_transactions;
+				if (content_aware) {//Only the first write of a payload is fingerprinted, the others are known duplicates of it
+					std::unordered_set<FP_type, FP_Hasher> destaged_payloads;
+					for (auto it = evicted_cache_slots->begin(); it != evicted_cache_slots->end();) {
+						NVM_Transaction_Flash_WR* write = (NVM_Transaction_Flash_WR*)(*it);
+						if (write->FP_available && !destaged_payloads.insert(write->FP).second) {
+							remap_transactions.splice(remap_transactions.end(), *evicted_cache_slots, it++);
+						} else {
+							it++;
+						}
+					}
+				}
+				static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(*evicted_cache_slots);
+				if (remap_transactions.size() > 0) {
+					static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(remap_transactions);
+				}
+				delete evicted_cache_slots;
 				break;
+			}
 			case Data_Cache_Simulation_Event_Type::MEMORY_WRITE_FOR_CACHE_FINISHED://The recently read data from flash is written back to memory to support future user read requests
 				break;
 		}
@@ -9,6 +9,7 @@
 #include "Data_Cache_Manager_Base.h"
 #include "Data_Cache_Flash.h"
 #include "NVM_Transaction_Flash.h"
+#include "NVM_Transaction_Flash_WR.h"
 
 namespace SSD_Components
 {
@@ -33,7 +34,7 @@ namespace SSD_Components
 			unsigned int total_capacity_in_bytes,
 			unsigned int dram_row_size, unsigned int dram_data_rate, unsigned int dram_busrt_size, sim_time_type dram_tRCD, sim_time_type dram_tCL, sim_time_type dram_tRP,
 			Caching_Mode* caching_mode_per_input_stream, Cache_Sharing_Mode sharing_mode, 
-			unsigned int stream_count, unsigned int sector_no_per_page, unsigned int back_pressure_buffer_max_depth);
+			unsigned int stream_count, unsigned int sector_no_per_page, unsigned int back_pressure_buffer_max_depth, bool content_aware);
 		~Data_Cache_Manager_Flash_Advanced();
 		void Execute_simulator_event(MQSimEngine::Sim_Event* ev);
 		void Setup_triggers();
@@ -56,6 +57,13 @@ namespace SSD_Components
 		std::set<LPA_type>* bloom_filter;
 		sim_time_type bloom_filter_reset_step = 1000000000;
 		sim_time_type next_bloom_filter_reset_milestone = 0;
+		//** Append for CAFTL: content-aware write caching
+		bool content_aware;
+		size_t skipped_writeback_no;//Eager writebacks of cold data that were not needed, since the content was already cached
+		size_t remapped_destage_no;//Evicted slots that were destaged without a DRAM read or a fingerprint
+		const FP_type* bind_fingerprint(NVM_Transaction_Flash_WR* transaction);
+		unsigned int destage_evicted_payload(const Data_Cache_Slot_Type& evicted_slot, const std::vector<Data_Cache_Slot_Type>& sharing_slots, const stream_id_type stream_id,
+			Transaction_Source_Type source, IO_Flow_Priority_Class::Priority priority, std::list<NVM_Transaction*>& evicted_cache_slots, unsigned int& remap_size_in_sectors);
 
 		static void handle_transaction_serviced_signal_from_PHY(NVM_Transaction_Flash* transaction);
 		void service_dram_access_request(Memory_Transfer_Info* request_info);
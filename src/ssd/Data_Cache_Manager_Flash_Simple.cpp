@@ -4,6 +4,7 @@
 #include "NVM_Transaction_Flash_RD.h"
 #include "NVM_Transaction_Flash_WR.h"
 #include "FTL.h"
+#include "Fingerprint_Engine.h"
 
 namespace SSD_Components
 {
@@ -56,6 +57,15 @@ namespace SSD_Components
 		if (user_request->Transaction_list.size() == 0) {
 			return;
 		}
+
+		//** Append for CAFTL: a TRIM drops its sectors from the cache and goes to the mapping unit without being fingerprinted
+		if (user_request->Type == UserRequestType::TRIM) {
+			for (auto tr = user_request->Transaction_list.begin(); tr != user_request->Transaction_list.end(); tr++) {
+				data_cache->Trim_data((*tr)->Stream_id, ((NVM_Transaction_Flash_WR*)(*tr))->LPA, ((NVM_Transaction_Flash_WR*)(*tr))->write_sectors_bitmap);
+			}
+			static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(user_request->Transaction_list);
+			return;
+		}
 		
 		if (user_request->Type == UserRequestType::READ) {
 			switch (caching_mode_per_input_stream[user_request->Stream_id])
@@ -105,7 +115,7 @@ namespace SSD_Components
 			switch (caching_mode_per_input_stream[user_request->Stream_id])
 			{
 				case Caching_Mode::TURNED_OFF:
-					static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(user_request->Transaction_list);
+					static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(user_request->Transaction_list);
 					return;
 				case Caching_Mode::WRITE_CACHE://The data cache manger unit performs like a destage buffer
 				{
@@ -197,7 +207,7 @@ namespace SSD_Components
 
 		//If any writeback should be performed, then issue flash write transactions
 		if (writeback_transactions.size() > 0) {
-			static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(writeback_transactions);
+			static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(writeback_transactions);
 		}
 
 		//Reset control data structures used for hot/cold separation 
@@ -235,6 +245,11 @@ namespace SSD_Components
 				default:
 					PRINT_ERROR("The specified caching mode is not not support in simple cache manager!")
 			}
+		} else if (((NVM_Transaction_Flash_WR*)transaction)->Trim) {//** Append for CAFTL: a TRIM is never cached, it completes as an uncached write
+			transaction->UserIORequest->Transaction_list.remove(transaction);
+			if (_my_instance->is_user_request_finished(transaction->UserIORequest)) {
+				_my_instance->broadcast_user_request_serviced_signal(transaction->UserIORequest);
+			}
 		} else { //This is a write request
 			switch (Data_Cache_Manager_Flash_Simple::caching_mode_per_input_stream[transaction->Stream_id])
 			{
@@ -305,7 +320,7 @@ namespace SSD_Components
 				}
 				break;
 			case Data_Cache_Simulation_Event_Type::MEMORY_READ_FOR_CACHE_EVICTION_FINISHED://Reading data from DRAM and writing it back to the flash storage
-				static_cast<FTL*>(nvm_firmware)->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(*((std::list<NVM_Transaction*>*)(transfer_inf->Related_request)));
+				static_cast<FTL*>(nvm_firmware)->Fingerprint_engine->Submit_write_transactions(*((std::list<NVM_Transaction*>*)(transfer_inf->Related_request)));
 				delete (std::list<NVM_Transaction*>*)transfer_inf->Related_request;
 				break;
 			case Data_Cache_Simulation_Event_Type::MEMORY_WRITE_FOR_CACHE_FINISHED://The recently read data from flash is written back to memory to support future user read requests
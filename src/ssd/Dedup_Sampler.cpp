@@ -0,0 +1,90 @@
+#include <cstring>
+#include "Dedup_Sampler.h"
+#include "Fingerprint_Cache.h"
+
+namespace SSD_Components
+{
+	Dedup_Sampler::Dedup_Sampler(unsigned int unit_size, Dedup_Sampling_Rule rule, bool prehash_enabled) :
+		Page_no(0), Full_hash_no(0), Weak_hash_no(0), Deferred_hash_no(0), Skipped_page_no(0), Missed_dup_no(0),
+		unit_size(unit_size), rule(rule), prehash_enabled(prehash_enabled), placeholder_no(0)
+	{
+		if (this->unit_size == 0)
+			this->unit_size = 1;
+	}
+
+	uint32_t Dedup_Sampler::weak_hash(const FP_type& FP)
+	{
+		//The trace only carries the strong fingerprint, so the weak hash is folded from it. Folding keeps
+		//the property that matters: equal pages always have equal weak hashes.
+		uint64_t hash = FP_Hasher()(FP);
+		return (uint32_t)(hash ^ (hash >> 32));
+	}
+
+	//Returns true if the full fingerprint of the page is computed now
+	bool Dedup_Sampler::fingerprint(const FP_type& FP)
+	{
+		if (!prehash_enabled) {
+			Full_hash_no++;
+			return true;
+		}
+
+		auto it = weak_hash_table.find(weak_hash(FP));
+		if (it == weak_hash_table.end()) {
+			weak_hash_table[weak_hash(FP)] = 1;
+			return false;
+		}
+
+		Full_hash_no += 1 + it->second;
+		Deferred_hash_no += it->second;
+		it->second = 0;
+		return true;
+	}
+
+	void Dedup_Sampler::make_placeholder(FP_type& FP)
+	{
+		//A placeholder is twelve 0xff bytes followed by a counter, which no real digest of the trace is expected to be
+		std::memset(FP.Digest, 0xff, FP_DIGEST_SIZE);
+		placeholder_no++;
+		for (unsigned int i = 0; i < sizeof(placeholder_no) && i < FP_DIGEST_SIZE; i++)
+			FP.Digest[FP_DIGEST_SIZE - 1 - i] = (uint8_t)(placeholder_no >> (8 * i));
+	}
+
+	void Dedup_Sampler::Sample(std::vector<FP_type*>& unit, FP_Index& fp_table, unsigned int& full_hash_no, unsigned int& weak_hash_no)
+	{
+		size_t full_before = Full_hash_no;
+		Page_no += unit.size();
+		weak_hash_no = 0;
+		if (prehash_enabled || (rule == Dedup_Sampling_Rule::CONTENT && unit.size() > 1))
+			weak_hash_no = (unsigned int)unit.size();
+		Weak_hash_no += weak_hash_no;
+
+		if (unit.size() == 1 || unit_size == 1) {
+			for (auto fp : unit)
+				fingerprint(*fp);
+			full_hash_no = (unsigned int)(Full_hash_no - full_before);
+			return;
+		}
+
+		size_t sample = 0;
+		if (rule == Dedup_Sampling_Rule::CONTENT) {
+			for (size_t i = 1; i < unit.size(); i++)
+				if (weak_hash(*unit[i]) < weak_hash(*unit[sample]))
+					sample = i;
+		}
+
+		bool sample_is_dup = fingerprint(*unit[sample]) && fp_table.Find(*unit[sample]) != NULL;
+		for (size_t i = 0; i < unit.size(); i++) {
+			if (i == sample)
+				continue;
+			if (sample_is_dup) {
+				fingerprint(*unit[i]);
+			} else {
+				if (fp_table.Find(*unit[i]) != NULL)
+					Missed_dup_no++;
+				Skipped_page_no++;
+				make_placeholder(*unit[i]);
+			}
+		}
+		full_hash_no = (unsigned int)(Full_hash_no - full_before);
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef DEDUP_SAMPLER_H
+#define DEDUP_SAMPLER_H
+
+#include <vector>
+#include <unordered_map>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Fingerprint_Index.h"
+
+namespace SSD_Components
+{
+	enum class Dedup_Sampling_Rule { FIRST, CONTENT };
+
+	/*
+	* Sampling and pre-hashing of the CAFTL deduplicator (Append for CAFTL).
+	* Sampling: the pages of a write request are split into sampling units of Unit_size pages and only one
+	* sample page per unit is fingerprinted first. The rest of the unit is fingerprinted only if the sample
+	* is a duplicate, otherwise the pages are written without a fingerprint and their dedup opportunity is lost.
+	* The sample is either the first page of the unit or the page with the smallest weak hash (CONTENT), so
+	* that shifted copies of the same data pick the same sample.
+	* Pre-hashing: a cheap weak hash is computed before the full fingerprint. A page whose weak hash has never
+	* been seen cannot be a duplicate, so its full fingerprint is deferred until another page with the same weak
+	* hash shows up. Pre-hashing never loses a duplicate, it only moves hash work around.
+	*/
+	class Dedup_Sampler
+	{
+	public:
+		Dedup_Sampler(unsigned int unit_size, Dedup_Sampling_Rule rule, bool prehash_enabled);
+		//Decides which fingerprints of a sampling unit are computed. Fingerprints that are not computed are
+		//replaced by unique placeholders, so the pages are written as unique chunks.
+		void Sample(std::vector<FP_type*>& unit, FP_Index& fp_table, unsigned int& full_hash_no, unsigned int& weak_hash_no);
+		unsigned int Get_unit_size() { return unit_size; }
+		Dedup_Sampling_Rule Get_rule() { return rule; }
+		bool Is_prehash_enabled() { return prehash_enabled; }
+
+		size_t Page_no;//Pages that went through the sampler
+		size_t Full_hash_no;//Full fingerprints computed, including deferred ones
+		size_t Weak_hash_no;
+		size_t Deferred_hash_no;//Full fingerprints computed late for pages that were only weak hashed when written
+		size_t Skipped_page_no;//Pages written without a fingerprint because their sample was unique
+		size_t Missed_dup_no;//Skipped pages whose fingerprint was already in the fingerprint table, i.e., lost duplicates
+	private:
+		unsigned int unit_size;
+		Dedup_Sampling_Rule rule;
+		bool prehash_enabled;
+		std::unordered_map<uint32_t, unsigned int> weak_hash_table;//Weak hash -> pages with that weak hash that still wait for their full fingerprint
+		uint64_t placeholder_no;
+		uint32_t weak_hash(const FP_type& FP);
+		bool fingerprint(const FP_type& FP);
+		void make_placeholder(FP_type& FP);
+	};
+}
+
+#endif // !DEDUP_SAMPLER_H
@@ -0,0 +1,435 @@
+#include <cstring>
+#include "Deduplicator.h"
+
+namespace SSD_Components
+{
+	Deduplicator::Deduplicator(const std::string& fingerprint_file_path, unsigned int fp_cache_capacity,
+		FP_Cache_Replacement_Policy fp_cache_policy, unsigned int fp_bucket_no,
+		unsigned int sampling_unit, Dedup_Sampling_Rule sampling_rule, bool prehash_enabled, Dedup_Mode mode) :
+		Total_chunk_no(0), Dup_chunk_no(0), Total_fp_no(0), Total_page_write_no(0), GC_page_write_no(0), GC_shared_page_write_no(0),
+		FPcache(NULL), FP_bucket_reads(0), FP_bucket_writes(0), Filter(NULL), FP_bucket_reads_filtered(0), SMTcache(NULL), Sampler(NULL), Mode(mode),
+		Background_read_no(0), GC_piggyback_no(0), Background_merge_no(0), Dropped_pending_no(0),
+		Batch_no(0), Batch_write_no(0), Batch_dup_no(0), Chunks(NULL), Chunk_page_program_no(0), Partial_chunk_write_no(0),
+		Chunk_merge_read_no(0), Fragment_read_no(0), Buffered_chunk_read_no(0), Unique_chunk_sector_no(0), Compressed_chunk_sector_no(0),
+		GC_compacted_page_no(0), GC_compacted_chunk_no(0), Trim_page_no(0), Trim_released_no(0), Trim_freed_no(0),
+		GC_dedup_enabled(false), GC_hash_no(0), GC_merge_no(0), Verify_enabled(false), Verify_read_no(0), Verify_time(0), Cross_stream_dup_no(0), Content(NULL),
+		tables(new Dedup_Tables()), global(false), stream_id(0), placeholder_no(0)
+	{
+		tables->User_no = 1;
+		if (sampling_unit > 1 || prehash_enabled)
+			Sampler = new Dedup_Sampler(sampling_unit, sampling_rule, prehash_enabled);
+		if (fp_cache_capacity > 0)
+			FPcache = new Fingerprint_Cache(fp_cache_capacity, fp_cache_policy, fp_bucket_no);
+		if (fingerprint_file_path != "" && !fp_feed.Open(fingerprint_file_path))
+			PRINT_ERROR("Fail to open fingerprint input: " << fingerprint_file_path)
+		Total_fp_no = fp_feed.Total_fingerprints();
+	}
+
+	Deduplicator::~Deduplicator()
+	{
+		fp_feed.Close();
+		delete FPcache;
+		if (--tables->User_no == 0) {
+			delete tables;
+			delete Filter;
+		}
+		delete SMTcache;
+		delete Sampler;
+		delete Chunks;
+		delete Content;
+	}
+
+	ChunkInfo* Deduplicator::Find_chunk(const FP_type &FP)
+	{
+		return tables->FPtable.Find(FP);
+	}
+
+	ChunkInfo* Deduplicator::Find_or_insert_chunk(const FP_type &FP, bool &inserted)
+	{
+		if (Filter == NULL)
+			return tables->FPtable.Find_or_insert(FP, inserted);
+
+		bool rejected = !Filter->Contains(FP);
+		ChunkInfo* chunk = tables->FPtable.Find_or_insert(FP, inserted);
+		Filter->Lookup_no++;
+		if (rejected)
+			Filter->Negative_no++;
+		else if (inserted)
+			Filter->False_positive_no++;
+		if (inserted)
+			Filter->Insert(FP);
+		return chunk;
+	}
+
+	void Deduplicator::Prefetch_chunk(const FP_type &FP)
+	{
+		tables->FPtable.Prefetch(FP);
+	}
+
+	void Deduplicator::Remove_chunk(const FP_type &FP)
+	{
+		if (!tables->FPtable.Erase(FP))
+			PRINT_ERROR("This chunk is not in Fingerprint Table")
+		if (global)
+			tables->Stream_refs.erase(FP);
+		if (skipped_chunks.size() > 0)//A skipped chunk that is overwritten before GC reaches it is never fingerprinted
+			skipped_chunks.erase(FP);
+	}
+
+	void Deduplicator::Print_FPtable()
+	{
+		std::cout << "========== Print FP table =================\n";
+		if (tables->FPtable.Size() == 0)
+			std::cout << "(Empty)\n";
+		tables->FPtable.For_each([](const FP_type &FP, const ChunkInfo &chunk) {
+			std::cout << "{FP: " << FP << ", ref: " << chunk.ref << ", PPA: " << chunk.PPA << "}\n";
+		});
+	}
+
+	bool Deduplicator::In_FPtable(const FP_type &FP)
+	{
+		return tables->FPtable.Find(FP) != NULL;
+	}
+
+	float Deduplicator::Get_DedupRate()
+	{
+		return float (Dup_chunk_no) / (Total_chunk_no);
+	}
+
+	size_t Deduplicator::Get_FPtable_size()
+	{
+		return tables->FPtable.Size();
+	}
+
+	bool Deduplicator::In_SMT(VPA_type VPA)
+	{
+		return tables->SMT.Contains(VPA);
+	}
+
+	SMTEntryType Deduplicator::Get_SMTEntry(VPA_type VPA)
+	{
+		if (!tables->SMT.Contains(VPA))
+		{
+			PRINT_MESSAGE(VPA);
+			Print_SMT();
+			PRINT_ERROR("This VPA is not in SMT")
+		}
+		return tables->SMT.Get(VPA);
+	}
+
+	void Deduplicator::Insert_SMT(VPA_type VPA, PPA_type PPA)
+	{
+		SMTEntryType entry = { PPA };
+		tables->SMT.Insert(VPA, entry);
+	}
+
+	void Deduplicator::Update_SMT(VPA_type VPA, PPA_type PPA)
+	{
+		if (!tables->SMT.Update(VPA, PPA))
+			PRINT_ERROR("No PPA found in SMT!");
+	}
+
+	void Deduplicator::Remove_SMT(VPA_type VPA)
+	{
+		tables->SMT.Erase(VPA);
+	}
+
+	VPA_type Deduplicator::Assign_VPA(PPA_type PPA)
+	{
+		return tables->SMT.Find_free_VPA(PPA_TO_VPA(PPA));
+	}
+
+	size_t Deduplicator::Get_SMT_size()
+	{
+		return tables->SMT.Size();
+	}
+
+	void Deduplicator::Print_SMT()
+	{
+		std::cout << "========== Print SMT ======================\n";
+		if (tables->SMT.Size() == 0)
+			std::cout << "(Empty)\n";
+		tables->SMT.For_each([](VPA_type VPA, const SMTEntryType &entry) {
+			std::cout << "{VPN: " << VPA << ", PPN: " << entry.PPA << "}\n";
+		});
+	}
+
+	bool Deduplicator::Next_fingerprint(FP_type &FP)
+	{
+		uint32_t compressed_size;
+		return Next_fingerprint(FP, compressed_size);
+	}
+
+	bool Deduplicator::Next_fingerprint(FP_type &FP, uint32_t &compressed_size)
+	{
+		compressed_size = 0;
+		if (Content != NULL) {
+			Content->Next(FP, compressed_size);
+			return true;
+		}
+		return fp_feed.Next(FP);
+	}
+
+	bool Deduplicator::Has_fingerprint_feed()
+	{
+		return fp_feed.Is_open() || Content != NULL;
+	}
+
+	bool Deduplicator::Sample_unit(std::vector<FP_type*>& unit, unsigned int& full_hash_no, unsigned int& weak_hash_no)
+	{
+		if (Sampler == NULL)
+			return false;
+		if (!GC_dedup_enabled) {
+			Sampler->Sample(unit, tables->FPtable, full_hash_no, weak_hash_no);
+			return true;
+		}
+
+		//The sampler replaces the fingerprints it skips, the real ones are kept for GC
+		std::vector<FP_type> real_fps;
+		real_fps.reserve(unit.size());
+		for (auto fp : unit)
+			real_fps.push_back(*fp);
+		Sampler->Sample(unit, tables->FPtable, full_hash_no, weak_hash_no);
+		for (size_t i = 0; i < unit.size(); i++)
+			if (*unit[i] != real_fps[i])
+				skipped_chunks[*unit[i]] = real_fps[i];
+		return true;
+	}
+
+	void Deduplicator::Make_placeholder(FP_type &FP)
+	{
+		//Twelve 0xfe bytes followed by a counter, so they never collide with real digests or with the placeholders of the sampler
+		std::memset(FP.Digest, 0xfe, FP_DIGEST_SIZE);
+		placeholder_no++;
+		for (unsigned int i = 0; i < sizeof(placeholder_no) && i < FP_DIGEST_SIZE; i++)
+			FP.Digest[FP_DIGEST_SIZE - 1 - i] = (uint8_t)(placeholder_no >> (8 * i));
+	}
+
+	void Deduplicator::Add_pending_chunk(const FP_type &placeholder, const FP_type &FP)
+	{
+		pending_chunks[placeholder] = FP;
+		pending_queue.push_back(placeholder);
+	}
+
+	bool Deduplicator::Get_pending_chunk(const FP_type &placeholder, FP_type &FP)
+	{
+		auto it = pending_chunks.find(placeholder);
+		if (it == pending_chunks.end())
+			return false;
+		FP = it->second;
+		return true;
+	}
+
+	void Deduplicator::Remove_pending_chunk(const FP_type &placeholder)
+	{
+		pending_chunks.erase(placeholder);
+	}
+
+	bool Deduplicator::Next_pending_chunk(FP_type &placeholder)
+	{
+		while (pending_queue.size() > 0) {
+			placeholder = pending_queue.front();
+			pending_queue.pop_front();
+			if (pending_chunks.find(placeholder) == pending_chunks.end())
+				continue;//Already fingerprinted, e.g., by GC
+			if (tables->FPtable.Find(placeholder) == NULL) {//The page was overwritten before it was fingerprinted
+				pending_chunks.erase(placeholder);
+				Dropped_pending_no++;
+				continue;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void Deduplicator::Requeue_pending_chunk(const FP_type &placeholder)
+	{
+		pending_queue.push_back(placeholder);
+	}
+
+	size_t Deduplicator::Get_pending_chunk_no()
+	{
+		return pending_chunks.size();
+	}
+
+	bool Deduplicator::Get_skipped_chunk(const FP_type &placeholder, FP_type &FP)
+	{
+		auto it = skipped_chunks.find(placeholder);
+		if (it == skipped_chunks.end())
+			return false;
+		FP = it->second;
+		return true;
+	}
+
+	void Deduplicator::Remove_skipped_chunk(const FP_type &placeholder)
+	{
+		skipped_chunks.erase(placeholder);
+	}
+
+	size_t Deduplicator::Get_skipped_chunk_no()
+	{
+		return skipped_chunks.size();
+	}
+
+	void Deduplicator::Join_global_domain(Deduplicator* owner, stream_id_type stream_id)
+	{
+		if (owner != this) {
+			if (--tables->User_no == 0) {
+				delete tables;
+				delete Filter;
+			}
+			tables = owner->tables;
+			tables->User_no++;
+			Filter = owner->Filter;
+		}
+		global = true;
+		this->stream_id = stream_id;
+	}
+
+	bool Deduplicator::In_global_domain()
+	{
+		return global;
+	}
+
+	uint32_t Deduplicator::Add_stream_reference(const FP_type &FP)
+	{
+		if (!global)
+			return 0;
+		std::vector<uint32_t>& refs = tables->Stream_refs[FP];
+		if (refs.size() <= stream_id)
+			refs.resize(stream_id + 1, 0);
+		return refs[stream_id]++;
+	}
+
+	void Deduplicator::Remove_stream_reference(const FP_type &FP)
+	{
+		if (!global)
+			return;
+		auto it = tables->Stream_refs.find(FP);
+		if (it == tables->Stream_refs.end() || it->second.size() <= stream_id || it->second[stream_id] == 0)
+			PRINT_ERROR("The stream holds no reference to this chunk")
+		it->second[stream_id]--;
+	}
+
+	void Deduplicator::Get_cross_stream_sharing(size_t &shared_chunk_no, size_t &excess_copy_no)
+	{
+		shared_chunk_no = 0;
+		excess_copy_no = 0;
+		for (auto& chunk : tables->Stream_refs) {
+			size_t referencing_stream_no = 0;
+			for (auto ref : chunk.second)
+				if (ref > 0)
+					referencing_stream_no++;
+			if (referencing_stream_no > 1) {
+				shared_chunk_no++;
+				excess_copy_no += referencing_stream_no - 1;
+			}
+		}
+	}
+
+	void Deduplicator::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Begin_section("DEDU");
+		writer.Write(global);
+		bool saves_tables = !global || stream_id == 0;//The shared tables of a global dedup domain are saved once, with stream 0
+		if (saves_tables) {
+			writer.Write((uint64_t)tables->FPtable.Size());
+			tables->FPtable.For_each([&writer](const FP_type &FP, const ChunkInfo &chunk) {
+				writer.Write(FP);
+				writer.Write(chunk);
+			});
+			writer.Write((uint64_t)tables->SMT.Size());
+			tables->SMT.For_each([&writer](VPA_type VPA, const SMTEntryType &entry) {
+				writer.Write(VPA);
+				writer.Write(entry);
+			});
+			writer.Write((uint64_t)tables->Stream_refs.size());
+			for (auto& chunk : tables->Stream_refs) {
+				writer.Write(chunk.first);
+				writer.Write_vector(chunk.second);
+			}
+		}
+
+		writer.Write(placeholder_no);
+		writer.Write((uint64_t)pending_chunks.size());
+		for (auto& chunk : pending_chunks) {
+			writer.Write(chunk.first);
+			writer.Write(chunk.second);
+		}
+		writer.Write((uint64_t)pending_queue.size());
+		for (auto& placeholder : pending_queue)
+			writer.Write(placeholder);
+		writer.Write((uint64_t)skipped_chunks.size());
+		for (auto& chunk : skipped_chunks) {
+			writer.Write(chunk.first);
+			writer.Write(chunk.second);
+		}
+
+		writer.Write(FPcache != NULL);
+		if (FPcache != NULL)
+			FPcache->Save_checkpoint(writer);
+		writer.Write(Filter != NULL && saves_tables);
+		if (Filter != NULL && saves_tables)
+			Filter->Save_checkpoint(writer);
+		writer.Write(SMTcache != NULL);
+		if (SMTcache != NULL)
+			SMTcache->Save_checkpoint(writer);
+		writer.Write(Chunks != NULL);
+		if (Chunks != NULL)
+			Chunks->Save_checkpoint(writer);
+	}
+
+	void Deduplicator::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Begin_section("DEDU");
+		reader.Expect(global, "Global_Dedup_Enabled");
+		bool loads_tables = !global || stream_id == 0;
+		uint64_t entry_no;
+		if (loads_tables) {
+			entry_no = reader.Read<uint64_t>();
+			for (uint64_t i = 0; i < entry_no; i++) {
+				FP_type FP = reader.Read<FP_type>();
+				bool inserted;
+				*tables->FPtable.Find_or_insert(FP, inserted) = reader.Read<ChunkInfo>();
+			}
+			entry_no = reader.Read<uint64_t>();
+			for (uint64_t i = 0; i < entry_no; i++) {
+				VPA_type VPA = reader.Read<VPA_type>();
+				tables->SMT.Insert(VPA, reader.Read<SMTEntryType>());
+			}
+			entry_no = reader.Read<uint64_t>();
+			for (uint64_t i = 0; i < entry_no; i++) {
+				FP_type FP = reader.Read<FP_type>();
+				reader.Read_vector(tables->Stream_refs[FP]);
+			}
+		}
+
+		placeholder_no = reader.Read<uint64_t>();
+		entry_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < entry_no; i++) {
+			FP_type placeholder = reader.Read<FP_type>();
+			pending_chunks[placeholder] = reader.Read<FP_type>();
+		}
+		entry_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < entry_no; i++)
+			pending_queue.push_back(reader.Read<FP_type>());
+		entry_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < entry_no; i++) {
+			FP_type placeholder = reader.Read<FP_type>();
+			skipped_chunks[placeholder] = reader.Read<FP_type>();
+		}
+
+		reader.Expect(FPcache != NULL, "FP_Cache_Capacity");
+		if (FPcache != NULL)
+			FPcache->Load_checkpoint(reader);
+		reader.Expect(Filter != NULL && loads_tables, "FP_Filter_Size");
+		if (Filter != NULL && loads_tables)
+			Filter->Load_checkpoint(reader);
+		reader.Expect(SMTcache != NULL, "SMT_Cache_Capacity");
+		if (SMTcache != NULL)
+			SMTcache->Load_checkpoint(reader);
+		reader.Expect(Chunks != NULL, "Dedup_Chunk_Size or Compression_Enabled");
+		if (Chunks != NULL)
+			Chunks->Load_checkpoint(reader);
+	}
+}
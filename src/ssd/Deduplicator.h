@@ -0,0 +1,168 @@
+#ifndef DEDUPLICATOR_H
+#define DEDUPLICATOR_H
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Fingerprint_Index.h"
+#include "Fingerprint_Feed.h"
+#include "Secondary_Mapping_Table.h"
+#include "Fingerprint_Cache.h"
+#include "SMT_Cache.h"
+#include "Dedup_Sampler.h"
+#include "Chunk_Store.h"
+#include "Content_Generator.h"
+#include "Fingerprint_Filter.h"
+
+namespace SSD_Components
+{
+	enum class Dedup_Mode { INLINE, OUT_OF_LINE };
+
+	/*
+	* Tables of a dedup domain (Append for CAFTL). Each stream has its own, unless the device forms a global dedup
+	* domain: the deduplicators of all streams then share the tables of stream 0, and Stream_refs counts the
+	* references of each stream to each chunk of the fingerprint index.
+	*/
+	struct Dedup_Tables
+	{
+		FP_Index FPtable;
+		Secondary_Mapping_Table SMT;
+		std::unordered_map<FP_type, std::vector<uint32_t>, FP_Hasher> Stream_refs;//Fingerprint -> references of each stream, only kept in a global dedup domain
+		unsigned int User_no;//Deduplicators that use the tables, the last one deletes them (and the fingerprint filter)
+	};
+
+	/*
+	* Dedup context of one address mapping domain (Append for CAFTL). It owns every piece of CAFTL
+	* state that is not tied to a physical page: the fingerprint index, the Secondary Mapping Table,
+	* the fingerprint feed of the stream and the dedup statistics. With a bounded fingerprint store, FPcache
+	* tracks which fingerprints are resident in DRAM; the rest live in fingerprint bucket pages on flash.
+	* With a bounded SMT cache, SMTcache tracks which SMT entries are resident in DRAM; the rest live in SMT pages on flash.
+	* With a fingerprint filter, Filter answers most lookups of new fingerprints before the index is searched.
+	* With sampling or pre-hashing, Sampler decides which written pages get a full fingerprint at all.
+	* In OUT_OF_LINE mode, writes are programmed under a placeholder fingerprint and wait in the pending
+	* chunk queue until they are fingerprinted in the background and merged with an existing chunk.
+	* With GC dedup, the real fingerprints of the pages that sampling wrote under a placeholder are kept as
+	* skipped chunks, so that GC can fingerprint such a page when it moves it and merge it if it is a duplicate.
+	* Per-page reverse mapping lives in the OOB area of the flash blocks (see Block_Pool_Slot_Type::OOB).
+	* With chunks smaller than a page, Chunks maps logical chunks to stored chunks and the fingerprint index
+	* gives the chunk ID of each fingerprint in place of a PPA.
+	* With a global dedup domain, the tables are shared with the deduplicators of the other streams, while the
+	* fingerprint feed, the pending and skipped chunks and the statistics stay per stream.
+	* Nothing here is static, so each domain (or each simulated device) starts from an empty context.
+	*/
+	class Deduplicator
+	{
+	public:
+		Deduplicator(const std::string& fingerprint_file_path, unsigned int fp_cache_capacity = 0,
+			FP_Cache_Replacement_Policy fp_cache_policy = FP_Cache_Replacement_Policy::LRU, unsigned int fp_bucket_no = 0,
+			unsigned int sampling_unit = 1, Dedup_Sampling_Rule sampling_rule = Dedup_Sampling_Rule::FIRST, bool prehash_enabled = false,
+			Dedup_Mode mode = Dedup_Mode::INLINE);
+		~Deduplicator();
+		ChunkInfo* Find_chunk(const FP_type &FP);//** NULL if this FP is not in the table
+		ChunkInfo* Find_or_insert_chunk(const FP_type &FP, bool &inserted);//** Single probe per write, a new entry has ref == 0
+		void Prefetch_chunk(const FP_type &FP);//** Issued for a whole dispatch batch before its writes are deduplicated one by one
+		void Remove_chunk(const FP_type &FP);
+		void Print_FPtable();
+		bool In_FPtable(const FP_type &FP);//** Check if this FP exists in hash table
+		float Get_DedupRate();
+		size_t Get_FPtable_size();
+
+		//** CAFTL 2-level mapping, the PMT of the domain maps shared LPAs to VPAs and the SMT maps VPAs to PPAs
+		bool In_SMT(VPA_type VPA);
+		SMTEntryType Get_SMTEntry(VPA_type VPA);
+		void Insert_SMT(VPA_type VPA, PPA_type PPA);
+		void Update_SMT(VPA_type VPA, PPA_type PPA);
+		void Remove_SMT(VPA_type VPA);
+		VPA_type Assign_VPA(PPA_type PPA);//The VPA of a chunk that becomes shared at PPA
+		size_t Get_SMT_size();
+		void Print_SMT();
+
+		bool Next_fingerprint(FP_type &FP);//** Reads the next fingerprint of the feed (or of the content generator), false when the feed is exhausted
+		bool Next_fingerprint(FP_type &FP, uint32_t &compressed_size);//** Also gives the compressed size in bytes of the content, 0 if unknown
+		bool Has_fingerprint_feed();
+		//** Applies sampling and pre-hashing to the fingerprints of a sampling unit, false if every page is simply fully fingerprinted
+		bool Sample_unit(std::vector<FP_type*>& unit, unsigned int& full_hash_no, unsigned int& weak_hash_no);
+
+		//** Out-of-line dedup, a pending chunk is a chunk that is stored under a placeholder and still waits for its real fingerprint
+		void Make_placeholder(FP_type &FP);
+		void Add_pending_chunk(const FP_type &placeholder, const FP_type &FP);
+		bool Get_pending_chunk(const FP_type &placeholder, FP_type &FP);//false if the chunk is not pending
+		void Remove_pending_chunk(const FP_type &placeholder);
+		bool Next_pending_chunk(FP_type &placeholder);//Oldest pending chunk that is still stored, false if there is none
+		void Requeue_pending_chunk(const FP_type &placeholder);//Puts a chunk taken by Next_pending_chunk back to the end of the queue
+		size_t Get_pending_chunk_no();
+
+		//** GC dedup, a skipped chunk is a chunk that sampling stored under a placeholder, it waits for GC to fingerprint it
+		bool Get_skipped_chunk(const FP_type &placeholder, FP_type &FP);//false if the chunk was not skipped or already fingerprinted
+		void Remove_skipped_chunk(const FP_type &placeholder);
+		size_t Get_skipped_chunk_no();
+
+		//** Global dedup domain, the deduplicator of every stream joins the one of stream 0 (which joins itself)
+		void Join_global_domain(Deduplicator* owner, stream_id_type stream_id);
+		bool In_global_domain();
+		uint32_t Add_stream_reference(const FP_type &FP);//Returns the references the stream held before, 0 outside a global domain
+		void Remove_stream_reference(const FP_type &FP);
+		void Get_cross_stream_sharing(size_t &shared_chunk_no, size_t &excess_copy_no);//Chunks referenced by several streams, and the extra copies that one domain per stream would store
+
+		//** Saves the dedup tables, the statistics and the fingerprint feed position are not part of a checkpoint
+		void Save_checkpoint(Checkpoint_Writer& writer);
+		void Load_checkpoint(Checkpoint_Reader& reader);
+
+		size_t Total_chunk_no;//total chunk(page), including unique and deduped chunks
+		size_t Dup_chunk_no;//discarded chunks
+		size_t Total_fp_no;//Total number of fingerprints in the feed (0 when read from a text file or when there is no feed)
+		size_t Total_page_write_no;//partial and full write, including GC write
+		size_t GC_page_write_no;
+		size_t GC_shared_page_write_no;//GC page moves of shared chunks, each of them also updates the SMT
+		FP_type cur_fp;//Fingerprint of the write that is being deduplicated
+		Fingerprint_Cache* FPcache;//NULL if the whole fingerprint table is kept in DRAM
+		size_t FP_bucket_reads;//Flash reads of fingerprint bucket pages (lookup misses and read-modify-write merges)
+		size_t FP_bucket_writes;//Flash writes of fingerprint bucket pages (write back of dirty evicted entries)
+		Fingerprint_Filter* Filter;//NULL if every lookup searches the fingerprint index
+		size_t FP_bucket_reads_filtered;//Fingerprint bucket reads skipped because the filter proved the fingerprint new
+		SMT_Cache* SMTcache;//NULL if the whole Secondary Mapping Table is kept in DRAM
+		Dedup_Sampler* Sampler;//NULL if every written page is fully fingerprinted
+		Dedup_Mode Mode;
+		size_t Background_read_no;//Flash reads of pending chunks that are fingerprinted during idle periods
+		size_t GC_piggyback_no;//Pending chunks fingerprinted while GC moved them, without an extra flash read
+		size_t Background_merge_no;//Pending chunks that turned out to be duplicates and were merged into an existing chunk
+		size_t Dropped_pending_no;//Pending chunks overwritten before they were fingerprinted
+		size_t Batch_no;//Dispatch lists with more than one fingerprinted write, whose lookups are prefetched together
+		size_t Batch_write_no;//Writes of those lists
+		size_t Batch_dup_no;//Writes whose fingerprint already appeared earlier in the same list
+		Chunk_Store* Chunks;//NULL if whole pages are deduplicated
+		size_t Chunk_page_program_no;//Flash pages programmed with packed unique chunks, GC moves excluded
+		size_t Partial_chunk_write_no;//Chunks that a write only partly overwrites, so their old content is merged in
+		size_t Chunk_merge_read_no;//Flash reads of old chunk content for those merges, at most one per write transaction
+		size_t Fragment_read_no;//Extra flash reads of a logical page whose chunks are spread over several flash pages
+		size_t Buffered_chunk_read_no;//Chunks that a read finds in a packing buffer instead of on flash
+		size_t Unique_chunk_sector_no;//Sectors of the unique chunks written by the host, before compression
+		size_t Compressed_chunk_sector_no;//Sectors of the same chunks once compressed, equal to the above without compression
+		size_t GC_compacted_page_no;//Partially valid packed pages whose live chunks GC repacked instead of copying the whole page
+		size_t GC_compacted_chunk_no;//Live chunks repacked that way
+		size_t Trim_page_no;//Mapped logical pages that TRIMs touched
+		size_t Trim_released_no;//References to stored pages (or chunks) that TRIMs dropped
+		size_t Trim_freed_no;//Pages (or chunks) freed by a TRIM, since it dropped their last reference
+		bool GC_dedup_enabled;//GC fingerprints the moved pages that were written under a placeholder and merges the duplicates among them
+		size_t GC_hash_no;//Pages fingerprinted by GC while it moved them
+		size_t GC_merge_no;//Those of them that were duplicates, merged into an existing chunk instead of being programmed again
+		bool Verify_enabled;//A duplicate write completes only once the page it matched has been read back and compared
+		size_t Verify_read_no;//Flash reads of matched pages issued to verify duplicate writes
+		sim_time_type Verify_time;//Total time that duplicate writes waited for those reads, i.e., the write latency added by verification
+		size_t Cross_stream_dup_no;//Duplicate writes that matched a chunk only other streams referenced, one domain per stream would have programmed them
+		Content_Generator* Content;//NULL unless the writes of a synthetic flow take their fingerprints from a content model
+
+	private:
+		Dedup_Tables* tables;
+		bool global;
+		stream_id_type stream_id;//Only meaningful in a global dedup domain
+		Fingerprint_Feed fp_feed;//Only used for writes that do not carry their own fingerprint
+		std::unordered_map<FP_type, FP_type, FP_Hasher> pending_chunks;//Placeholder -> real fingerprint of the page
+		std::deque<FP_type> pending_queue;//Placeholders in write order, entries that are no longer pending are skipped
+		std::unordered_map<FP_type, FP_type, FP_Hasher> skipped_chunks;//Placeholder of the sampler -> real fingerprint of the page, only kept with GC dedup
+		uint64_t placeholder_no;
+	};
+}
+
+#endif // !DEDUPLICATOR_H
@@ -18,7 +18,7 @@ namespace SSD_Components
 		unsigned int block_no_per_plane, unsigned int page_no_per_block, unsigned int page_size_in_sectors, 
 		sim_time_type avg_flash_read_latency, sim_time_type avg_flash_program_latency, 
 		double over_provisioning_ratio, unsigned int max_allowed_block_erase_count, int seed) :
-		NVM_Firmware(id, data_cache_manager), random_generator(seed),
+		NVM_Firmware(id, data_cache_manager), Fingerprint_engine(NULL), random_generator(seed),
 		channel_no(channel_no), chip_no_per_channel(chip_no_per_channel), die_no_per_chip(die_no_per_chip), plane_no_per_die(plane_no_per_die),
 		block_no_per_plane(block_no_per_plane), page_no_per_block(page_no_per_block), page_size_in_sectors(page_size_in_sectors), 
 		avg_flash_read_latency(avg_flash_read_latency), avg_flash_program_latency(avg_flash_program_latency),
@@ -751,7 +751,55 @@ namespace SSD_Components
 			}
 		}
 	}
-	
+
+	void FTL::Save_checkpoint(const std::string& path)
+	{
+		Checkpoint_Writer writer(path);
+		writer.Begin_section("FTL_");
+		writer.Write(channel_no);
+		writer.Write(chip_no_per_channel);
+		writer.Write(die_no_per_chip);
+		writer.Write(plane_no_per_die);
+		writer.Write(page_size_in_sectors);
+		BlockManager->Save_checkpoint(writer);
+		Address_Mapping_Unit->Save_checkpoint(writer);
+
+		//The flash chips only keep the LPA of each page, which GC reads to check page validity
+		writer.Begin_section("PAGE");
+		for (unsigned int channel_id = 0; channel_id < channel_no; channel_id++)
+			for (unsigned int chip_id = 0; chip_id < chip_no_per_channel; chip_id++)
+				for (unsigned int die_id = 0; die_id < die_no_per_chip; die_id++)
+					for (unsigned int plane_id = 0; plane_id < plane_no_per_die; plane_id++)
+						for (unsigned int block_id = 0; block_id < block_no_per_plane; block_id++)
+							for (unsigned int page_id = 0; page_id < page_no_per_block; page_id++)
+								writer.Write(PHY->Get_metadata(channel_id, chip_id, die_id, plane_id, block_id, page_id));
+		writer.Close();
+	}
+
+	void FTL::Load_checkpoint(const std::string& path)
+	{
+		Checkpoint_Reader reader(path);
+		reader.Begin_section("FTL_");
+		reader.Expect(channel_no, "Flash_Channel_Count");
+		reader.Expect(chip_no_per_channel, "Chip_No_Per_Channel");
+		reader.Expect(die_no_per_chip, "Die_No_Per_Chip");
+		reader.Expect(plane_no_per_die, "Plane_No_Per_Die");
+		reader.Expect(page_size_in_sectors, "Page_Capacity");
+		BlockManager->Load_checkpoint(reader);
+		Address_Mapping_Unit->Load_checkpoint(reader);
+
+		reader.Begin_section("PAGE");
+		NVM::FlashMemory::Physical_Page_Address address;
+		for (address.ChannelID = 0; address.ChannelID < channel_no; address.ChannelID++)
+			for (address.ChipID = 0; address.ChipID < chip_no_per_channel; address.ChipID++)
+				for (address.DieID = 0; address.DieID < die_no_per_chip; address.DieID++)
+					for (address.PlaneID = 0; address.PlaneID < plane_no_per_die; address.PlaneID++)
+						for (address.BlockID = 0; address.BlockID < block_no_per_plane; address.BlockID++)
+							for (address.PageID = 0; address.PageID < page_no_per_block; address.PageID++)
+								PHY->Change_flash_page_status_for_preconditioning(address, reader.Read<LPA_type>());
+		reader.Close();
+	}
+
 	void FTL::Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter)
 	{
 		std::string tmp = name_prefix + ".FTL";
@@ -833,6 +881,14 @@ namespace SSD_Components
 		val = std::to_string(Stats::Total_flash_writes_for_mapping);
 		xmlwriter.Write_attribute_string_inline(attr, val);
 
+		attr = "Issued_Flash_Read_CMD_For_SMT";
+		val = std::to_string(Stats::Total_flash_reads_for_SMT);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Issued_Flash_Program_CMD_For_SMT";
+		val = std::to_string(Stats::Total_flash_writes_for_SMT);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
 		attr = "CMT_Hits";
 		val = std::to_string(Stats::CMT_hits);
 		xmlwriter.Write_attribute_string_inline(attr, val);
@@ -886,6 +942,8 @@ namespace SSD_Components
 		xmlwriter.Write_attribute_string_inline(attr, val);
 
 		xmlwriter.Write_end_element_tag();
+
+		Address_Mapping_Unit->Report_results_in_XML(tmp, xmlwriter);//** Append for CAFTL
 	}
 
 	void FTL::Start_simulation()
@@ -19,6 +19,7 @@ namespace SSD_Components
 	class Address_Mapping_Unit_Base;
 	class GC_and_WL_Unit_Base;
 	class TSU_Base;
+	class Fingerprint_Engine;
 
 	class FTL : public NVM_Firmware
 	{
@@ -29,6 +30,8 @@ namespace SSD_Components
 			sim_time_type avg_flash_read_latency, sim_time_type avg_flash_program_latency, double over_provisioning_ratio, unsigned int max_allowed_block_erase_count, int seed);
 		~FTL();
 		void Perform_precondition(std::vector<Utils::Workload_Statistics*> workload_stats);
+		void Save_checkpoint(const std::string& path);//** Append for CAFTL, images the warm device state after preconditioning
+		void Load_checkpoint(const std::string& path);//** Append for CAFTL, replaces Perform_precondition
 		void Validate_simulation_config();
 		void Start_simulation();
 		void Execute_simulator_event(MQSimEngine::Sim_Event*);
@@ -39,6 +42,7 @@ namespace SSD_Components
 		GC_and_WL_Unit_Base* GC_and_WL_Unit;
 		TSU_Base * TSU;
 		NVM_PHY_ONFI* PHY;
+		Fingerprint_Engine* Fingerprint_engine;//** Append for CAFTL, fingerprints user writes before they reach the address mapping unit
 		void Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter);
 	private:
 		unsigned int channel_no, chip_no_per_channel, die_no_per_chip, plane_no_per_die;
@@ -0,0 +1,109 @@
+#include <stdexcept>
+#include "Fingerprint_Cache.h"
+
+namespace SSD_Components
+{
+	Fingerprint_Cache::Fingerprint_Cache(unsigned int capacity, FP_Cache_Replacement_Policy policy, unsigned int bucket_no) :
+		Hits(0), Misses(0), capacity(capacity), policy(policy), bucket_no(bucket_no)
+	{
+		if (this->bucket_no == 0)
+			this->bucket_no = 1;
+	}
+
+	bool Fingerprint_Cache::Exists(const FP_type& FP)
+	{
+		return addressMap.find(FP) != addressMap.end();
+	}
+
+	bool Fingerprint_Cache::Lookup(const FP_type& FP)
+	{
+		auto it = addressMap.find(FP);
+		if (it == addressMap.end()) {
+			Misses++;
+			return false;
+		}
+
+		Hits++;
+		if (policy == FP_Cache_Replacement_Policy::LRU)
+			replacementList.splice(replacementList.begin(), replacementList, it->second.listPtr);
+		return true;
+	}
+
+	bool Fingerprint_Cache::Check_free_slot_availability()
+	{
+		return addressMap.size() < capacity;
+	}
+
+	void Fingerprint_Cache::Insert(const FP_type& FP, bool dirty)
+	{
+		if (addressMap.find(FP) != addressMap.end()) {
+			throw std::logic_error("Duplicate fingerprint insertion into the fingerprint cache!");
+		}
+		if (addressMap.size() >= capacity) {
+			throw std::logic_error("Fingerprint cache overfull!");
+		}
+
+		replacementList.push_front(FP);
+		FPCacheSlotType slot = { dirty, replacementList.begin() };
+		addressMap[FP] = slot;
+	}
+
+	void Fingerprint_Cache::Make_dirty(const FP_type& FP)
+	{
+		auto it = addressMap.find(FP);
+		if (it == addressMap.end()) {
+			throw std::logic_error("The requested fingerprint is not cached!");
+		}
+
+		it->second.Dirty = true;
+		if (policy == FP_Cache_Replacement_Policy::LRU)
+			replacementList.splice(replacementList.begin(), replacementList, it->second.listPtr);
+	}
+
+	FP_type Fingerprint_Cache::Evict_one_slot(bool& dirty)
+	{
+		if (addressMap.size() == 0) {
+			throw std::logic_error("Evicting from an empty fingerprint cache!");
+		}
+
+		FP_type victim = replacementList.back();
+		auto it = addressMap.find(victim);
+		dirty = it->second.Dirty;
+		addressMap.erase(it);
+		replacementList.pop_back();
+
+		return victim;
+	}
+
+	unsigned int Fingerprint_Cache::Get_bucket(const FP_type& FP)
+	{
+		return (unsigned int)(FP_Hasher()(FP) % bucket_no);
+	}
+
+	float Fingerprint_Cache::Get_hit_rate()
+	{
+		if (Hits + Misses == 0)
+			return 0;
+		return float(Hits) / (Hits + Misses);
+	}
+
+	void Fingerprint_Cache::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Write(capacity);
+		writer.Write((uint64_t)replacementList.size());
+		for (auto it = replacementList.rbegin(); it != replacementList.rend(); it++) {//Back to front, so that reinsertion rebuilds the same order
+			writer.Write(*it);
+			writer.Write(addressMap[*it].Dirty);
+		}
+	}
+
+	void Fingerprint_Cache::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Expect(capacity, "FP_Cache_Capacity");
+		uint64_t entry_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < entry_no; i++) {
+			FP_type FP = reader.Read<FP_type>();
+			Insert(FP, reader.Read<bool>());
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef FINGERPRINT_CACHE_H
+#define FINGERPRINT_CACHE_H
+
+#include <unordered_map>
+#include <list>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Checkpoint.h"
+
+namespace SSD_Components
+{
+	enum class FP_Cache_Replacement_Policy { LRU, FIFO };
+
+	struct FP_Hasher//FNV-1a over the whole digest, short hex fingerprints are zero padded so the leading bytes alone are not enough
+	{
+		size_t operator()(const FP_type& FP) const
+		{
+			uint64_t hash = 14695981039346656037ULL;
+			for (unsigned int i = 0; i < FP_DIGEST_SIZE; i++)
+				hash = (hash ^ FP.Digest[i]) * 1099511628211ULL;
+			return (size_t)hash;
+		}
+	};
+
+	struct FPCacheSlotType
+	{
+		bool Dirty;
+		std::list<FP_type>::iterator listPtr;
+	};
+
+	/*
+	* Bounded fingerprint cache (Append for CAFTL). It plays the role of the CMT for the fingerprint store:
+	* the complete fingerprint table is persisted in flash as buckets of fingerprints (one flash page per
+	* bucket) and only Capacity entries are kept in controller DRAM. The cache only tracks residency and
+	* dirtiness; the entries themselves stay in the FP_Index of the Deduplicator, which stands for the
+	* union of the cache and the on-flash buckets.
+	*/
+	class Fingerprint_Cache
+	{
+	public:
+		Fingerprint_Cache(unsigned int capacity, FP_Cache_Replacement_Policy policy, unsigned int bucket_no);
+		bool Exists(const FP_type& FP);
+		bool Lookup(const FP_type& FP);//Same as Exists, but counts a hit or a miss and refreshes the entry under LRU
+		bool Check_free_slot_availability();
+		void Insert(const FP_type& FP, bool dirty);
+		void Make_dirty(const FP_type& FP);
+		FP_type Evict_one_slot(bool& dirty);
+		unsigned int Get_bucket(const FP_type& FP);
+		unsigned int Get_bucket_no() { return bucket_no; }
+		unsigned int Get_capacity() { return capacity; }
+		size_t Size() { return addressMap.size(); }
+		float Get_hit_rate();
+		void Save_checkpoint(Checkpoint_Writer& writer);//Resident fingerprints in replacement order, statistics are not saved
+		void Load_checkpoint(Checkpoint_Reader& reader);
+
+		size_t Hits;
+		size_t Misses;
+	private:
+		std::unordered_map<FP_type, FPCacheSlotType, FP_Hasher> addressMap;
+		std::list<FP_type> replacementList;//Front is the most recently inserted (FIFO) or used (LRU) entry
+		unsigned int capacity;
+		FP_Cache_Replacement_Policy policy;
+		unsigned int bucket_no;
+	};
+}
+
+#endif // !FINGERPRINT_CACHE_H
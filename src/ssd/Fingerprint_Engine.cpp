@@ -0,0 +1,285 @@
+#include <stdexcept>
+#include "../sim/Engine.h"
+#include "Fingerprint_Engine.h"
+#include "FTL.h"
+#include "Deduplicator.h"
+#include "NVM_Transaction_Flash_WR.h"
+
+namespace SSD_Components
+{
+	Fingerprint_Engine::Fingerprint_Engine(const sim_object_id_type& id, FTL* ftl, unsigned int unit_no, unsigned int unit_throughput_in_MBps,
+		unsigned int weak_hash_throughput_in_MBps, unsigned int page_size_in_byte, sim_time_type idle_threshold) :
+		MQSimEngine::Sim_Object(id), ftl(ftl), unit_no(unit_no), free_unit_no(unit_no), page_hash_time(0), page_weak_hash_time(0),
+		idle_threshold(idle_threshold), last_write_arrival_time(0), idle_check_scheduled(false), outstanding_background_job_no(0),
+		hashed_page_no(0), queued_page_no(0), background_hashed_page_no(0), max_queue_depth(0), total_queueing_delay(0), total_busy_time(0)
+	{
+		if (unit_no > 0) {
+			if (unit_throughput_in_MBps == 0 || weak_hash_throughput_in_MBps == 0)
+				PRINT_ERROR("The throughput of the fingerprint engine units should be greater than zero!")
+			page_hash_time = (sim_time_type)page_size_in_byte * 1000 / unit_throughput_in_MBps;//bytes / (MB/s) gives microseconds, times 1000 for nanoseconds
+			page_weak_hash_time = (sim_time_type)page_size_in_byte * 1000 / weak_hash_throughput_in_MBps;
+		}
+	}
+
+	Fingerprint_Engine::~Fingerprint_Engine()
+	{
+		if (unit_no > 0 && hashed_page_no + background_hashed_page_no > 0) {
+			PRINT_MESSAGE("\n* Fingerprint Engine:");
+			PRINT_MESSAGE("Hash units #: " << unit_no << ", page hash time (ns): " << page_hash_time << ", page weak hash time (ns): " << page_weak_hash_time);
+			PRINT_MESSAGE("Hashed pages #: " << hashed_page_no << ", hashed in the background #: " << background_hashed_page_no << ", max queue depth: " << max_queue_depth);
+			PRINT_MESSAGE("Hash unit utilization: " << Get_utilization() * 100.0 << "%");
+			PRINT_MESSAGE("Average queueing delay (ns): " << get_average_queueing_delay());
+		}
+	}
+
+	void Fingerprint_Engine::Start_simulation()
+	{
+	}
+
+	void Fingerprint_Engine::Validate_simulation_config()
+	{
+		if (ftl == NULL)
+			throw std::logic_error("The FTL is not set for the fingerprint engine!");
+	}
+
+	void Fingerprint_Engine::Submit_write_transactions(const std::list<NVM_Transaction*>& transaction_list)
+	{
+		std::list<NVM_Transaction*> bypass_list, unit;
+		unsigned int unit_size = 1;
+		bool out_of_line_write = false;
+		for (auto it = transaction_list.begin(); it != transaction_list.end(); it++) {
+			if ((*it)->Type != Transaction_Type::WRITE) {
+				bypass_list.push_back(*it);
+				continue;
+			}
+			last_write_arrival_time = Simulator->Time();
+			Deduplicator* write_deduplicator = ftl->Address_Mapping_Unit->Get_deduplicator((*it)->Stream_id);
+			if (write_deduplicator != NULL && write_deduplicator->Mode == Dedup_Mode::OUT_OF_LINE) {//Fingerprinted later, in the background
+				bypass_list.push_back(*it);
+				out_of_line_write = true;
+				continue;
+			}
+			//A sampling unit never spans two user requests
+			if (unit.size() > 0 && (unit.size() >= unit_size || unit.front()->Stream_id != (*it)->Stream_id
+				|| unit.front()->UserIORequest != (*it)->UserIORequest)) {
+				enqueue_job(unit);
+			}
+			if (unit.size() == 0) {
+				Deduplicator* deduplicator = ftl->Address_Mapping_Unit->Get_deduplicator((*it)->Stream_id);
+				unit_size = (deduplicator != NULL && deduplicator->Sampler != NULL) ? deduplicator->Sampler->Get_unit_size() : 1;
+			}
+			unit.push_back(*it);
+		}
+		if (unit.size() > 0)
+			enqueue_job(unit);
+
+		//Without hash units, the writes are fingerprinted in zero time and go to the mapping unit as one batch
+		if (unit_no == 0) {
+			while (submission_queue.size() > 0) {
+				bypass_list.splice(bypass_list.end(), submission_queue.front()->Transactions);
+				delete submission_queue.front();
+				submission_queue.pop();
+			}
+			queued_page_no = 0;
+		}
+		if (queued_page_no > max_queue_depth)
+			max_queue_depth = queued_page_no;
+
+		if (bypass_list.size() > 0)
+			ftl->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(bypass_list);
+		issue_jobs();
+		if (out_of_line_write)
+			schedule_idle_check();
+	}
+
+	void Fingerprint_Engine::Submit_background_job(const stream_id_type stream_id, const FP_type& placeholder)
+	{
+		Fingerprint_Job* job = new Fingerprint_Job;
+		job->Background = true;
+		job->Stream_id = stream_id;
+		job->Placeholder = placeholder;
+		job->Enqueue_time = Simulator->Time();
+		job->Hash_time = page_hash_time;
+
+		//Without hash units, the chunk is fingerprinted in zero time
+		if (unit_no == 0) {
+			finish_job(job);
+			return;
+		}
+		queued_page_no++;
+		submission_queue.push(job);
+		if (queued_page_no > max_queue_depth)
+			max_queue_depth = queued_page_no;
+		issue_jobs();
+	}
+
+	void Fingerprint_Engine::Notify_pending_chunk()
+	{
+		//Background jobs in flight pick the chunk up when they finish
+		if (outstanding_background_job_no == 0)
+			schedule_idle_check();
+	}
+
+	void Fingerprint_Engine::schedule_idle_check()
+	{
+		if (idle_check_scheduled)
+			return;
+		idle_check_scheduled = true;
+		//A write that waited behind a GC barrier gets its chunk after the idle period may have begun, the check is then due now
+		sim_time_type check_time = last_write_arrival_time + idle_threshold;
+		if (check_time < Simulator->Time())
+			check_time = Simulator->Time();
+		Simulator->Register_sim_event(check_time, this, NULL, (int)Fingerprint_Engine_Event_Type::IDLE_CHECK);
+	}
+
+	void Fingerprint_Engine::issue_background_jobs()
+	{
+		//Background dedup keeps every hash unit busy at most, the reads are pipelined with the hashing
+		unsigned int max_job_no = (unit_no == 0 ? 1 : unit_no);
+		if (outstanding_background_job_no < max_job_no) {
+			bool deferred;
+			outstanding_background_job_no += ftl->Address_Mapping_Unit->Issue_background_dedup_reads(max_job_no - outstanding_background_job_no, deferred);
+			//The chunks left on chips that run GC are retried after another idle threshold, no finished job would retry them
+			if (deferred && outstanding_background_job_no == 0 && !idle_check_scheduled) {
+				idle_check_scheduled = true;
+				Simulator->Register_sim_event(Simulator->Time() + idle_threshold, this, NULL, (int)Fingerprint_Engine_Event_Type::IDLE_CHECK);
+			}
+		}
+	}
+
+	void Fingerprint_Engine::enqueue_job(std::list<NVM_Transaction*>& unit)
+	{
+		Fingerprint_Job* job = new Fingerprint_Job;
+		job->Background = false;
+		job->Transactions.swap(unit);
+		job->Enqueue_time = Simulator->Time();
+
+		unsigned int full_hash_no = (unsigned int)job->Transactions.size(), weak_hash_no = 0;
+		Deduplicator* deduplicator = ftl->Address_Mapping_Unit->Get_deduplicator(job->Transactions.front()->Stream_id);
+		if (deduplicator != NULL && deduplicator->Sampler != NULL) {
+			//The fingerprints are bound to the writes here, since sampling has to see them before the mapping unit does
+			std::vector<FP_type*> unit_fps;
+			for (auto it = job->Transactions.begin(); it != job->Transactions.end(); it++) {
+				NVM_Transaction_Flash_WR* write = (NVM_Transaction_Flash_WR*)(*it);
+				if (!write->FP_available && deduplicator->Has_fingerprint_feed() && deduplicator->Next_fingerprint(write->FP))
+					write->FP_available = true;
+				if (write->FP_available)
+					unit_fps.push_back(&write->FP);
+			}
+			if (unit_fps.size() > 0) {
+				unsigned int sampled_full_hash_no = 0;
+				deduplicator->Sample_unit(unit_fps, sampled_full_hash_no, weak_hash_no);
+				full_hash_no = sampled_full_hash_no + (unsigned int)(job->Transactions.size() - unit_fps.size());
+			}
+		}
+		job->Hash_time = full_hash_no * page_hash_time + weak_hash_no * page_weak_hash_time;
+		if (deduplicator != NULL && deduplicator->Filter != NULL)//Each full fingerprint is then checked against the SRAM filter
+			job->Hash_time += full_hash_no * deduplicator->Filter->Get_lookup_time();
+
+		queued_page_no += job->Transactions.size();
+		submission_queue.push(job);
+	}
+
+	void Fingerprint_Engine::issue_jobs()
+	{
+		while (free_unit_no > 0 && submission_queue.size() > 0) {
+			Fingerprint_Job* job = submission_queue.front();
+			submission_queue.pop();
+			size_t page_no = job->Background ? 1 : job->Transactions.size();
+			queued_page_no -= page_no;
+			free_unit_no--;
+			total_queueing_delay += (Simulator->Time() - job->Enqueue_time) * page_no;
+			total_busy_time += job->Hash_time;
+			Simulator->Register_sim_event(Simulator->Time() + job->Hash_time, this, job, (int)Fingerprint_Engine_Event_Type::JOB_FINISHED);
+		}
+	}
+
+	void Fingerprint_Engine::Execute_simulator_event(MQSimEngine::Sim_Event* ev)
+	{
+		if ((Fingerprint_Engine_Event_Type)ev->Type == Fingerprint_Engine_Event_Type::IDLE_CHECK) {
+			idle_check_scheduled = false;
+			if (Simulator->Time() < last_write_arrival_time + idle_threshold)
+				schedule_idle_check();//A write arrived since the check was scheduled
+			else
+				issue_background_jobs();
+			return;
+		}
+
+		free_unit_no++;
+		//Start the next job before dispatching, so the hash units keep working while the writes wait in the TSU
+		issue_jobs();
+		finish_job((Fingerprint_Job*)ev->Parameters);
+	}
+
+	void Fingerprint_Engine::finish_job(Fingerprint_Job* job)
+	{
+		if (!job->Background) {
+			hashed_page_no += job->Transactions.size();
+			ftl->Address_Mapping_Unit->Translate_lpa_to_ppa_and_dispatch(job->Transactions);
+			delete job;
+			return;
+		}
+
+		background_hashed_page_no++;
+		outstanding_background_job_no--;
+		ftl->Address_Mapping_Unit->Merge_pending_chunk(job->Stream_id, job->Placeholder);
+		delete job;
+		//Background dedup goes on as long as the device stays idle, a new write postpones it to the next idle period
+		if (Simulator->Time() >= last_write_arrival_time + idle_threshold)
+			issue_background_jobs();
+		else
+			schedule_idle_check();
+	}
+
+	double Fingerprint_Engine::Get_utilization()
+	{
+		if (unit_no == 0 || Simulator->Time() == 0)
+			return 0;
+		//The hash time of a job is accounted when it is issued, so jobs in flight may push the ratio above 1 before they finish
+		double utilization = (double)total_busy_time / ((double)unit_no * Simulator->Time());
+		return utilization > 1 ? 1 : utilization;
+	}
+
+	double Fingerprint_Engine::get_average_queueing_delay()
+	{
+		if (hashed_page_no == 0)
+			return 0;
+		return (double)total_queueing_delay / hashed_page_no;
+	}
+
+	void Fingerprint_Engine::Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter)
+	{
+		std::string tmp = name_prefix + ".FingerprintEngine";
+		xmlwriter.Write_start_element_tag(tmp);
+
+		std::string attr = "Hash_Unit_No";
+		std::string val = std::to_string(unit_no);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Page_Hash_Time";
+		val = std::to_string(page_hash_time);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Hashed_Pages";
+		val = std::to_string(hashed_page_no);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Background_Hashed_Pages";
+		val = std::to_string(background_hashed_page_no);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Max_Queue_Depth";
+		val = std::to_string(max_queue_depth);
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Avg_Queueing_Delay";
+		val = std::to_string(get_average_queueing_delay());
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		attr = "Utilization";
+		val = std::to_string(Get_utilization());
+		xmlwriter.Write_attribute_string_inline(attr, val);
+
+		xmlwriter.Write_end_element_tag();
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef FINGERPRINT_ENGINE_H
+#define FINGERPRINT_ENGINE_H
+
+#include <list>
+#include <queue>
+#include "../sim/Sim_Defs.h"
+#include "../sim/Sim_Object.h"
+#include "../sim/Sim_Reporter.h"
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "NVM_Transaction.h"
+
+namespace SSD_Components
+{
+	class FTL;
+
+	enum class Fingerprint_Engine_Event_Type { JOB_FINISHED, IDLE_CHECK };
+
+	struct Fingerprint_Job
+	{
+		std::list<NVM_Transaction*> Transactions;//The writes of one sampling unit (a single write when sampling is off)
+		sim_time_type Hash_time;
+		sim_time_type Enqueue_time;
+		bool Background;//A pending chunk of out-of-line dedup that has been read back from flash, Transactions is empty
+		stream_id_type Stream_id;
+		FP_type Placeholder;
+	};
+
+	/*
+	* Hash engine of the CAFTL deduplicator (Append for CAFTL). Flash writes coming from the data cache manager
+	* are fingerprinted by one of Unit_no parallel hash units before they are released to the address mapping
+	* unit (and from there to the TSU). Hashing is pipelined with the DRAM transfer of the data cache manager:
+	* a write is submitted as soon as its data starts streaming into DRAM, and a write that finds every unit
+	* busy waits in a FIFO submission queue. With sampling or pre-hashing, a job is a sampling unit of a user
+	* request and its hash time follows the full and weak hashes that the Deduplicator asks for.
+	* Writes of out-of-line dedup domains bypass the hash units. Once no write has arrived for Idle_threshold,
+	* the engine asks the mapping unit to read pending chunks back from flash and hashes them in the background.
+	*/
+	class Fingerprint_Engine : public MQSimEngine::Sim_Object, public MQSimEngine::Sim_Reporter
+	{
+	public:
+		Fingerprint_Engine(const sim_object_id_type& id, FTL* ftl, unsigned int unit_no, unsigned int unit_throughput_in_MBps,
+			unsigned int weak_hash_throughput_in_MBps, unsigned int page_size_in_byte, sim_time_type idle_threshold);
+		~Fingerprint_Engine();
+		void Start_simulation();
+		void Validate_simulation_config();
+		void Execute_simulator_event(MQSimEngine::Sim_Event* ev);
+		void Report_results_in_XML(std::string name_prefix, Utils::XmlWriter& xmlwriter);
+		void Submit_write_transactions(const std::list<NVM_Transaction*>& transaction_list);//Non-write transactions of the list bypass the engine
+		void Submit_background_job(const stream_id_type stream_id, const FP_type& placeholder);//A pending chunk has been read back from flash
+		void Notify_pending_chunk();//A chunk became pending, maybe long after its write arrived, e.g., behind a GC barrier
+		double Get_utilization();//Fraction of the elapsed simulation time that the hash units were busy
+	private:
+		FTL* ftl;
+		unsigned int unit_no;
+		unsigned int free_unit_no;
+		sim_time_type page_hash_time;
+		sim_time_type page_weak_hash_time;
+		std::queue<Fingerprint_Job*> submission_queue;
+		void enqueue_job(std::list<NVM_Transaction*>& unit);
+		void issue_jobs();
+		void finish_job(Fingerprint_Job* job);
+
+		//Out-of-line dedup
+		sim_time_type idle_threshold;
+		sim_time_type last_write_arrival_time;
+		bool idle_check_scheduled;
+		unsigned int outstanding_background_job_no;//Background jobs that are being read from flash or hashed
+		void schedule_idle_check();
+		void issue_background_jobs();
+
+		size_t hashed_page_no;
+		size_t queued_page_no;
+		size_t background_hashed_page_no;
+		size_t max_queue_depth;
+		sim_time_type total_queueing_delay;
+		sim_time_type total_busy_time;
+		double get_average_queueing_delay();
+	};
+}
+
+#endif // !FINGERPRINT_ENGINE_H
@@ -0,0 +1,153 @@
+#include <cstring>
+#include "Fingerprint_Feed.h"
+#include "Fingerprint_Index.h"
+
+#define FP_FEED_MAGIC "MQFP"
+#define FP_FEED_VERSION 1
+#define FP_FEED_HEADER_SIZE 24
+#define FP_FEED_BUFFER_SIZE (4 * 1024 * 1024)
+
+namespace SSD_Components
+{
+	Fingerprint_Feed::Fingerprint_Feed() : file(NULL), binary(false), record_size(FP_DIGEST_SIZE),
+		total_fingerprints(0), consumed_fingerprints(0), buffer_pos(0), buffer_end(0)
+	{
+	}
+
+	Fingerprint_Feed::~Fingerprint_Feed()
+	{
+		Close();
+	}
+
+	bool Fingerprint_Feed::Open(const std::string& path)
+	{
+		Close();
+		file = std::fopen(path.c_str(), "rb");
+		if (file == NULL)
+			return false;
+		buffer.resize(FP_FEED_BUFFER_SIZE);
+		buffer_pos = buffer_end = 0;
+		consumed_fingerprints = 0;
+		total_fingerprints = 0;
+		refill();
+
+		binary = buffer_end >= FP_FEED_HEADER_SIZE && std::memcmp(&buffer[0], FP_FEED_MAGIC, 4) == 0;
+		if (binary) {
+			uint32_t version;
+			std::memcpy(&version, &buffer[4], sizeof(uint32_t));
+			std::memcpy(&record_size, &buffer[8], sizeof(uint32_t));
+			std::memcpy(&total_fingerprints, &buffer[16], sizeof(uint64_t));
+			if (version != FP_FEED_VERSION || record_size == 0)
+				PRINT_ERROR("Unsupported fingerprint file: " << path)
+			if (record_size != FP_DIGEST_SIZE)
+				PRINT_MESSAGE("Fingerprint file digest size (" << record_size << ") differs from FP_DIGEST_SIZE (" << FP_DIGEST_SIZE << "), digests are truncated/zero padded")
+			buffer_pos = FP_FEED_HEADER_SIZE;
+		}
+		return true;
+	}
+
+	void Fingerprint_Feed::Close()
+	{
+		if (file != NULL) {
+			std::fclose(file);
+			file = NULL;
+		}
+		std::vector<uint8_t>().swap(buffer);
+		buffer_pos = buffer_end = 0;
+	}
+
+	bool Fingerprint_Feed::refill()
+	{
+		size_t remaining = buffer_end - buffer_pos;
+		if (remaining > 0 && buffer_pos > 0)
+			std::memmove(&buffer[0], &buffer[buffer_pos], remaining);
+		buffer_pos = 0;
+		buffer_end = remaining;
+		size_t read_bytes = std::fread(&buffer[buffer_end], 1, buffer.size() - buffer_end, file);
+		buffer_end += read_bytes;
+		return read_bytes > 0;
+	}
+
+	bool Fingerprint_Feed::Next(FP_type& fp)
+	{
+		if (file == NULL)
+			return false;
+		if (!binary)
+			return next_text(fp);
+
+		if (consumed_fingerprints == total_fingerprints)
+			return false;
+		if (buffer_end - buffer_pos < record_size && (!refill() || buffer_end - buffer_pos < record_size))
+			return false;
+		if (record_size == FP_DIGEST_SIZE) {
+			std::memcpy(fp.Digest, &buffer[buffer_pos], FP_DIGEST_SIZE);
+		}
+		else {
+			std::memset(fp.Digest, 0, FP_DIGEST_SIZE);
+			std::memcpy(fp.Digest, &buffer[buffer_pos], record_size < FP_DIGEST_SIZE ? record_size : FP_DIGEST_SIZE);
+		}
+		buffer_pos += record_size;
+		consumed_fingerprints++;
+		return true;
+	}
+
+	bool Fingerprint_Feed::next_text(FP_type& fp)
+	{
+		while (true) {
+			uint8_t* begin = &buffer[0] + buffer_pos;
+			uint8_t* newline = (uint8_t*)std::memchr(begin, '\n', buffer_end - buffer_pos);
+			if (newline != NULL) {
+				Parse_fingerprint(std::string((const char*)begin, newline - begin), fp);
+				buffer_pos += (newline - begin) + 1;
+				consumed_fingerprints++;
+				return true;
+			}
+			if (!refill()) {
+				if (buffer_pos == buffer_end)
+					return false;
+				Parse_fingerprint(std::string((const char*)&buffer[buffer_pos], buffer_end - buffer_pos), fp);
+				buffer_pos = buffer_end;
+				consumed_fingerprints++;
+				return true;
+			}
+		}
+	}
+
+	bool Fingerprint_Feed::Convert_text_to_binary(const std::string& text_path, const std::string& binary_path)
+	{
+		Fingerprint_Feed text_feed;
+		if (!text_feed.Open(text_path) || text_feed.binary)
+			return false;
+		std::FILE* output = std::fopen(binary_path.c_str(), "wb");
+		if (output == NULL)
+			return false;
+
+		uint8_t header[FP_FEED_HEADER_SIZE] = { 0 };
+		uint32_t version = FP_FEED_VERSION, digest_size = FP_DIGEST_SIZE;
+		std::memcpy(header, FP_FEED_MAGIC, 4);
+		std::memcpy(header + 4, &version, sizeof(uint32_t));
+		std::memcpy(header + 8, &digest_size, sizeof(uint32_t));
+		std::fwrite(header, 1, FP_FEED_HEADER_SIZE, output);
+
+		std::vector<uint8_t> out_buffer;
+		out_buffer.reserve(FP_FEED_BUFFER_SIZE);
+		FP_type fp;
+		uint64_t count = 0;
+		while (text_feed.Next(fp)) {
+			out_buffer.insert(out_buffer.end(), fp.Digest, fp.Digest + FP_DIGEST_SIZE);
+			if (out_buffer.size() + FP_DIGEST_SIZE > FP_FEED_BUFFER_SIZE) {
+				std::fwrite(&out_buffer[0], 1, out_buffer.size(), output);
+				out_buffer.clear();
+			}
+			count++;
+		}
+		if (!out_buffer.empty())
+			std::fwrite(&out_buffer[0], 1, out_buffer.size(), output);
+
+		std::fseek(output, 16, SEEK_SET);
+		std::fwrite(&count, sizeof(uint64_t), 1, output);
+		bool success = std::ferror(output) == 0;
+		std::fclose(output);
+		return success;
+	}
+}
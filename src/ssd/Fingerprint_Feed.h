@@ -0,0 +1,42 @@
+#ifndef FINGERPRINT_FEED_H
+#define FINGERPRINT_FEED_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+
+namespace SSD_Components
+{
+	/*
+	* Sequential source of write fingerprints (Append for CAFTL).
+	* Binary layout: "MQFP", uint32 version, uint32 digest size, uint32 reserved, uint64 count, then
+	* count packed digests. The file is consumed through large buffered reads, so Next() is a bounds
+	* check and a memcpy. Plain text files (one hex digest per line) are still accepted, but they are
+	* parsed line by line; convert them once with Convert_text_to_binary (MQSim -convert_fp).
+	*/
+	class Fingerprint_Feed
+	{
+	public:
+		Fingerprint_Feed();
+		~Fingerprint_Feed();
+		bool Open(const std::string& path);
+		void Close();
+		bool Is_open() const { return file != NULL; }
+		bool Next(FP_type& fp);
+		uint64_t Total_fingerprints() const { return total_fingerprints; }//0 for text input, where the count is unknown
+		uint64_t Consumed_fingerprints() const { return consumed_fingerprints; }
+		static bool Convert_text_to_binary(const std::string& text_path, const std::string& binary_path);
+	private:
+		std::FILE* file;
+		bool binary;
+		uint32_t record_size;
+		uint64_t total_fingerprints, consumed_fingerprints;
+		std::vector<uint8_t> buffer;
+		size_t buffer_pos, buffer_end;
+		bool refill();
+		bool next_text(FP_type& fp);
+	};
+}
+
+#endif // !FINGERPRINT_FEED_H
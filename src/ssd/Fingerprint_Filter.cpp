@@ -0,0 +1,79 @@
+#include <cmath>
+#include "Fingerprint_Filter.h"
+
+namespace SSD_Components
+{
+	Fingerprint_Filter::Fingerprint_Filter(unsigned int size_in_byte, unsigned int hash_no, sim_time_type probe_time) :
+		Lookup_no(0), Negative_no(0), False_positive_no(0), Inserted_no(0), hash_no(hash_no), probe_time(probe_time)
+	{
+		bit_no = (uint64_t)size_in_byte * 8;
+		if (bit_no < 64)
+			bit_no = 64;
+		bits.assign((size_t)((bit_no + 63) / 64), 0);
+		if (this->hash_no == 0)
+			this->hash_no = 1;
+	}
+
+	bool Fingerprint_Filter::Contains(const FP_type& FP) const
+	{
+		uint64_t h1, h2;
+		get_hashes(FP, h1, h2);
+		for (unsigned int i = 0; i < hash_no; i++) {
+			uint64_t bit = (h1 + i * h2) % bit_no;
+			if ((bits[(size_t)(bit >> 6)] & (1ULL << (bit & 63))) == 0)
+				return false;
+		}
+		return true;
+	}
+
+	void Fingerprint_Filter::Insert(const FP_type& FP)
+	{
+		uint64_t h1, h2;
+		get_hashes(FP, h1, h2);
+		for (unsigned int i = 0; i < hash_no; i++) {
+			uint64_t bit = (h1 + i * h2) % bit_no;
+			bits[(size_t)(bit >> 6)] |= 1ULL << (bit & 63);
+		}
+		Inserted_no++;
+	}
+
+	double Fingerprint_Filter::Get_false_positive_rate()
+	{
+		if (Negative_no + False_positive_no == 0)
+			return 0;
+		return double(False_positive_no) / (Negative_no + False_positive_no);
+	}
+
+	double Fingerprint_Filter::Get_expected_false_positive_rate()
+	{
+		return std::pow(1.0 - std::exp(-double(hash_no) * Inserted_no / bit_no), hash_no);
+	}
+
+	void Fingerprint_Filter::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Write(bit_no);
+		writer.Write(hash_no);
+		writer.Write((uint64_t)Inserted_no);
+		writer.Write_vector(bits);
+	}
+
+	void Fingerprint_Filter::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Expect(bit_no, "FP_Filter_Size");
+		reader.Expect(hash_no, "FP_Filter_Hash_No");
+		Inserted_no = (size_t)reader.Read<uint64_t>();
+		reader.Read_vector(bits);
+	}
+
+	void Fingerprint_Filter::get_hashes(const FP_type& FP, uint64_t& h1, uint64_t& h2) const
+	{
+		//FNV-1a over the whole digest, then a SplitMix64 finalizer for the second hash; h2 is odd so the probes never collapse
+		h1 = 14695981039346656037ULL;
+		for (unsigned int i = 0; i < FP_DIGEST_SIZE; i++)
+			h1 = (h1 ^ FP.Digest[i]) * 1099511628211ULL;
+		h2 = h1 + 0x9e3779b97f4a7c15ULL;
+		h2 = (h2 ^ (h2 >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		h2 = (h2 ^ (h2 >> 27)) * 0x94d049bb133111ebULL;
+		h2 = (h2 ^ (h2 >> 31)) | 1;
+	}
+}
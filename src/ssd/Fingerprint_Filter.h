@@ -0,0 +1,44 @@
+#ifndef FINGERPRINT_FILTER_H
+#define FINGERPRINT_FILTER_H
+
+#include <vector>
+#include "../sim/Sim_Defs.h"
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Checkpoint.h"
+
+namespace SSD_Components
+{
+	/*
+	* SRAM Bloom filter in front of the fingerprint index (Append for CAFTL). Every fingerprint that enters the
+	* index is added to the filter, so a negative answer proves that a fingerprint is new: its lookup needs
+	* no fingerprint bucket read. The hash_no bit positions of a fingerprint come from two hashes of its digest
+	* (double hashing). Bits are never cleared, so the fingerprints of freed chunks turn into false positives.
+	*/
+	class Fingerprint_Filter
+	{
+	public:
+		Fingerprint_Filter(unsigned int size_in_byte, unsigned int hash_no, sim_time_type probe_time);
+		bool Contains(const FP_type& FP) const;
+		void Insert(const FP_type& FP);
+		unsigned int Get_size_in_byte() { return (unsigned int)(bit_no / 8); }
+		unsigned int Get_hash_no() { return hash_no; }
+		sim_time_type Get_lookup_time() { return probe_time * hash_no; }//One SRAM probe per hash function
+		double Get_false_positive_rate();//Measured over the lookups of new fingerprints
+		double Get_expected_false_positive_rate();//(1 - e^(-kn/m))^k for the n fingerprints inserted so far
+		void Save_checkpoint(Checkpoint_Writer& writer);//The bit array, statistics are not saved
+		void Load_checkpoint(Checkpoint_Reader& reader);
+
+		size_t Lookup_no;
+		size_t Negative_no;//Lookups answered without touching the index
+		size_t False_positive_no;//New fingerprints that the filter let through
+		size_t Inserted_no;
+	private:
+		std::vector<uint64_t> bits;
+		uint64_t bit_no;
+		unsigned int hash_no;
+		sim_time_type probe_time;
+		void get_hashes(const FP_type& FP, uint64_t& h1, uint64_t& h2) const;
+	};
+}
+
+#endif // !FINGERPRINT_FILTER_H
@@ -0,0 +1,171 @@
+#include <cctype>
+#include <iomanip>
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+#include "Fingerprint_Index.h"
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+void Parse_fingerprint(const std::string& text, FP_type& fp)
+{
+	std::memset(fp.Digest, 0, FP_DIGEST_SIZE);
+	size_t begin = 0, end = text.size();
+	while (begin < end && isspace((unsigned char)text[begin])) begin++;
+	while (end > begin && isspace((unsigned char)text[end - 1])) end--;
+
+	bool is_hex = begin < end;
+	for (size_t i = begin; i < end && is_hex; i++)
+		if (hex_value(text[i]) < 0)
+			is_hex = false;
+
+	if (is_hex) {
+		for (size_t i = begin, nibble = 0; i < end && nibble < 2 * FP_DIGEST_SIZE; i++, nibble++)
+			fp.Digest[nibble / 2] |= (uint8_t)(hex_value(text[i]) << ((nibble % 2) ? 0 : 4));
+		return;
+	}
+
+	//FNV-1a over the raw text, one lane per 8 digest bytes
+	for (size_t lane = 0; lane * 8 < FP_DIGEST_SIZE; lane++) {
+		uint64_t h = 14695981039346656037ULL ^ (lane * 0x9E3779B97F4A7C15ULL);
+		for (size_t i = begin; i < end; i++) {
+			h ^= (uint8_t)text[i];
+			h *= 1099511628211ULL;
+		}
+		for (size_t b = 0; b < 8 && lane * 8 + b < FP_DIGEST_SIZE; b++)
+			fp.Digest[lane * 8 + b] = (uint8_t)(h >> (8 * b));
+	}
+}
+
+std::ostream& operator<<(std::ostream& out, const FP_type& fp)
+{
+	std::ios::fmtflags flags = out.flags();
+	char fill = out.fill('0');
+	for (size_t i = 0; i < FP_DIGEST_SIZE; i++)
+		out << std::hex << std::setw(2) << (unsigned int)fp.Digest[i];
+	out.fill(fill);
+	out.flags(flags);
+	return out;
+}
+
+namespace SSD_Components
+{
+	FP_Index::FP_Index(size_t initial_capacity) : size(0)
+	{
+		size_t capacity = 16;
+		while (capacity < initial_capacity)
+			capacity <<= 1;
+		tags.assign(capacity, 0);
+		slots.resize(capacity);
+		mask = capacity - 1;
+	}
+
+	uint32_t FP_Index::make_tag(const FP_type& FP)
+	{
+		//Digests are already uniformly distributed, a 64-bit mix of the leading bytes is enough
+		uint64_t h = 0;
+		std::memcpy(&h, FP.Digest, FP_DIGEST_SIZE < 8 ? FP_DIGEST_SIZE : 8);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		uint32_t tag = (uint32_t)h;
+		return tag == 0 ? 1 : tag;
+	}
+
+	bool FP_Index::probe(const FP_type& FP, uint32_t tag, size_t& pos) const
+	{
+		pos = tag & mask;
+		while (tags[pos] != 0) {
+			if (tags[pos] == tag && slots[pos].FP == FP)
+				return true;
+			pos = (pos + 1) & mask;
+		}
+		return false;
+	}
+
+	ChunkInfo* FP_Index::Find(const FP_type& FP)
+	{
+		size_t pos;
+		if (probe(FP, make_tag(FP), pos))
+			return &slots[pos].Info;
+		return NULL;
+	}
+
+	ChunkInfo* FP_Index::Find_or_insert(const FP_type& FP, bool& inserted)
+	{
+		uint32_t tag = make_tag(FP);
+		size_t pos;
+		inserted = false;
+		if (probe(FP, tag, pos))
+			return &slots[pos].Info;
+
+		if ((size + 1) * 4 > tags.size() * 3) {//keep the load factor below 0.75
+			grow();
+			probe(FP, tag, pos);
+		}
+		tags[pos] = tag;
+		slots[pos].FP = FP;
+		slots[pos].Info.PPA = NO_PPA;
+		slots[pos].Info.ref = 0;
+		size++;
+		inserted = true;
+		return &slots[pos].Info;
+	}
+
+	bool FP_Index::Erase(const FP_type& FP)
+	{
+		size_t hole;
+		if (!probe(FP, make_tag(FP), hole))
+			return false;
+
+		size_t pos = (hole + 1) & mask;
+		while (tags[pos] != 0) {
+			size_t home = tags[pos] & mask;
+			if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+				tags[hole] = tags[pos];
+				slots[hole] = slots[pos];
+				hole = pos;
+			}
+			pos = (pos + 1) & mask;
+		}
+		tags[hole] = 0;
+		size--;
+		return true;
+	}
+
+	void FP_Index::Prefetch(const FP_type& FP) const
+	{
+		size_t pos = make_tag(FP) & mask;
+#if defined(__GNUC__)
+		__builtin_prefetch(&tags[pos]);
+		__builtin_prefetch(&slots[pos]);
+#elif defined(_MSC_VER)
+		_mm_prefetch((const char*)&tags[pos], _MM_HINT_T0);
+		_mm_prefetch((const char*)&slots[pos], _MM_HINT_T0);
+#endif
+	}
+
+	void FP_Index::grow()
+	{
+		std::vector<uint32_t> old_tags(tags.size() * 2, 0);
+		std::vector<Slot> old_slots(slots.size() * 2);
+		old_tags.swap(tags);
+		old_slots.swap(slots);
+		mask = tags.size() - 1;
+		for (size_t i = 0; i < old_tags.size(); i++) {
+			if (old_tags[i] == 0)
+				continue;
+			size_t pos = old_tags[i] & mask;
+			while (tags[pos] != 0)
+				pos = (pos + 1) & mask;
+			tags[pos] = old_tags[i];
+			slots[pos] = old_slots[i];
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef FINGERPRINT_INDEX_H
+#define FINGERPRINT_INDEX_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+
+//** Append for CAFTL
+//Hex digests are packed into the fixed-width FP_type (zero padded or truncated to FP_DIGEST_SIZE).
+//Lines that are not plain hex are folded into a digest so that arbitrary tokens still compare correctly.
+void Parse_fingerprint(const std::string& text, FP_type& fp);
+std::ostream& operator<<(std::ostream& out, const FP_type& fp);
+
+namespace SSD_Components
+{
+	struct ChunkInfo//** Append for CAFTL
+	{
+		PPA_type PPA;
+		size_t ref;//number of this chunk appear
+	};
+
+	/*
+	* Open-addressing (linear probing) fingerprint index. A compact array of 32-bit hash tags is
+	* scanned first and full digests are only compared on a tag match, so a lookup usually touches
+	* one or two cache lines. Deletion uses backward shifting, hence there are no tombstones.
+	* ChunkInfo pointers returned by Find/Find_or_insert stay valid until the next insertion or erase.
+	*/
+	class FP_Index
+	{
+	public:
+		FP_Index(size_t initial_capacity = 1024);
+		ChunkInfo* Find(const FP_type& FP);
+		ChunkInfo* Find_or_insert(const FP_type& FP, bool& inserted);
+		bool Erase(const FP_type& FP);
+		void Prefetch(const FP_type& FP) const;//Hints the cache lines of the home slot of FP, so that a later probe does not stall on them
+		size_t Size() const { return size; }
+		size_t Capacity() const { return tags.size(); }
+		template<typename Visitor>
+		void For_each(Visitor visit) const
+		{
+			for (size_t i = 0; i < tags.size(); i++)
+				if (tags[i] != 0)
+					visit(slots[i].FP, slots[i].Info);
+		}
+	private:
+		struct Slot
+		{
+			FP_type FP;
+			ChunkInfo Info;
+		};
+		std::vector<uint32_t> tags;//0 marks an empty slot; the low bits of a tag are the home slot of its entry
+		std::vector<Slot> slots;
+		size_t mask;
+		size_t size;
+		static uint32_t make_tag(const FP_type& FP);
+		bool probe(const FP_type& FP, uint32_t tag, size_t& pos) const;
+		void grow();
+	};
+}
+
+#endif // !FINGERPRINT_INDEX_H
@@ -7,11 +7,12 @@ namespace SSD_Components
 {
 	Flash_Block_Manager::Flash_Block_Manager(GC_and_WL_Unit_Base* gc_and_wl_unit, unsigned int max_allowed_block_erase_count, unsigned int total_concurrent_streams_no,
 		unsigned int channel_count, unsigned int chip_no_per_channel, unsigned int die_no_per_chip, unsigned int plane_no_per_die,
-		unsigned int block_no_per_plane, unsigned int page_no_per_block)
+		unsigned int block_no_per_plane, unsigned int page_no_per_block, bool shared_data_wf_enabled)
 		: Flash_Block_Manager_Base(gc_and_wl_unit, max_allowed_block_erase_count, total_concurrent_streams_no, channel_count, chip_no_per_channel, die_no_per_chip,
-			plane_no_per_die, block_no_per_plane, page_no_per_block)
+			plane_no_per_die, block_no_per_plane, page_no_per_block, shared_data_wf_enabled)
 	{
 		total_gc_page_write_no = 0;
+		total_shared_gc_page_write_no = 0;
 		total_erase_count = 0;
 	}
 
@@ -21,6 +22,8 @@ namespace SSD_Components
 		std::cout << "Total blocks: " << channel_count * chip_no_per_channel * die_no_per_chip * plane_no_per_die * block_no_per_plane << std::endl;
 		std::cout << "Total erase count: " << total_erase_count << std::endl;
 		std::cout << "Total gc page write: " << total_gc_page_write_no << std::endl;
+		if (shared_data_wf_enabled)
+			std::cout << " - into the shared data write frontier: " << total_shared_gc_page_write_no << std::endl;
 	}
 
 	void Flash_Block_Manager::Allocate_block_and_page_in_plane_for_user_write(const stream_id_type stream_id, NVM::FlashMemory::Physical_Page_Address& page_address)
@@ -43,19 +46,24 @@ namespace SSD_Components
 		plane_record->Check_bookkeeping_correctness(page_address);
 	}
 
-	void Flash_Block_Manager::Allocate_block_and_page_in_plane_for_gc_write(const stream_id_type stream_id, NVM::FlashMemory::Physical_Page_Address& page_address)
+	void Flash_Block_Manager::Allocate_block_and_page_in_plane_for_gc_write(const stream_id_type stream_id, NVM::FlashMemory::Physical_Page_Address& page_address, bool shared_data)
 	{
 		PlaneBookKeepingType *plane_record = &plane_manager[page_address.ChannelID][page_address.ChipID][page_address.DieID][page_address.PlaneID];
+		//** Append for CAFTL: shared chunks are rarely invalidated, so they are kept apart from the hot unique data
+		Block_Pool_Slot_Type** write_frontier = (shared_data && shared_data_wf_enabled) ? plane_record->Shared_wf : plane_record->GC_wf;
 		plane_record->Valid_pages_count++;
 		plane_record->Free_pages_count--;		
-		page_address.BlockID = plane_record->GC_wf[stream_id]->BlockID;
-		page_address.PageID = plane_record->GC_wf[stream_id]->Current_page_write_index++;
+		page_address.BlockID = write_frontier[stream_id]->BlockID;
+		page_address.PageID = write_frontier[stream_id]->Current_page_write_index++;
 		total_gc_page_write_no++;
+		if (write_frontier == plane_record->Shared_wf)
+			total_shared_gc_page_write_no++;
+		program_transaction_issued(page_address);//** Append for CAFTL, a GC destination block is not a safe victim before its moved pages are programmed and their metadata is written
 		
 		//The current write frontier block is written to the end
-		if (plane_record->GC_wf[stream_id]->Current_page_write_index == pages_no_per_block) {
+		if (write_frontier[stream_id]->Current_page_write_index == pages_no_per_block) {
 			//Assign a new write frontier block
-			plane_record->GC_wf[stream_id] = plane_record->Get_a_free_block(stream_id, false);
+			write_frontier[stream_id] = plane_record->Get_a_free_block(stream_id, false);
 			gc_and_wl_unit->Check_gc_required(plane_record->Get_free_block_pool_size(), page_address);
 		}
 		plane_record->Check_bookkeeping_correctness(page_address);
@@ -148,6 +156,7 @@ namespace SSD_Components
 		plane_record->Invalid_pages_count -= block->Invalid_page_count;
 
 		Stats::Block_erase_histogram[block_address.ChannelID][block_address.ChipID][block_address.DieID][block_address.PlaneID][block->Erase_count]--;
+		release_page_metadata(block);//** Append for CAFTL, the OOB area is wiped together with the page data
 		block->Erase();
 		total_erase_count++;
 		Stats::Block_erase_histogram[block_address.ChannelID][block_address.ChipID][block_address.DieID][block_address.PlaneID][block->Erase_count]++;
@@ -6,11 +6,13 @@ namespace SSD_Components
 	unsigned int Block_Pool_Slot_Type::Page_vector_size = 0;
 	Flash_Block_Manager_Base::Flash_Block_Manager_Base(GC_and_WL_Unit_Base* gc_and_wl_unit, unsigned int max_allowed_block_erase_count, unsigned int total_concurrent_streams_no,
 		unsigned int channel_count, unsigned int chip_no_per_channel, unsigned int die_no_per_chip, unsigned int plane_no_per_die,
-		unsigned int block_no_per_plane, unsigned int page_no_per_block)
+		unsigned int block_no_per_plane, unsigned int page_no_per_block, bool shared_data_wf_enabled)
 		: gc_and_wl_unit(gc_and_wl_unit), max_allowed_block_erase_count(max_allowed_block_erase_count), total_concurrent_streams_no(total_concurrent_streams_no),
 		channel_count(channel_count), chip_no_per_channel(chip_no_per_channel), die_no_per_chip(die_no_per_chip), plane_no_per_die(plane_no_per_die),
-		block_no_per_plane(block_no_per_plane), pages_no_per_block(page_no_per_block)
+		block_no_per_plane(block_no_per_plane), pages_no_per_block(page_no_per_block), shared_data_wf_enabled(shared_data_wf_enabled)
 	{
+		page_metadata_no.assign(total_concurrent_streams_no, 0);//** Append for CAFTL
+		invalid_page_metadata_no.assign(total_concurrent_streams_no, 0);
 		plane_manager = new PlaneBookKeepingType***[channel_count];
 		for (unsigned int channelID = 0; channelID < channel_count; channelID++) {
 			plane_manager[channelID] = new PlaneBookKeepingType**[chip_no_per_channel];
@@ -41,20 +43,30 @@ namespace SSD_Components
 							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Erase_transaction = NULL;
 							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Ongoing_user_program_count = 0;
 							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Ongoing_user_read_count = 0;
+							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Reference_count = 0;//** Append for CAFTL
+							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Shared_page_count = 0;
 							Block_Pool_Slot_Type::Page_vector_size = pages_no_per_block / (sizeof(uint64_t) * 8) + (pages_no_per_block % (sizeof(uint64_t) * 8) == 0 ? 0 : 1);
 							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Invalid_page_bitmap = new uint64_t[Block_Pool_Slot_Type::Page_vector_size];
 							for (unsigned int i = 0; i < Block_Pool_Slot_Type::Page_vector_size; i++) {
 								plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].Invalid_page_bitmap[i] = All_VALID_PAGE;
 							}
+							plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].OOB = new OOBEntryType[pages_no_per_block];//** Append for CAFTL
+							for (unsigned int i = 0; i < pages_no_per_block; i++) {
+								plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID].OOB[i].Reset();
+							}
 							plane_manager[channelID][chipID][dieID][planeID].Add_to_free_block_pool(&plane_manager[channelID][chipID][dieID][planeID].Blocks[blockID], false);
 						}
 						plane_manager[channelID][chipID][dieID][planeID].Data_wf = new Block_Pool_Slot_Type*[total_concurrent_streams_no];
 						plane_manager[channelID][chipID][dieID][planeID].Translation_wf = new Block_Pool_Slot_Type*[total_concurrent_streams_no];
 						plane_manager[channelID][chipID][dieID][planeID].GC_wf = new Block_Pool_Slot_Type*[total_concurrent_streams_no];
+						plane_manager[channelID][chipID][dieID][planeID].Shared_wf = (shared_data_wf_enabled ? new Block_Pool_Slot_Type*[total_concurrent_streams_no] : NULL);
 						for (unsigned int stream_cntr = 0; stream_cntr < total_concurrent_streams_no; stream_cntr++) {
 							plane_manager[channelID][chipID][dieID][planeID].Data_wf[stream_cntr] = plane_manager[channelID][chipID][dieID][planeID].Get_a_free_block(stream_cntr, false);
 							plane_manager[channelID][chipID][dieID][planeID].Translation_wf[stream_cntr] = plane_manager[channelID][chipID][dieID][planeID].Get_a_free_block(stream_cntr, true);
 							plane_manager[channelID][chipID][dieID][planeID].GC_wf[stream_cntr] = plane_manager[channelID][chipID][dieID][planeID].Get_a_free_block(stream_cntr, false);
+							if (shared_data_wf_enabled) {
+								plane_manager[channelID][chipID][dieID][planeID].Shared_wf[stream_cntr] = plane_manager[channelID][chipID][dieID][planeID].Get_a_free_block(stream_cntr, false);
+							}
 						}
 					}
 				}
@@ -70,9 +82,11 @@ namespace SSD_Components
 					for (unsigned int plane_id = 0; plane_id < plane_no_per_die; plane_id++) {
 						for (unsigned int blockID = 0; blockID < block_no_per_plane; blockID++) {
 							delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Blocks[blockID].Invalid_page_bitmap;
+							delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Blocks[blockID].OOB;
 						}
 						delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Blocks;
 						delete[] plane_manager[channel_id][chip_id][die_id][plane_id].GC_wf;
+						delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Shared_wf;
 						delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Data_wf;
 						delete[] plane_manager[channel_id][chip_id][die_id][plane_id].Translation_wf;
 					}
@@ -90,6 +104,67 @@ namespace SSD_Components
 		this->gc_and_wl_unit = gcwl;
 	}
 
+	void Flash_Block_Manager_Base::release_page_metadata(Block_Pool_Slot_Type* block)
+	{
+		for (flash_page_ID_type i = 0; i < block->Current_page_write_index; i++) {
+			uncount_page_metadata(block, block->OOB[i]);
+			oob_fingerprints.Release(block->OOB[i].FP_slot);
+			block->OOB[i].Reset();
+		}
+	}
+
+	void Flash_Block_Manager_Base::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Begin_section("BLKM");
+		writer.Write(block_no_per_plane);
+		writer.Write(pages_no_per_block);
+		writer.Write(total_concurrent_streams_no);
+		writer.Write(shared_data_wf_enabled);
+		for (unsigned int channel_id = 0; channel_id < channel_count; channel_id++)
+			for (unsigned int chip_id = 0; chip_id < chip_no_per_channel; chip_id++)
+				for (unsigned int die_id = 0; die_id < die_no_per_chip; die_id++)
+					for (unsigned int plane_id = 0; plane_id < plane_no_per_die; plane_id++)
+						plane_manager[channel_id][chip_id][die_id][plane_id].Save_checkpoint(writer, block_no_per_plane, total_concurrent_streams_no);
+		writer.Write_vector(page_metadata_no);
+		writer.Write_vector(invalid_page_metadata_no);
+		oob_fingerprints.Save_checkpoint(writer);
+	}
+
+	void Flash_Block_Manager_Base::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Begin_section("BLKM");
+		reader.Expect(block_no_per_plane, "Block_No_Per_Plane");
+		reader.Expect(pages_no_per_block, "Page_No_Per_Block");
+		reader.Expect(total_concurrent_streams_no, "the number of I/O flows");
+		reader.Expect(shared_data_wf_enabled, "Shared_Data_Write_Frontier");
+		for (unsigned int channel_id = 0; channel_id < channel_count; channel_id++)
+			for (unsigned int chip_id = 0; chip_id < chip_no_per_channel; chip_id++)
+				for (unsigned int die_id = 0; die_id < die_no_per_chip; die_id++)
+					for (unsigned int plane_id = 0; plane_id < plane_no_per_die; plane_id++)
+						plane_manager[channel_id][chip_id][die_id][plane_id].Load_checkpoint(reader, block_no_per_plane, total_concurrent_streams_no);
+		reader.Read_vector(page_metadata_no);
+		reader.Read_vector(invalid_page_metadata_no);
+		oob_fingerprints.Load_checkpoint(reader);
+	}
+
+	void Flash_Block_Manager_Base::count_page_metadata(const Block_Pool_Slot_Type* block, const OOBEntryType& entry)
+	{
+		if (!entry.Has_metadata() || block->Stream_id >= total_concurrent_streams_no)
+			return;
+		page_metadata_no[block->Stream_id]++;
+		if (entry.status)
+			invalid_page_metadata_no[block->Stream_id]++;
+	}
+
+	void Flash_Block_Manager_Base::uncount_page_metadata(const Block_Pool_Slot_Type* block, const OOBEntryType& entry)
+	{
+		if (!entry.Has_metadata() || block->Stream_id >= total_concurrent_streams_no)
+			return;
+		page_metadata_no[block->Stream_id]--;
+		if (entry.status)
+			invalid_page_metadata_no[block->Stream_id]--;
+	}
+
 	void Block_Pool_Slot_Type::Erase()
 	{
 		Current_page_write_index = 0;
@@ -101,6 +176,8 @@ namespace SSD_Components
 		Stream_id = NO_STREAM;
 		Holds_mapping_data = false;
 		Erase_transaction = NULL;
+		Reference_count = 0;//** Append for CAFTL
+		Shared_page_count = 0;
 	}
 
 	Block_Pool_Slot_Type* PlaneBookKeepingType::Get_a_free_block(stream_id_type stream_id, bool for_mapping_data)
@@ -118,6 +195,104 @@ namespace SSD_Components
 		return new_block;
 	}
 	
+	/*
+	* Blocks are saved by value and the pools that point to them by block ID. Transactions cannot be
+	* saved, so a plane with an erase in flight or with pages under GC cannot be checkpointed. The user
+	* access counters are kept as they are: the translation pages written by Store_mapping_table_on_flash_at_start
+	* are never serviced, so their blocks keep a nonzero program count after preconditioning.
+	*/
+	void PlaneBookKeepingType::Save_checkpoint(Checkpoint_Writer& writer, unsigned int block_no, unsigned int stream_no)
+	{
+		if (Ongoing_erase_operations.size() > 0)
+			PRINT_ERROR("A checkpoint cannot be taken while a block erase is in flight!")
+		writer.Write(Total_pages_count);
+		writer.Write(Free_pages_count);
+		writer.Write(Valid_pages_count);
+		writer.Write(Invalid_pages_count);
+		for (unsigned int block_id = 0; block_id < block_no; block_id++) {
+			Block_Pool_Slot_Type& block = Blocks[block_id];
+			if (block.Erase_transaction != NULL || block.Has_ongoing_gc_wl)
+				PRINT_ERROR("A checkpoint cannot be taken while a flash block is under GC/WL!")
+			writer.Write(block.Current_page_write_index);
+			writer.Write(block.block_full);
+			writer.Write(block.Current_status);
+			writer.Write(block.Invalid_page_count);
+			writer.Write(block.Erase_count);
+			writer.Write_array(block.Invalid_page_bitmap, Block_Pool_Slot_Type::Page_vector_size);
+			writer.Write(block.Stream_id);
+			writer.Write(block.Holds_mapping_data);
+			writer.Write(block.Hot_block);
+			writer.Write(block.Reference_count);
+			writer.Write(block.Shared_page_count);
+			writer.Write(block.Ongoing_user_read_count);
+			writer.Write(block.Ongoing_user_program_count);
+			writer.Write_array(block.OOB, block.Current_page_write_index);//Pages above the write index are erased and hold no metadata
+		}
+
+		writer.Write((uint64_t)Free_block_pool.size());
+		for (auto& entry : Free_block_pool) {//Blocks with the same key are saved in pool order
+			writer.Write(entry.first);
+			writer.Write(entry.second->BlockID);
+		}
+		for (unsigned int stream_id = 0; stream_id < stream_no; stream_id++) {
+			writer.Write(Data_wf[stream_id]->BlockID);
+			writer.Write(GC_wf[stream_id]->BlockID);
+			writer.Write(Translation_wf[stream_id]->BlockID);
+			if (Shared_wf != NULL)
+				writer.Write(Shared_wf[stream_id]->BlockID);
+		}
+		std::queue<flash_block_ID_type> history(Block_usage_history);
+		writer.Write((uint64_t)history.size());
+		while (history.size() > 0) {
+			writer.Write(history.front());
+			history.pop();
+		}
+	}
+
+	void PlaneBookKeepingType::Load_checkpoint(Checkpoint_Reader& reader, unsigned int block_no, unsigned int stream_no)
+	{
+		Total_pages_count = reader.Read<unsigned int>();
+		Free_pages_count = reader.Read<unsigned int>();
+		Valid_pages_count = reader.Read<unsigned int>();
+		Invalid_pages_count = reader.Read<unsigned int>();
+		for (unsigned int block_id = 0; block_id < block_no; block_id++) {
+			Block_Pool_Slot_Type& block = Blocks[block_id];
+			block.Current_page_write_index = reader.Read<flash_page_ID_type>();
+			block.block_full = reader.Read<bool>();
+			block.Current_status = reader.Read<Block_Service_Status>();
+			block.Invalid_page_count = reader.Read<unsigned int>();
+			block.Erase_count = reader.Read<unsigned int>();
+			reader.Read_array(block.Invalid_page_bitmap, Block_Pool_Slot_Type::Page_vector_size);
+			block.Stream_id = reader.Read<stream_id_type>();
+			block.Holds_mapping_data = reader.Read<bool>();
+			block.Hot_block = reader.Read<bool>();
+			block.Reference_count = reader.Read<unsigned int>();
+			block.Shared_page_count = reader.Read<unsigned int>();
+			block.Ongoing_user_read_count = reader.Read<int>();
+			block.Ongoing_user_program_count = reader.Read<int>();
+			reader.Read_array(block.OOB, block.Current_page_write_index);
+		}
+
+		Free_block_pool.clear();
+		uint64_t free_block_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < free_block_no; i++) {
+			unsigned int key = reader.Read<unsigned int>();
+			flash_block_ID_type block_id = reader.Read<flash_block_ID_type>();
+			Free_block_pool.insert(std::pair<unsigned int, Block_Pool_Slot_Type*>(key, &Blocks[block_id]));
+		}
+		for (unsigned int stream_id = 0; stream_id < stream_no; stream_id++) {
+			Data_wf[stream_id] = &Blocks[reader.Read<flash_block_ID_type>()];
+			GC_wf[stream_id] = &Blocks[reader.Read<flash_block_ID_type>()];
+			Translation_wf[stream_id] = &Blocks[reader.Read<flash_block_ID_type>()];
+			if (Shared_wf != NULL)
+				Shared_wf[stream_id] = &Blocks[reader.Read<flash_block_ID_type>()];
+		}
+		std::queue<flash_block_ID_type>().swap(Block_usage_history);
+		uint64_t history_size = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < history_size; i++)
+			Block_usage_history.push(reader.Read<flash_block_ID_type>());
+	}
+
 	void PlaneBookKeepingType::Check_bookkeeping_correctness(const NVM::FlashMemory::Physical_Page_Address& plane_address)
 	{
 		if (Total_pages_count != Free_pages_count + Valid_pages_count + Invalid_pages_count) {
@@ -222,6 +397,13 @@ namespace SSD_Components
 		PlaneBookKeepingType *plane_record = &plane_manager[page_address.ChannelID][page_address.ChipID][page_address.DieID][page_address.PlaneID];
 		plane_record->Blocks[page_address.BlockID].Ongoing_user_program_count--;
 		//std::cout << "After serviced: Ongoing_user_program_count = " << plane_record->Blocks[page_address.BlockID].Ongoing_user_program_count << std::endl;
+		//** Append for CAFTL: a full block only becomes a safe GC victim once its last program is finished. GC is otherwise only
+		//reconsidered when a block is allocated or erased, so with no erase left in the plane, writes waiting for free pages
+		//would wait forever.
+		if (plane_record->Blocks[page_address.BlockID].Ongoing_user_program_count == 0
+			&& plane_record->Blocks[page_address.BlockID].Current_page_write_index == pages_no_per_block) {
+			gc_and_wl_unit->Check_gc_required(plane_record->Get_free_block_pool_size(), page_address);
+		}
 	}
 
 	void Flash_Block_Manager_Base::Read_transaction_serviced(const NVM::FlashMemory::Physical_Page_Address& page_address)
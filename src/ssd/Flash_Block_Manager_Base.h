@@ -5,9 +5,11 @@
 #include <cstdint>
 #include <queue>
 #include <set>
+#include <vector>
 #include "../nvm_chip/flash_memory/FlashTypes.h"
 #include "../nvm_chip/flash_memory/Physical_Page_Address.h"
 #include "GC_and_WL_Unit_Base.h"
+#include "OOB_Metadata.h"
 #include "../nvm_chip/flash_memory/FlashTypes.h"
 
 namespace SSD_Components
@@ -44,6 +46,9 @@ namespace SSD_Components
 		bool Hot_block = false;//Used for hot/cold separation mentioned in the "On the necessity of hot and cold data identification to reduce the write amplification in flash-based SSDs", Perf. Eval., 2014.
 		int Ongoing_user_read_count;
 		int Ongoing_user_program_count;
+		OOBEntryType* OOB;//** Append for CAFTL, out-of-band metadata of each page, reclaimed on erase
+		unsigned int Reference_count;//** Append for CAFTL, sum of the reference counts of the chunks stored in the valid pages of the block
+		unsigned int Shared_page_count;//** Append for CAFTL, valid pages of the block that are reached through the SMT
 		void Erase();
 	};
 
@@ -58,9 +63,12 @@ namespace SSD_Components
 		std::multimap<unsigned int, Block_Pool_Slot_Type*> Free_block_pool;
 		Block_Pool_Slot_Type** Data_wf, ** GC_wf; //The write frontier blocks for data and GC pages. MQSim adopts Double Write Frontier approach for user and GC writes which is shown very advantages in: B. Van Houdt, "On the necessity of hot and cold data identification to reduce the write amplification in flash - based SSDs", Perf. Eval., 2014
 		Block_Pool_Slot_Type** Translation_wf; //The write frontier blocks for translation GC pages
+		Block_Pool_Slot_Type** Shared_wf; //** Append for CAFTL: the write frontier blocks for GC moves of shared chunks, NULL if shared chunks go to GC_wf
 		std::queue<flash_block_ID_type> Block_usage_history;//A fifo queue that keeps track of flash blocks based on their usage history
 		std::set<flash_block_ID_type> Ongoing_erase_operations;
 		Block_Pool_Slot_Type* Get_a_free_block(stream_id_type stream_id, bool for_mapping_data);
+		void Save_checkpoint(Checkpoint_Writer& writer, unsigned int block_no, unsigned int stream_no);//** Append for CAFTL
+		void Load_checkpoint(Checkpoint_Reader& reader, unsigned int block_no, unsigned int stream_no);
 		unsigned int Get_free_block_pool_size();
 		void Check_bookkeeping_correctness(const NVM::FlashMemory::Physical_Page_Address& plane_address);
 		void Add_to_free_block_pool(Block_Pool_Slot_Type* block, bool consider_dynamic_wl);
@@ -74,10 +82,10 @@ namespace SSD_Components
 	public:
 		Flash_Block_Manager_Base(GC_and_WL_Unit_Base* gc_and_wl_unit, unsigned int max_allowed_block_erase_count, unsigned int total_concurrent_streams_no,
 			unsigned int channel_count, unsigned int chip_no_per_channel, unsigned int die_no_per_chip, unsigned int plane_no_per_die,
-			unsigned int block_no_per_plane, unsigned int page_no_per_block);
+			unsigned int block_no_per_plane, unsigned int page_no_per_block, bool shared_data_wf_enabled);
 		virtual ~Flash_Block_Manager_Base();
 		virtual void Allocate_block_and_page_in_plane_for_user_write(const stream_id_type streamID, NVM::FlashMemory::Physical_Page_Address& address) = 0;
-		virtual void Allocate_block_and_page_in_plane_for_gc_write(const stream_id_type streamID, NVM::FlashMemory::Physical_Page_Address& address) = 0;
+		virtual void Allocate_block_and_page_in_plane_for_gc_write(const stream_id_type streamID, NVM::FlashMemory::Physical_Page_Address& address, bool shared_data) = 0;//shared_data: the page holds a shared chunk (** Append for CAFTL)
 		virtual void Allocate_block_and_page_in_plane_for_translation_write(const stream_id_type streamID, NVM::FlashMemory::Physical_Page_Address& address, bool is_for_gc) = 0;
 		virtual void Allocate_Pages_in_block_and_invalidate_remaining_for_preconditioning(const stream_id_type stream_id, const NVM::FlashMemory::Physical_Page_Address& plane_address, std::vector<NVM::FlashMemory::Physical_Page_Address>& page_addresses) = 0;
 		virtual void Invalidate_page_in_block(const stream_id_type streamID, const NVM::FlashMemory::Physical_Page_Address& address) = 0;
@@ -97,6 +105,8 @@ namespace SSD_Components
 		void Program_transaction_serviced(const NVM::FlashMemory::Physical_Page_Address& page_address);//Updates the block bookkeeping record
 		bool Is_having_ongoing_program(const NVM::FlashMemory::Physical_Page_Address& block_address);//Cheks if block has any ongoing program request
 		bool Is_page_valid(Block_Pool_Slot_Type* block, flash_page_ID_type page_id);//Make the page invalid in the block bookkeeping record
+		void Save_checkpoint(Checkpoint_Writer& writer);//** Append for CAFTL, only valid while no flash operation is in flight
+		void Load_checkpoint(Checkpoint_Reader& reader);
 	protected:
 		PlaneBookKeepingType ****plane_manager;//Keeps track of plane block usage information
 		GC_and_WL_Unit_Base *gc_and_wl_unit;
@@ -108,11 +118,19 @@ namespace SSD_Components
 		unsigned int plane_no_per_die;
 		unsigned int block_no_per_plane;
 		unsigned int pages_no_per_block;
+		bool shared_data_wf_enabled;//** Append for CAFTL
 		void program_transaction_issued(const NVM::FlashMemory::Physical_Page_Address& page_address);//Updates the block bookkeeping record
 
 		//** Append for CAFTL
 		size_t total_gc_page_write_no;
+		size_t total_shared_gc_page_write_no;//GC page writes that went to the shared data write frontier
 		size_t total_erase_count;
+		Fingerprint_Arena oob_fingerprints;//Fingerprints referenced by the OOB entries of all blocks of this device
+		void release_page_metadata(Block_Pool_Slot_Type* block);//Wipes the OOB area of a block that is being erased
+		std::vector<size_t> page_metadata_no;//Per stream, OOB entries that hold CAFTL metadata
+		std::vector<size_t> invalid_page_metadata_no;//Per stream, OOB entries that the dedup layer marked invalid
+		void count_page_metadata(const Block_Pool_Slot_Type* block, const OOBEntryType& entry);//Adds an OOB entry of the block to the per-stream counters
+		void uncount_page_metadata(const Block_Pool_Slot_Type* block, const OOBEntryType& entry);//Takes an OOB entry of the block out of the per-stream counters
 	};
 }
 
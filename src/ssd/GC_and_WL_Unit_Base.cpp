@@ -44,6 +44,9 @@ namespace SSD_Components
 
 	void GC_and_WL_Unit_Base::handle_transaction_serviced_signal_from_PHY(NVM_Transaction_Flash* transaction)
 	{
+		if (transaction->Type == Transaction_Type::WRITE && ((NVM_Transaction_Flash_WR*)transaction)->dedup_wr) {
+			return;//** Append for CAFTL, a duplicate write never reached a flash plane
+		}
 		PlaneBookKeepingType* pbke = &(_my_instance->block_manager->plane_manager[transaction->Address.ChannelID][transaction->Address.ChipID][transaction->Address.DieID][transaction->Address.PlaneID]);
 
 		switch (transaction->Source) {
@@ -65,7 +68,8 @@ namespace SSD_Components
 					default:
 						PRINT_ERROR("Unexpected situation in the GC_and_WL_Unit_Base function!")
 				}
-				if (_my_instance->block_manager->Block_has_ongoing_gc_wl(transaction->Address)) {
+				//** Append for CAFTL: a shared or chunk page is read through LPAs that GC does not lock, so such a read may end after the postponed GC has been executed
+				if (_my_instance->block_manager->Block_has_ongoing_gc_wl(transaction->Address) && pbke->Blocks[transaction->Address.BlockID].Erase_transaction == NULL) {
 					if (_my_instance->block_manager->Can_execute_gc_wl(transaction->Address)) {
 						PRINT_MESSAGE("Can_execute_gc_wl");
 						NVM::FlashMemory::Physical_Page_Address gc_wl_candidate_address(transaction->Address);
@@ -149,19 +153,49 @@ namespace SSD_Components
 						((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
 						//PRINT_MESSAGE("GC read: " << transaction->LPA << " " << transaction->PPA);
 						_my_instance->address_mapping_unit->Allocate_new_page_for_gc(((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite, pbke->Blocks[transaction->Address.BlockID].Holds_mapping_data);
-						_my_instance->tsu->Submit_transaction(((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite);
+						if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->dedup_wr) {
+							//** Append for CAFTL: GC dedup found the page to be a duplicate and merged it, there is nothing to program
+							NVM_Transaction_Flash_WR* gc_write = ((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite;
+							_my_instance->address_mapping_unit->Remove_barrier_for_accessing_lpa(transaction->Stream_id, transaction->LPA);
+							pbke->Blocks[transaction->Address.BlockID].Erase_transaction->Page_movement_activities.remove(gc_write);
+							delete gc_write;
+						} else {
+							_my_instance->tsu->Submit_transaction(((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite);
+						}
 						_my_instance->tsu->Schedule();
 						//PRINT_MESSAGE(transaction->LPA << " " << ppa << " " << transaction->PPA);
+					} else if (_my_instance->block_manager->Is_page_valid(&pbke->Blocks[transaction->Address.BlockID], transaction->Address.PageID)) {
+						//** Append for CAFTL: the LPA in the OOB area of a shared page may have been remapped, while the other LPAs of the chunk still reach the page through the SMT
+						_my_instance->tsu->Prepare_for_transaction_submit();
+						((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->write_sectors_bitmap = FULL_PROGRAMMED_PAGE;
+						((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->LPA = transaction->LPA;
+						((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->RelatedRead = NULL;
+						_my_instance->address_mapping_unit->Allocate_new_page_for_gc(((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite, false);
+						if (((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite->dedup_wr) {
+							//** Append for CAFTL: the live compressed chunks of the page were repacked into a packing buffer, there is nothing to program
+							NVM_Transaction_Flash_WR* gc_write = ((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite;
+							_my_instance->address_mapping_unit->Remove_barrier_for_accessing_lpa(transaction->Stream_id, transaction->LPA);
+							pbke->Blocks[transaction->Address.BlockID].Erase_transaction->Page_movement_activities.remove(gc_write);
+							delete gc_write;
+						} else {
+							_my_instance->tsu->Submit_transaction(((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite);
+						}
+						_my_instance->tsu->Schedule();
 					} else {
-						//PRINT_MESSAGE(transaction->LPA << " " << ppa << " " << transaction->PPA);
-						//PRINT_MESSAGE("GC read: " << transaction->LPA << " " << transaction->PPA);
-						//PRINT_ERROR("Inconsistency found when moving a page for GC/WL!")
+						//** Append for CAFTL: the page became invalid after GC started (the last reference to its chunk was dropped), so it is not moved
+						NVM_Transaction_Flash_WR* gc_write = ((NVM_Transaction_Flash_RD*)transaction)->RelatedWrite;
+						_my_instance->address_mapping_unit->Remove_barrier_for_accessing_lpa(transaction->Stream_id, transaction->LPA);
+						pbke->Blocks[transaction->Address.BlockID].Erase_transaction->Page_movement_activities.remove(gc_write);
+						delete gc_write;
+						_my_instance->tsu->Prepare_for_transaction_submit();
+						_my_instance->tsu->Schedule();
 					}
 				}
 				break;
 			}
 			case Transaction_Type::WRITE:
 				//PRINT_MESSAGE("GC write");
+				_my_instance->block_manager->Program_transaction_serviced(transaction->Address);
 				if (pbke->Blocks[((NVM_Transaction_Flash_WR*)transaction)->RelatedErase->Address.BlockID].Holds_mapping_data) {
 					_my_instance->address_mapping_unit->Remove_barrier_for_accessing_mvpn(transaction->Stream_id, (MVPN_type)transaction->LPA);
 					DEBUG(Simulator->Time() << ": MVPN=" << (MVPN_type)transaction->LPA << " unlocked!!");
@@ -248,7 +282,8 @@ namespace SSD_Components
 		for (unsigned int stream_id = 0; stream_id < address_mapping_unit->Get_no_of_input_streams(); stream_id++) {
 			if ((&plane_record->Blocks[gc_wl_candidate_block_id]) == plane_record->Data_wf[stream_id]
 				|| (&plane_record->Blocks[gc_wl_candidate_block_id]) == plane_record->Translation_wf[stream_id]
-				|| (&plane_record->Blocks[gc_wl_candidate_block_id]) == plane_record->GC_wf[stream_id]) {
+				|| (&plane_record->Blocks[gc_wl_candidate_block_id]) == plane_record->GC_wf[stream_id]
+				|| (plane_record->Shared_wf != NULL && (&plane_record->Blocks[gc_wl_candidate_block_id]) == plane_record->Shared_wf[stream_id])) {
 				return false;
 			}
 		}
@@ -40,6 +40,21 @@ namespace SSD_Components
 		return false;
 	}
 
+	/*Cost-benefit of a victim: the reclaimed pages against the programs of its valid pages plus one SMT update for each
+	* valid shared page. Shared chunks are rarely invalidated again, so moving them is pure overhead. On a tie, the block
+	* with fewer references is taken, since its pages are more likely to be invalidated before the next GC.*/
+	bool GC_and_WL_Unit_Page_Level::is_better_dedup_victim(const Block_Pool_Slot_Type* block, const Block_Pool_Slot_Type* candidate)
+	{
+		uint64_t block_cost = 1 + (pages_no_per_block - block->Invalid_page_count) + block->Shared_page_count;
+		uint64_t candidate_cost = 1 + (pages_no_per_block - candidate->Invalid_page_count) + candidate->Shared_page_count;
+		uint64_t block_score = (uint64_t)block->Invalid_page_count * candidate_cost;
+		uint64_t candidate_score = (uint64_t)candidate->Invalid_page_count * block_cost;
+		if (block_score != candidate_score) {
+			return block_score > candidate_score;
+		}
+		return block->Reference_count < candidate->Reference_count;
+	}
+
 	void GC_and_WL_Unit_Page_Level::Check_gc_required(const unsigned int free_block_pool_size, const NVM::FlashMemory::Physical_Page_Address& plane_address)
 	{
 		if (free_block_pool_size < block_pool_gc_threshold) {
@@ -49,21 +64,32 @@ namespace SSD_Components
 			if (pbke->Ongoing_erase_operations.size() >= max_ongoing_gc_reqs_per_plane) {
 				return;
 			}
+			//** Append for CAFTL: the valid pages of each ongoing victim, and of this one, fill at most one free block per GC write
+			//frontier of their stream, and one more block is kept for a write frontier that is switched meanwhile. Otherwise, victims
+			//with only a few invalid pages, e.g., while the blocks with more are still being programmed, drain the free block pool.
+			unsigned int gc_frontier_no = (pbke->Shared_wf != NULL ? 2 : 1);
+			if (free_block_pool_size < (pbke->Ongoing_erase_operations.size() + 1) * gc_frontier_no + 1) {
+				return;
+			}
 
 			switch (block_selection_policy) {
 				case SSD_Components::GC_Block_Selection_Policy_Type::GREEDY://Find the set of blocks with maximum number of invalid pages and no free pages
 				{
-					gc_candidate_block_id = 0;
-					if (pbke->Ongoing_erase_operations.find(0) != pbke->Ongoing_erase_operations.end()) {
-						gc_candidate_block_id++;
-					}
-					for (flash_block_ID_type block_id = 1; block_id < block_no_per_plane; block_id++) {
-						if (pbke->Blocks[block_id].Invalid_page_count > pbke->Blocks[gc_candidate_block_id].Invalid_page_count
-							&& pbke->Blocks[block_id].Current_page_write_index == pages_no_per_block
-							&& is_safe_gc_wl_candidate(pbke, block_id)) {
+					bool found = false;//** Modified for CAFTL, the initial candidate must be a full, safe block that is not being erased
+					for (flash_block_ID_type block_id = 0; block_id < block_no_per_plane; block_id++) {
+						if (pbke->Blocks[block_id].Current_page_write_index < pages_no_per_block
+							|| pbke->Ongoing_erase_operations.find(block_id) != pbke->Ongoing_erase_operations.end()
+							|| !is_safe_gc_wl_candidate(pbke, block_id)) {
+							continue;
+						}
+						if (!found || pbke->Blocks[block_id].Invalid_page_count > pbke->Blocks[gc_candidate_block_id].Invalid_page_count) {
 							gc_candidate_block_id = block_id;
+							found = true;
 						}
 					}
+					if (!found) {
+						return;
+					}
 					break;
 				}
 				case SSD_Components::GC_Block_Selection_Policy_Type::RGA:
@@ -126,6 +152,25 @@ namespace SSD_Components
 					gc_candidate_block_id = pbke->Block_usage_history.front();
 					pbke->Block_usage_history.pop();
 					break;
+				case SSD_Components::GC_Block_Selection_Policy_Type::DEDUP_AWARE://** Append for CAFTL
+				{
+					bool found = false;
+					for (flash_block_ID_type block_id = 0; block_id < block_no_per_plane; block_id++) {
+						if (pbke->Blocks[block_id].Current_page_write_index < pages_no_per_block || pbke->Blocks[block_id].Invalid_page_count == 0
+							|| pbke->Ongoing_erase_operations.find(block_id) != pbke->Ongoing_erase_operations.end()
+							|| !is_safe_gc_wl_candidate(pbke, block_id)) {
+							continue;
+						}
+						if (!found || is_better_dedup_victim(&pbke->Blocks[block_id], &pbke->Blocks[gc_candidate_block_id])) {
+							gc_candidate_block_id = block_id;
+							found = true;
+						}
+					}
+					if (!found) {
+						return;
+					}
+					break;
+				}
 				default:
 					break;
 			}
@@ -28,6 +28,7 @@ namespace SSD_Components
 		void Check_gc_required(const unsigned int free_block_pool_size, const NVM::FlashMemory::Physical_Page_Address& plane_address);
 	private:
 		NVM_PHY_ONFI * flash_controller;
+		bool is_better_dedup_victim(const Block_Pool_Slot_Type* block, const Block_Pool_Slot_Type* candidate);//** Append for CAFTL
 	};
 }
 #endif // !GC_AND_WL_UNIT_PAGE_LEVEL_H
@@ -1,5 +1,6 @@
 #include "Host_Interface_Base.h"
 #include "Data_Cache_Manager_Base.h"
+#include "NVM_Transaction_Flash_WR.h"//** Append for CAFTL
 
 namespace SSD_Components
 {
@@ -31,9 +32,9 @@ namespace SSD_Components
 	Host_Interface_Base* Host_Interface_Base::_my_instance = NULL;
 
 	Host_Interface_Base::Host_Interface_Base(const sim_object_id_type& id, HostInterface_Types type, LHA_type max_logical_sector_address, unsigned int sectors_per_page, 
-		Data_Cache_Manager_Base* cache)
+		unsigned int sectors_per_chunk, Data_Cache_Manager_Base* cache)
 		: MQSimEngine::Sim_Object(id), type(type), max_logical_sector_address(max_logical_sector_address), 
-		sectors_per_page(sectors_per_page), cache(cache)
+		sectors_per_page(sectors_per_page), sectors_per_chunk(sectors_per_chunk), cache(cache)
 	{
 		_my_instance = this;
 	}
@@ -107,6 +108,8 @@ namespace SSD_Components
 				this->input_streams[transaction->Stream_id]->STAT_sum_of_read_transactions_waiting_time += (Simulator->Time() - transaction->Issue_time) - transaction->STAT_execution_time - transaction->STAT_transfer_time;
 				break;
 			case Transaction_Type::WRITE:
+				if (((NVM_Transaction_Flash_WR*)transaction)->Trim)//** Append for CAFTL: TRIMs are not counted as write transactions
+					break;
 				this->input_streams[transaction->Stream_id]->STAT_sum_of_write_transactions_execution_time += transaction->STAT_execution_time;
 				this->input_streams[transaction->Stream_id]->STAT_sum_of_write_transactions_transfer_time += transaction->STAT_transfer_time;
 				this->input_streams[transaction->Stream_id]->STAT_sum_of_write_transactions_waiting_time += (Simulator->Time() - transaction->Issue_time) - transaction->STAT_execution_time - transaction->STAT_transfer_time;
@@ -116,6 +119,35 @@ namespace SSD_Components
 		}
 	}
 
+	void Input_Stream_Manager_Base::bind_fingerprints(User_Request* user_request, NVM_Transaction_Flash_WR* transaction, page_status_type access_status_bitmap, size_t& fp_index)
+	{
+		unsigned int sectors_per_chunk = host_interface->sectors_per_chunk;
+		if (sectors_per_chunk >= host_interface->sectors_per_page) {//One fingerprint per page
+			if (user_request->Fingerprints.size() > fp_index) {
+				transaction->FP = user_request->Fingerprints[fp_index];
+				transaction->FP_available = true;
+				transaction->Compressed_sizes.push_back(user_request->Compressed_sizes.size() > fp_index ? user_request->Compressed_sizes[fp_index] : 0);
+			}
+			fp_index++;
+			return;
+		}
+
+		//One fingerprint per chunk touched by the transaction, in address order
+		page_status_type chunk_mask = (((page_status_type)1) << sectors_per_chunk) - 1;
+		unsigned int chunk_no = 0;
+		for (unsigned int chunk = 0; chunk < host_interface->sectors_per_page / sectors_per_chunk; chunk++) {
+			if (((access_status_bitmap >> (chunk * sectors_per_chunk)) & chunk_mask) == 0)
+				continue;
+			chunk_no++;
+			if (user_request->Fingerprints.size() > fp_index) {
+				transaction->Chunk_FPs.push_back(user_request->Fingerprints[fp_index]);
+				transaction->Compressed_sizes.push_back(user_request->Compressed_sizes.size() > fp_index ? user_request->Compressed_sizes[fp_index] : 0);
+			}
+			fp_index++;
+		}
+		transaction->FP_available = (transaction->Chunk_FPs.size() == chunk_no);
+	}
+
 	uint32_t Input_Stream_Manager_Base::Get_average_read_transaction_turnaround_time(stream_id_type stream_id)//in microseconds
 	{
 		if (input_streams[stream_id]->STAT_number_of_read_transactions == 0) {
@@ -28,6 +28,7 @@ namespace SSD_Components
 
 	class Data_Cache_Manager_Base;
 	class Host_Interface_Base;
+	class NVM_Transaction_Flash_WR;
 
 	class Input_Stream_Base
 	{
@@ -65,6 +66,7 @@ namespace SSD_Components
 	protected:
 		Host_Interface_Base* host_interface;
 		virtual void segment_user_request(User_Request* user_request) = 0;
+		void bind_fingerprints(User_Request* user_request, NVM_Transaction_Flash_WR* transaction, page_status_type access_status_bitmap, size_t& fp_index);//** Append for CAFTL
 		std::vector<Input_Stream_Base*> input_streams;
 	};
 
@@ -99,7 +101,7 @@ namespace SSD_Components
 		friend class Request_Fetch_Unit_SATA;
 	public:
 		Host_Interface_Base(const sim_object_id_type& id, HostInterface_Types type, LHA_type max_logical_sector_address, 
-			unsigned int sectors_per_page, Data_Cache_Manager_Base* cache);
+			unsigned int sectors_per_page, unsigned int sectors_per_chunk, Data_Cache_Manager_Base* cache);
 		virtual ~Host_Interface_Base();
 		void Setup_triggers();
 		void Validate_simulation_config();
@@ -131,6 +133,7 @@ namespace SSD_Components
 		HostInterface_Types type;
 		LHA_type max_logical_sector_address;
 		unsigned int sectors_per_page;
+		unsigned int sectors_per_chunk;//** Append for CAFTL: dedup chunk size, equal to sectors_per_page unless chunks are smaller than a page
 		static Host_Interface_Base* _my_instance;
 		Input_Stream_Manager_Base* input_stream_manager;
 		Request_Fetch_Unit_Base* request_fetch_unit;
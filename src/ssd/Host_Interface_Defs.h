@@ -10,9 +10,11 @@ enum class HostInterface_Types { SATA, NVME };
 #define NVME_FLUSH_OPCODE 0x0000
 #define NVME_WRITE_OPCODE 0x0001
 #define NVME_READ_OPCODE 0x0002
+#define NVME_DATASET_MANAGEMENT_OPCODE 0x0009//** Append for CAFTL: deallocate (TRIM), with one LBA range in the command dwords
 
 #define SATA_WRITE_OPCODE 0x0001
 #define SATA_READ_OPCODE 0x0002
+#define SATA_DATA_SET_MANAGEMENT_OPCODE 0x0009//** Append for CAFTL: TRIM, the same value as for NVMe since the HBA sends NVMe opcodes
 
 const uint64_t NCQ_SUBMISSION_REGISTER = 0x1000;
 const uint64_t NCQ_COMPLETION_REGISTER = 0x1003;
@@ -53,7 +55,7 @@ struct Submission_Queue_Entry
 	uint8_t PRP_FUSE;
 	uint16_t Command_Identifier;//The id of the command in the I/O submission queue
 	uint64_t Namespace_identifier;
-	uint64_t Reserved;
+	uint64_t Metadata_pointer_2;//** Append for CAFTL: compressed sizes of the contents behind the fingerprints of Metadata_pointer_1, in place of the reserved field so the entry keeps its size
 	uint64_t Metadata_pointer_1;
 	uint64_t PRP_entry_1;
 	uint64_t PRP_entry_2;
@@ -83,6 +83,13 @@ inline void Input_Stream_Manager_NVMe::Handle_new_arrived_request(User_Request *
 
 		((Host_Interface_NVMe *)host_interface)->broadcast_user_request_arrival_signal(request);
 	}
+	else if (request->Type == UserRequestType::TRIM)
+	{ //** Append for CAFTL: a TRIM carries no data, so it is segmented right away
+		((Input_Stream_NVMe *)input_streams[request->Stream_id])->Waiting_user_requests.push_back(request);
+		segment_user_request(request);
+
+		((Host_Interface_NVMe *)host_interface)->broadcast_user_request_arrival_signal(request);
+	}
 	else
 	{ //This is a write request
 		for (int i = 0; i < request->SizeInSectors; i++)
@@ -180,6 +187,7 @@ void Input_Stream_Manager_NVMe::segment_user_request(User_Request *user_request)
 	page_status_type access_status_bitmap = 0;
 	unsigned int handled_sectors_count = 0;
 	unsigned int transaction_size = 0;
+	size_t fp_index = 0;//index of the next fingerprint of the request
 	while (handled_sectors_count < req_size)
 	{
 		//Check if LSA is in the correct range allocted to the stream
@@ -207,11 +215,15 @@ void Input_Stream_Manager_NVMe::segment_user_request(User_Request *user_request)
 			input_streams[user_request->Stream_id]->STAT_number_of_read_transactions++;
 		}
 		else
-		{ //user_request->Type == UserRequestType::WRITE
+		{ //user_request->Type == UserRequestType::WRITE or UserRequestType::TRIM
 			NVM_Transaction_Flash_WR *transaction = new NVM_Transaction_Flash_WR(Transaction_Source_Type::USERIO, user_request->Stream_id,
 																				 transaction_size * SECTOR_SIZE_IN_BYTE, lpa, user_request, user_request->Priority_class, 0, access_status_bitmap, CurrentTimeStamp);
+			transaction->Trim = user_request->Type == UserRequestType::TRIM;//** Append for CAFTL
 			user_request->Transaction_list.push_back(transaction);
-			input_streams[user_request->Stream_id]->STAT_number_of_write_transactions++;
+			if (!transaction->Trim) {
+				bind_fingerprints(user_request, transaction, access_status_bitmap, fp_index);//** Append for CAFTL
+				input_streams[user_request->Stream_id]->STAT_number_of_write_transactions++;
+			}
 		}
 
 		lsa = lsa + transaction_size;
@@ -309,6 +321,16 @@ void Request_Fetch_Unit_NVMe::Process_pcie_read_message(uint64_t address, void *
 			new_request->Start_LBA = ((LHA_type)sqe->Command_specific[1]) << 31 | (LHA_type)sqe->Command_specific[0]; //Command Dword 10 and Command Dword 11
 			new_request->SizeInSectors = sqe->Command_specific[2] & (LHA_type)(0x0000ffff);
 			new_request->Size_in_byte = new_request->SizeInSectors * SECTOR_SIZE_IN_BYTE;
+			if (sqe->Metadata_pointer_1 != 0)//** Append for CAFTL
+				new_request->Fingerprints = *(std::vector<FP_type>*)(intptr_t)sqe->Metadata_pointer_1;
+			if (sqe->Metadata_pointer_2 != 0)
+				new_request->Compressed_sizes = *(std::vector<uint32_t>*)(intptr_t)sqe->Metadata_pointer_2;
+			break;
+		case NVME_DATASET_MANAGEMENT_OPCODE://** Append for CAFTL
+			new_request->Type = UserRequestType::TRIM;
+			new_request->Start_LBA = ((LHA_type)sqe->Command_specific[1]) << 31 | (LHA_type)sqe->Command_specific[0]; //Command Dword 10 and Command Dword 11
+			new_request->SizeInSectors = sqe->Command_specific[2] & (LHA_type)(0x0000ffff);
+			new_request->Size_in_byte = 0;
 			break;
 		default:
 			throw std::invalid_argument("NVMe command is not supported!");
@@ -382,7 +404,7 @@ void Request_Fetch_Unit_NVMe::Send_read_data(User_Request *request)
 
 Host_Interface_NVMe::Host_Interface_NVMe(const sim_object_id_type &id,
 										 LHA_type max_logical_sector_address, uint16_t submission_queue_depth, uint16_t completion_queue_depth,
-										 unsigned int no_of_input_streams, uint16_t queue_fetch_size, unsigned int sectors_per_page, Data_Cache_Manager_Base *cache) : Host_Interface_Base(id, HostInterface_Types::NVME, max_logical_sector_address, sectors_per_page, cache),
+										 unsigned int no_of_input_streams, uint16_t queue_fetch_size, unsigned int sectors_per_page, unsigned int sectors_per_chunk, Data_Cache_Manager_Base *cache) : Host_Interface_Base(id, HostInterface_Types::NVME, max_logical_sector_address, sectors_per_page, sectors_per_chunk, cache),
 																																									   submission_queue_depth(submission_queue_depth), completion_queue_depth(completion_queue_depth), no_of_input_streams(no_of_input_streams)
 {
 	this->input_stream_manager = new Input_Stream_Manager_NVMe(this, queue_fetch_size);
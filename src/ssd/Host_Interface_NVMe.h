@@ -91,7 +91,7 @@ class Host_Interface_NVMe : public Host_Interface_Base
 public:
 	Host_Interface_NVMe(const sim_object_id_type &id, LHA_type max_logical_sector_address,
 						uint16_t submission_queue_depth, uint16_t completion_queue_depth,
-						unsigned int no_of_input_streams, uint16_t queue_fetch_size, unsigned int sectors_per_page, Data_Cache_Manager_Base *cache);
+						unsigned int no_of_input_streams, uint16_t queue_fetch_size, unsigned int sectors_per_page, unsigned int sectors_per_chunk, Data_Cache_Manager_Base *cache);
 	~Host_Interface_NVMe()//** Append for CAFTL
 	{
 		PRINT_MESSAGE("\n* Trace Related Info: ")
@@ -62,6 +62,11 @@ namespace SSD_Components
 			((Input_Stream_SATA*)input_streams[SATA_STREAM_ID])->STAT_number_of_read_requests++;
 			segment_user_request(request);
 
+			((Host_Interface_SATA*)host_interface)->broadcast_user_request_arrival_signal(request);
+		} else if (request->Type == UserRequestType::TRIM) {//** Append for CAFTL: a TRIM carries no data, so it is segmented right away
+			((Input_Stream_SATA*)input_streams[SATA_STREAM_ID])->Waiting_user_requests.push_back(request);
+			segment_user_request(request);
+
 			((Host_Interface_SATA*)host_interface)->broadcast_user_request_arrival_signal(request);
 		} else {//This is a write request
 			((Input_Stream_SATA*)input_streams[SATA_STREAM_ID])->Waiting_user_requests.push_back(request);
@@ -134,6 +139,7 @@ namespace SSD_Components
 		page_status_type access_status_bitmap = 0;
 		unsigned int handled_sectors_count = 0;
 		unsigned int transaction_size = 0;
+		size_t fp_index = 0;//index of the next fingerprint of the request
 		while (handled_sectors_count < req_size) {
 			//Check if LSA is in the correct range allocted to the stream
 			if (lsa < ((Input_Stream_SATA*)input_streams[SATA_STREAM_ID])->Start_logical_sector_address || lsa >((Input_Stream_SATA*)input_streams[SATA_STREAM_ID])->End_logical_sector_address) {
@@ -156,11 +162,15 @@ namespace SSD_Components
 					transaction_size * SECTOR_SIZE_IN_BYTE, lpa, NO_PPA, user_request, 0, access_status_bitmap, CurrentTimeStamp);
 				user_request->Transaction_list.push_back(transaction);
 				input_streams[SATA_STREAM_ID]->STAT_number_of_read_transactions++;
-			} else {//user_request->Type == UserRequestType::WRITE
+			} else {//user_request->Type == UserRequestType::WRITE or UserRequestType::TRIM
 				NVM_Transaction_Flash_WR* transaction = new NVM_Transaction_Flash_WR(Transaction_Source_Type::USERIO, SATA_STREAM_ID,
 					transaction_size * SECTOR_SIZE_IN_BYTE, lpa, user_request, 0, access_status_bitmap, CurrentTimeStamp);
+				transaction->Trim = user_request->Type == UserRequestType::TRIM;//** Append for CAFTL
 				user_request->Transaction_list.push_back(transaction);
-				input_streams[SATA_STREAM_ID]->STAT_number_of_write_transactions++;
+				if (!transaction->Trim) {
+					bind_fingerprints(user_request, transaction, access_status_bitmap, fp_index);//** Append for CAFTL
+					input_streams[SATA_STREAM_ID]->STAT_number_of_write_transactions++;
+				}
 			}
 
 			lsa = lsa + transaction_size;
@@ -216,6 +226,16 @@ namespace SSD_Components
 						new_request->Start_LBA = ((LHA_type)sqe->Command_specific[1]) << 31 | (LHA_type)sqe->Command_specific[0];//Command Dword 10 and Command Dword 11
 						new_request->SizeInSectors = sqe->Command_specific[2] & (LHA_type)(0x0000ffff);
 						new_request->Size_in_byte = new_request->SizeInSectors * SECTOR_SIZE_IN_BYTE;
+						if (sqe->Metadata_pointer_1 != 0)//** Append for CAFTL
+							new_request->Fingerprints = *(std::vector<FP_type>*)(intptr_t)sqe->Metadata_pointer_1;
+						if (sqe->Metadata_pointer_2 != 0)
+							new_request->Compressed_sizes = *(std::vector<uint32_t>*)(intptr_t)sqe->Metadata_pointer_2;
+						break;
+					case SATA_DATA_SET_MANAGEMENT_OPCODE://** Append for CAFTL
+						new_request->Type = UserRequestType::TRIM;
+						new_request->Start_LBA = ((LHA_type)sqe->Command_specific[1]) << 31 | (LHA_type)sqe->Command_specific[0];//Command Dword 10 and Command Dword 11
+						new_request->SizeInSectors = sqe->Command_specific[2] & (LHA_type)(0x0000ffff);
+						new_request->Size_in_byte = 0;
 						break;
 					default:
 						throw std::invalid_argument("SATA command is not supported!");
@@ -284,8 +304,8 @@ namespace SSD_Components
 	}
 
 	Host_Interface_SATA::Host_Interface_SATA(const sim_object_id_type& id,
-		const uint16_t ncq_depth, const LHA_type max_logical_sector_address, const unsigned int sectors_per_page, Data_Cache_Manager_Base* cache) :
-		Host_Interface_Base(id, HostInterface_Types::SATA, max_logical_sector_address, sectors_per_page, cache), ncq_depth(ncq_depth)
+		const uint16_t ncq_depth, const LHA_type max_logical_sector_address, const unsigned int sectors_per_page, const unsigned int sectors_per_chunk, Data_Cache_Manager_Base* cache) :
+		Host_Interface_Base(id, HostInterface_Types::SATA, max_logical_sector_address, sectors_per_page, sectors_per_chunk, cache), ncq_depth(ncq_depth)
 	{
 		this->input_stream_manager = new Input_Stream_Manager_SATA(this, ncq_depth, 0, max_logical_sector_address);
 		this->request_fetch_unit = new Request_Fetch_Unit_SATA(this, ncq_depth);
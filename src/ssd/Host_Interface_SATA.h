@@ -70,7 +70,7 @@ namespace SSD_Components
 		friend class Request_Fetch_Unit_SATA;
 	public:
 		Host_Interface_SATA(const sim_object_id_type& id,
-			const uint16_t ncq_depth, const LHA_type max_logical_sector_address, const unsigned int sectors_per_page, Data_Cache_Manager_Base* cache);
+			const uint16_t ncq_depth, const LHA_type max_logical_sector_address, const unsigned int sectors_per_page, const unsigned int sectors_per_chunk, Data_Cache_Manager_Base* cache);
 		void Set_ncq_address(const uint64_t submission_queue_base_address, const uint64_t completion_queue_base_address);
 		uint16_t Get_ncq_depth();
 		void Start_simulation();
@@ -47,4 +47,16 @@ namespace SSD_Components {
 			(*it)(chip);
 		}
 	}
-}
\ No newline at end of file
+
+	void NVM_PHY_ONFI::ConnectToPageLPAQuery(PageLPAQueryHandlerType function)
+	{
+		connectedPageLPAQueryHandler = function;
+	}
+
+	LPA_type NVM_PHY_ONFI::query_page_lpa(NVM_Transaction_Flash* transaction)
+	{
+		if (connectedPageLPAQueryHandler == NULL)
+			return transaction->LPA;
+		return connectedPageLPAQueryHandler(transaction);
+	}
+}
@@ -41,6 +41,9 @@ namespace SSD_Components
 		void ConnectToChannelIdleSignal(ChannelIdleHandlerType);
 		typedef void(*ChipIdleHandlerType) (NVM::FlashMemory::Flash_Chip*);
 		void ConnectToChipIdleSignal(ChipIdleHandlerType);
+		typedef LPA_type(*PageLPAQueryHandlerType) (NVM_Transaction_Flash*);//** Append for CAFTL, the FTL reports the LPA kept in the OOB area of the target page
+		void ConnectToPageLPAQuery(PageLPAQueryHandlerType);
+		void Complete_without_flash_access(NVM_Transaction_Flash* transaction) { broadcastTransactionServicedSignal(transaction); }//** Append for CAFTL, a duplicate write is serviced without programming a page
 	protected:
 		unsigned int channel_count;
 		unsigned int chip_no_per_channel;
@@ -52,6 +55,8 @@ namespace SSD_Components
 		void broadcastChannelIdleSignal(flash_channel_ID_type);
 		std::vector<ChipIdleHandlerType> connectedChipIdleHandlers;
 		void broadcastChipIdleSignal(NVM::FlashMemory::Flash_Chip* chip);
+		PageLPAQueryHandlerType connectedPageLPAQueryHandler = NULL;
+		LPA_type query_page_lpa(NVM_Transaction_Flash* transaction);
 	};
 }
 
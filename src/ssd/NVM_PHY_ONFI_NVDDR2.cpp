@@ -176,10 +176,7 @@ namespace SSD_Components {
 			dieBKE->ActiveCommand->Address.push_back((*it)->Address);
 			NVM::FlashMemory::PageMetadata metadata;
 			//** Append for CAFTL
-			if(In_SMT((*it)->PPA))
-				Get_LPA_from_ReverseMapping(Get_SMTEntry((*it)->PPA).PPA, metadata.LPA);
-			else
-				Get_LPA_from_ReverseMapping((*it)->PPA, metadata.LPA);
+			metadata.LPA = query_page_lpa(*it);
 			//if ((*it)->PPA == 0)
 				//PRINT_MESSAGE("h");
 
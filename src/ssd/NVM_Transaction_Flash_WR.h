@@ -1,6 +1,7 @@
 #ifndef NVM_TRANSACTION_FLASH_WR
 #define NVM_TRANSACTION_FLASH_WR
 
+#include <vector>
 #include "../nvm_chip/flash_memory/FlashTypes.h"
 #include "../nvm_chip/NVM_Types.h"
 #include "NVM_Transaction_Flash.h"
@@ -37,6 +38,12 @@ namespace SSD_Components
 
 		//** Append for CAFTL
 		bool dedup_wr; //If LPA got dedup, this write should be discarded
+		FP_type FP; //Fingerprint carried with the user request, valid only if FP_available is set
+		bool FP_available;//With sub-page chunk dedup, set once Chunk_FPs holds a fingerprint for every chunk that the write touches
+		bool Trim;//The write comes from a TRIM, it unmaps write_sectors_bitmap of the LPA instead of programming data
+		PPA_type Verify_PPA;//The page a duplicate write is compared with before it completes, NO_PPA if it is not verified
+		std::vector<FP_type> Chunk_FPs;//Fingerprints of the touched chunks in address order, only used with sub-page chunk dedup
+		std::vector<uint32_t> Compressed_sizes;//Compressed size in bytes of the content behind FP, or behind each of Chunk_FPs, 0 if unknown
 	};
 }
 
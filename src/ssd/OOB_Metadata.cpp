@@ -0,0 +1,43 @@
+#include "OOB_Metadata.h"
+
+namespace SSD_Components
+{
+	void OOBEntryType::Reset()
+	{
+		LPA = NO_LPA;
+		VPA = NO_PPA;
+		FP_slot = NO_FP_SLOT;
+		use_SMT = false;
+		status = false;
+	}
+
+	uint32_t Fingerprint_Arena::Store(const FP_type& FP)
+	{
+		if (free_slots.size() > 0) {
+			uint32_t slot = free_slots.back();
+			free_slots.pop_back();
+			slots[slot] = FP;
+			return slot;
+		}
+		slots.push_back(FP);
+		return (uint32_t)(slots.size() - 1);
+	}
+
+	void Fingerprint_Arena::Release(uint32_t slot)
+	{
+		if (slot != NO_FP_SLOT)
+			free_slots.push_back(slot);
+	}
+
+	void Fingerprint_Arena::Save_checkpoint(Checkpoint_Writer& writer) const
+	{
+		writer.Write_vector(slots);
+		writer.Write_vector(free_slots);
+	}
+
+	void Fingerprint_Arena::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Read_vector(slots);
+		reader.Read_vector(free_slots);
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef OOB_METADATA_H
+#define OOB_METADATA_H
+
+#include <vector>
+#include <cstdint>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Checkpoint.h"
+
+namespace SSD_Components
+{
+#define NO_FP_SLOT 0xffffffffU
+
+	/*
+	* Out-of-band metadata of one physical page (Append for CAFTL). Every block keeps an array of
+	* these, so a lookup by physical address is O(1) and the whole store is bounded by the physical
+	* capacity. The fingerprint is not stored inline: FP_slot indexes a Fingerprint_Arena that is
+	* shared by all blocks. An entry whose FP_slot is NO_FP_SLOT holds no CAFTL metadata.
+	*/
+	struct OOBEntryType
+	{
+		LPA_type LPA;
+		VPA_type VPA;
+		uint32_t FP_slot;
+		bool use_SMT;//For unique chunk but using two-level mapping (ref decreases to 1)
+		bool status;//true once the page is invalidated by the dedup layer
+		bool Has_metadata() const { return FP_slot != NO_FP_SLOT; }
+		void Reset();
+	};
+
+	/*
+	* Slab of fingerprints referenced by OOB entries. Released slots go to a free list and are
+	* reused by later programs, so the arena never grows beyond the number of pages that hold
+	* fingerprints at the same time.
+	*/
+	class Fingerprint_Arena
+	{
+	public:
+		uint32_t Store(const FP_type& FP);
+		void Release(uint32_t slot);
+		const FP_type& Get(uint32_t slot) const { return slots[slot]; }
+		void Set(uint32_t slot, const FP_type& FP) { slots[slot] = FP; }
+		size_t Live_slots() const { return slots.size() - free_slots.size(); }
+		void Save_checkpoint(Checkpoint_Writer& writer) const;
+		void Load_checkpoint(Checkpoint_Reader& reader);
+	private:
+		std::vector<FP_type> slots;
+		std::vector<uint32_t> free_slots;
+	};
+}
+
+#endif // !OOB_METADATA_H
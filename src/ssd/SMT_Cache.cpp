@@ -0,0 +1,113 @@
+#include <stdexcept>
+#include "SMT_Cache.h"
+#include "Secondary_Mapping_Table.h"
+
+namespace SSD_Components
+{
+	SMT_Cache::SMT_Cache(unsigned int capacity, SMT_Cache_Replacement_Policy policy, unsigned int entries_per_page, unsigned int page_no) :
+		Hits(0), Misses(0), capacity(capacity), policy(policy), entries_per_page(entries_per_page), page_no(page_no)
+	{
+		if (this->entries_per_page == 0)
+			this->entries_per_page = 1;
+		if (this->page_no == 0)
+			this->page_no = 1;
+	}
+
+	bool SMT_Cache::Exists(VPA_type VPA)
+	{
+		return addressMap.find(VPA) != addressMap.end();
+	}
+
+	bool SMT_Cache::Lookup(VPA_type VPA)
+	{
+		auto it = addressMap.find(VPA);
+		if (it == addressMap.end()) {
+			Misses++;
+			return false;
+		}
+
+		Hits++;
+		if (policy == SMT_Cache_Replacement_Policy::LRU)
+			replacementList.splice(replacementList.begin(), replacementList, it->second.listPtr);
+		return true;
+	}
+
+	bool SMT_Cache::Check_free_slot_availability()
+	{
+		return addressMap.size() < capacity;
+	}
+
+	void SMT_Cache::Insert(VPA_type VPA, bool dirty)
+	{
+		if (addressMap.find(VPA) != addressMap.end()) {
+			throw std::logic_error("Duplicate VPA insertion into the SMT cache!");
+		}
+		if (addressMap.size() >= capacity) {
+			throw std::logic_error("SMT cache overfull!");
+		}
+
+		replacementList.push_front(VPA);
+		SMTCacheSlotType slot = { dirty, replacementList.begin() };
+		addressMap[VPA] = slot;
+	}
+
+	void SMT_Cache::Make_dirty(VPA_type VPA)
+	{
+		auto it = addressMap.find(VPA);
+		if (it == addressMap.end()) {
+			throw std::logic_error("The requested SMT entry is not cached!");
+		}
+
+		it->second.Dirty = true;
+		if (policy == SMT_Cache_Replacement_Policy::LRU)
+			replacementList.splice(replacementList.begin(), replacementList, it->second.listPtr);
+	}
+
+	VPA_type SMT_Cache::Evict_one_slot(bool& dirty)
+	{
+		if (addressMap.size() == 0) {
+			throw std::logic_error("Evicting from an empty SMT cache!");
+		}
+
+		VPA_type victim = replacementList.back();
+		auto it = addressMap.find(victim);
+		dirty = it->second.Dirty;
+		addressMap.erase(it);
+		replacementList.pop_back();
+
+		return victim;
+	}
+
+	unsigned int SMT_Cache::Get_page(VPA_type VPA)
+	{
+		//VPAs past the last physical page (see Secondary_Mapping_Table::Find_free_VPA) wrap around to the first SMT pages
+		return (unsigned int)((PPA_TO_VPA(VPA) / entries_per_page) % page_no);
+	}
+
+	float SMT_Cache::Get_hit_rate()
+	{
+		if (Hits + Misses == 0)
+			return 0;
+		return float(Hits) / (Hits + Misses);
+	}
+
+	void SMT_Cache::Save_checkpoint(Checkpoint_Writer& writer)
+	{
+		writer.Write(capacity);
+		writer.Write((uint64_t)replacementList.size());
+		for (auto it = replacementList.rbegin(); it != replacementList.rend(); it++) {//Back to front, so that reinsertion rebuilds the same order
+			writer.Write(*it);
+			writer.Write(addressMap[*it].Dirty);
+		}
+	}
+
+	void SMT_Cache::Load_checkpoint(Checkpoint_Reader& reader)
+	{
+		reader.Expect(capacity, "SMT_Cache_Capacity");
+		uint64_t entry_no = reader.Read<uint64_t>();
+		for (uint64_t i = 0; i < entry_no; i++) {
+			VPA_type VPA = reader.Read<VPA_type>();
+			Insert(VPA, reader.Read<bool>());
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef SMT_CACHE_H
+#define SMT_CACHE_H
+
+#include <unordered_map>
+#include <list>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+#include "Checkpoint.h"
+
+namespace SSD_Components
+{
+	enum class SMT_Cache_Replacement_Policy { LRU, FIFO };
+
+	struct SMTCacheSlotType
+	{
+		bool Dirty;
+		std::list<VPA_type>::iterator listPtr;
+	};
+
+	/*
+	* Bounded cache of the Secondary Mapping Table (Append for CAFTL). It does for the SMT what the CMT does for the
+	* primary mapping table: the complete SMT is persisted in flash as SMT translation pages of Entries_per_page
+	* consecutive VPAs each, and only Capacity entries are kept in controller DRAM. Like the fingerprint cache, it only
+	* tracks residency and dirtiness of SMT slots; the entries themselves stay in the Secondary_Mapping_Table of the
+	* Deduplicator, which stands for the union of the cache and the SMT pages on flash.
+	*/
+	class SMT_Cache
+	{
+	public:
+		SMT_Cache(unsigned int capacity, SMT_Cache_Replacement_Policy policy, unsigned int entries_per_page, unsigned int page_no);
+		bool Exists(VPA_type VPA);
+		bool Lookup(VPA_type VPA);//Same as Exists, but counts a hit or a miss and refreshes the entry under LRU
+		bool Check_free_slot_availability();
+		void Insert(VPA_type VPA, bool dirty);
+		void Make_dirty(VPA_type VPA);
+		VPA_type Evict_one_slot(bool& dirty);
+		unsigned int Get_page(VPA_type VPA);//The SMT translation page that holds the entry of VPA
+		unsigned int Get_page_no() { return page_no; }
+		unsigned int Get_capacity() { return capacity; }
+		size_t Size() { return addressMap.size(); }
+		float Get_hit_rate();
+		void Save_checkpoint(Checkpoint_Writer& writer);//Resident entries in replacement order, statistics are not saved
+		void Load_checkpoint(Checkpoint_Reader& reader);
+
+		size_t Hits;
+		size_t Misses;
+	private:
+		std::unordered_map<VPA_type, SMTCacheSlotType> addressMap;
+		std::list<VPA_type> replacementList;//Front is the most recently inserted (FIFO) or used (LRU) entry
+		unsigned int capacity;
+		SMT_Cache_Replacement_Policy policy;
+		unsigned int entries_per_page;
+		unsigned int page_no;
+	};
+}
+
+#endif // !SMT_CACHE_H
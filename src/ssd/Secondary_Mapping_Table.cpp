@@ -0,0 +1,108 @@
+#include "Secondary_Mapping_Table.h"
+
+namespace SSD_Components
+{
+	Secondary_Mapping_Table::Secondary_Mapping_Table() : size(0)
+	{
+	}
+
+	void Secondary_Mapping_Table::Resize(PPA_type physical_pages_no)
+	{
+		SMTEntryType empty_entry = { NO_PPA };
+		entries.assign((size_t)physical_pages_no, empty_entry);
+		valid_bitmap.assign((size_t)(physical_pages_no / 64 + (physical_pages_no % 64 == 0 ? 0 : 1)), 0);
+		size = 0;
+	}
+
+	void Secondary_Mapping_Table::grow(size_t min_entries)
+	{
+		size_t new_size = entries.size() < 1024 ? 1024 : entries.size();
+		while (new_size < min_entries)
+			new_size *= 2;
+		SMTEntryType empty_entry = { NO_PPA };
+		entries.resize(new_size, empty_entry);
+		valid_bitmap.resize(new_size / 64 + (new_size % 64 == 0 ? 0 : 1), 0);
+	}
+
+	unsigned int Secondary_Mapping_Table::count_trailing_zeros(uint64_t bits)
+	{
+#if defined(__GNUC__)
+		return (unsigned int)__builtin_ctzll(bits);
+#else
+		unsigned int count = 0;
+		while ((bits & 1) == 0) {
+			bits >>= 1;
+			count++;
+		}
+		return count;
+#endif
+	}
+
+	inline bool Secondary_Mapping_Table::index_of(VPA_type VPA, size_t& index) const
+	{
+		if (!IS_VPA(VPA))
+			return false;
+		index = (size_t)PPA_TO_VPA(VPA);
+		return index < entries.size();
+	}
+
+	bool Secondary_Mapping_Table::Contains(VPA_type VPA) const
+	{
+		size_t index;
+		if (!index_of(VPA, index))
+			return false;
+		return (valid_bitmap[index / 64] >> (index % 64)) & 1;
+	}
+
+	const SMTEntryType& Secondary_Mapping_Table::Get(VPA_type VPA) const
+	{
+		return entries[(size_t)PPA_TO_VPA(VPA)];
+	}
+
+	void Secondary_Mapping_Table::Insert(VPA_type VPA, const SMTEntryType& entry)
+	{
+		if (!IS_VPA(VPA))
+			PRINT_ERROR("Inserting a PPA into SMT: " << VPA)
+		size_t index = (size_t)PPA_TO_VPA(VPA);
+		if (index >= entries.size())
+			grow(index + 1);
+		if (((valid_bitmap[index / 64] >> (index % 64)) & 1) == 0) {
+			valid_bitmap[index / 64] |= 1ULL << (index % 64);
+			size++;
+		}
+		entries[index] = entry;
+	}
+
+	bool Secondary_Mapping_Table::Update(VPA_type VPA, PPA_type PPA)
+	{
+		if (!Contains(VPA))
+			return false;
+		entries[(size_t)PPA_TO_VPA(VPA)].PPA = PPA;
+		return true;
+	}
+
+	void Secondary_Mapping_Table::Erase(VPA_type VPA)
+	{
+		if (!Contains(VPA))
+			return;
+		size_t index = (size_t)PPA_TO_VPA(VPA);
+		valid_bitmap[index / 64] &= ~(1ULL << (index % 64));
+		entries[index].PPA = NO_PPA;
+		size--;
+	}
+
+	VPA_type Secondary_Mapping_Table::Find_free_VPA(VPA_type VPA) const
+	{
+		size_t index = (size_t)PPA_TO_VPA(VPA);
+		if (index >= entries.size())
+			return VPA;
+		for (size_t probe = 0; probe < entries.size(); probe++) {
+			if (index >= entries.size())
+				index = 0;
+			if (((valid_bitmap[index / 64] >> (index % 64)) & 1) == 0)
+				return PPA_TO_VPA((VPA_type)index);
+			index++;
+		}
+		return PPA_TO_VPA((VPA_type)entries.size());//All entries are live, the table grows on insertion
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef SECONDARY_MAPPING_TABLE_H
+#define SECONDARY_MAPPING_TABLE_H
+
+#include <vector>
+#include "../nvm_chip/flash_memory/FlashTypes.h"
+
+namespace SSD_Components
+{
+	//** GMT equals to Primary Mapping Table in CAFTL
+	//** CAFTL maintains SMT (Secondary Mapping Table) for VPN-to-PPN mapping
+	struct SMTEntryType//** Append for CAFTL
+	{
+		PPA_type PPA;
+	};
+
+#define VPA_FLAG (1ULL << 63)
+#define PPA_TO_VPA(PPA) ((PPA) ^ VPA_FLAG)
+#define IS_VPA(ADDR) (((ADDR) & VPA_FLAG) != 0)
+
+	/*
+	* Flat Secondary Mapping Table (Append for CAFTL). A VPA is the PPA of the first copy of a shared
+	* chunk with the top bit set, so the low bits directly index a dense array of SMT entries. The
+	* array is either sized to the physical page count up front (Resize) or grows geometrically up to
+	* the highest VPA that was inserted. A one-bit-per-page bitmap records which entries are live, so
+	* lookups, inserts and updates are O(1). A shared chunk keeps its VPA when GC moves it, so the PPA it
+	* was derived from may be reused by another chunk while the VPA is still live; such a chunk gets the
+	* next free VPA instead.
+	*/
+	class Secondary_Mapping_Table
+	{
+	public:
+		Secondary_Mapping_Table();
+		void Resize(PPA_type physical_pages_no);
+		bool Contains(VPA_type VPA) const;
+		const SMTEntryType& Get(VPA_type VPA) const;//The caller should first check Contains
+		void Insert(VPA_type VPA, const SMTEntryType& entry);//Inserts or overwrites the entry of VPA
+		bool Update(VPA_type VPA, PPA_type PPA);//false if VPA has no entry
+		void Erase(VPA_type VPA);
+		VPA_type Find_free_VPA(VPA_type VPA) const;//VPA itself if it has no entry, otherwise the next VPA without an entry
+		size_t Size() const { return size; }
+		template<typename Visitor>
+		void For_each(Visitor visit) const
+		{
+			for (size_t word = 0; word < valid_bitmap.size(); word++) {
+				for (uint64_t bits = valid_bitmap[word]; bits != 0; bits &= bits - 1) {
+					size_t index = word * 64 + count_trailing_zeros(bits);
+					visit(PPA_TO_VPA((VPA_type)index), entries[index]);
+				}
+			}
+		}
+	private:
+		std::vector<SMTEntryType> entries;
+		std::vector<uint64_t> valid_bitmap;
+		size_t size;
+		static unsigned int count_trailing_zeros(uint64_t bits);
+		void grow(size_t min_entries);
+		bool index_of(VPA_type VPA, size_t& index) const;
+	};
+}
+
+#endif // !SECONDARY_MAPPING_TABLE_H
@@ -24,6 +24,10 @@ namespace SSD_Components
 	unsigned long Stats::Total_flash_writes_for_mapping = 0;
 	unsigned long Stats::Total_flash_reads_for_mapping_per_stream[MAX_SUPPORT_STREAMS] = { 0 };
 	unsigned long Stats::Total_flash_writes_for_mapping_per_stream[MAX_SUPPORT_STREAMS] = { 0 };
+	unsigned long Stats::Total_flash_reads_for_SMT = 0;
+	unsigned long Stats::Total_flash_writes_for_SMT = 0;
+	unsigned long Stats::Total_flash_reads_for_SMT_per_stream[MAX_SUPPORT_STREAMS] = { 0 };
+	unsigned long Stats::Total_flash_writes_for_SMT_per_stream[MAX_SUPPORT_STREAMS] = { 0 };
 	unsigned int***** Stats::Block_erase_histogram;
 	unsigned int  Stats::CMT_hits = 0, Stats::readTR_CMT_hits = 0, Stats::writeTR_CMT_hits = 0;
 	unsigned int  Stats::CMT_miss = 0, Stats::readTR_CMT_miss = 0, Stats::writeTR_CMT_miss = 0;
@@ -66,6 +70,7 @@ namespace SSD_Components
 		IssuedEraseCMD = 0; IssuedInterleaveEraseCMD = 0; IssuedMultiplaneEraseCMD = 0; IssuedInterleaveMultiplaneEraseCMD = 0;
 		IssuedSuspendEraseCMD = 0;
 		Total_flash_reads_for_mapping = 0; Total_flash_writes_for_mapping = 0; 
+		Total_flash_reads_for_SMT = 0; Total_flash_writes_for_SMT = 0;
 		CMT_hits = 0; readTR_CMT_hits = 0; writeTR_CMT_hits = 0;
 		CMT_miss = 0; readTR_CMT_miss = 0; writeTR_CMT_miss = 0;
 		total_CMT_queries = 0; Total_readTR_CMT_queries = 0; Total_writeTR_CMT_queries = 0;
@@ -76,6 +81,8 @@ namespace SSD_Components
 		for (stream_id_type stream_id = 0; stream_id < MAX_SUPPORT_STREAMS; stream_id++) {
 			Total_flash_reads_for_mapping_per_stream[stream_id] = 0;
 			Total_flash_writes_for_mapping_per_stream[stream_id] = 0;
+			Total_flash_reads_for_SMT_per_stream[stream_id] = 0;
+			Total_flash_writes_for_SMT_per_stream[stream_id] = 0;
 			CMT_hits_per_stream[stream_id] = 0; readTR_CMT_hits_per_stream[stream_id] = 0; writeTR_CMT_hits_per_stream[stream_id] = 0;
 			CMT_miss_per_stream[stream_id] = 0; readTR_CMT_miss_per_stream[stream_id] = 0;  writeTR_CMT_miss_per_stream[stream_id] = 0;
 			total_CMT_queries_per_stream[stream_id] = 0; Total_readTR_CMT_queries_per_stream[stream_id] = 0; Total_writeTR_CMT_queries_per_stream[stream_id] = 0;
@@ -18,6 +18,8 @@ namespace SSD_Components
 
 		static unsigned long Total_flash_reads_for_mapping, Total_flash_writes_for_mapping;
 		static unsigned long Total_flash_reads_for_mapping_per_stream[MAX_SUPPORT_STREAMS], Total_flash_writes_for_mapping_per_stream[MAX_SUPPORT_STREAMS];
+		static unsigned long Total_flash_reads_for_SMT, Total_flash_writes_for_SMT;//** Append for CAFTL: SMT translation page misses and dirty write backs
+		static unsigned long Total_flash_reads_for_SMT_per_stream[MAX_SUPPORT_STREAMS], Total_flash_writes_for_SMT_per_stream[MAX_SUPPORT_STREAMS];
 
 		static unsigned int CMT_hits, readTR_CMT_hits, writeTR_CMT_hits;
 		static unsigned int CMT_miss, readTR_CMT_miss, writeTR_CMT_miss;
@@ -3,14 +3,16 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include "SSD_Defs.h"
 #include "../sim/Sim_Defs.h"
 #include "Host_Interface_Defs.h"
 #include "NVM_Transaction.h"
+#include "../nvm_chip/flash_memory/FlashTypes.h"
 
 namespace SSD_Components
 {
-	enum class UserRequestType { READ, WRITE };
+	enum class UserRequestType { READ, WRITE, TRIM };//** Modified for CAFTL: TRIM unmaps the LBA range without any data transfer
 	class NVM_Transaction;
 	class User_Request
 	{
@@ -32,6 +34,8 @@ namespace SSD_Components
 		bool ToBeIgnored;
 		void* IO_command_info;//used to store host I/O command info
 		void* Data;
+		std::vector<FP_type> Fingerprints;//** Append for CAFTL: one fingerprint per page touched by a write, empty if the host sent none
+		std::vector<uint32_t> Compressed_sizes;//** Append for CAFTL: compressed size in bytes of each fingerprinted content, 0 if unknown, empty if the host sent none
 	private:
 		static unsigned int lastId;
 	};
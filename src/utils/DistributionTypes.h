@@ -6,6 +6,7 @@ namespace Utils
 	enum class Address_Distribution_Type { MIXED_STREAMING_RANDOM, STREAMING, RANDOM_UNIFORM, RANDOM_HOTCOLD };
 	enum class Request_Size_Distribution_Type { FIXED, NORMAL };
 	enum class Workload_Type { SYNTHETIC, TRACE_BASED };
+	enum class Content_Popularity_Type { NONE, UNIFORM, ZIPF };//** Append for CAFTL: which earlier content a duplicate write repeats, NONE if synthetic writes carry no content
 	enum class Request_Generator_Type { BANDWIDTH, QUEUE_DEPTH };//Time_INTERVAL: general requests based on the arrival rate definitions, DEMAND_BASED: just generate a request, every time that there is a demand
 }
 